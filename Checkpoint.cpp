@@ -1,8 +1,30 @@
 #include "Checkpoint.h"
+#include <algorithm>
+#include <climits>
 
-Checkpoint::Checkpoint  ( FlowField & flowField, const Parameters & parameters ) :
+// MPI counts are int, so that larger compressed blocks are transferred in pieces of this size
+static const long long MAX_TRANSFER_BYTES = INT_MAX;
+
+// Start of a buffer, which is empty e.g. for a rank without cells in a section
+static char * bufferStart ( std::vector<char> & buffer ) {
+    return buffer.empty() ? NULL : &buffer[0];
+}
+
+Checkpoint::Checkpoint  ( FlowField & flowField, Parameters & parameters, PetscSolver & solver ) :
 _flowField(flowField),
-_parameters(parameters)
+_parameters(parameters),
+_solver(solver),
+_turbulent(parameters.simulation.type=="turbulence"),
+_spalartAllmaras(_turbulent && parameters.turbulenceModel.type=="spalartAllmaras"),
+_turbFlowField(NULL),
+_turbViscSection(-1),
+_turbViscAge(NULL),
+_strainRateReference(NULL),
+_keyframeStep(-1),
+_sinceKeyframe(0),
+_writeEncoding(CHECKPOINT_RAW),
+_position(0),
+_readEncoding(CHECKPOINT_RAW)
 {
     // 2D or 3D case?
     if (_parameters.geometry.dim == 2) {
@@ -45,21 +67,507 @@ _parameters(parameters)
     }
     MPI_Type_commit(&_filetype);
 
+    if (_turbulent) {
+        _turbFlowField = (TurbulentFlowField*) &flowField;
+    }
+
+    // Sections of the versioned format. The flow field arrays include all ghost layers, the grid
+    // of the pressure solver has one boundary layer per side.
+    const int dim = _parameters.geometry.dim;
+    const int cellsX = _parameters.geometry.sizeX + 3;
+    const int cellsY = _parameters.geometry.sizeY + 3;
+    const int cellsZ = dim == 3 ? _parameters.geometry.sizeZ + 3 : 1;
+
+    addSection("dt",               CHECKPOINT_FLOAT, 1, 1, 1, 1);
+    addSection("solverStatistics", CHECKPOINT_INT,   2, 1, 1, 1);
+    addSection("encoding",         CHECKPOINT_INT,   2, 1, 1, 1);
+    addSection("flags",            CHECKPOINT_INT,   1, cellsX, cellsY, cellsZ);
+    addSection("pressure",         CHECKPOINT_FLOAT, 1, cellsX, cellsY, cellsZ);
+    addSection("velocity",         CHECKPOINT_FLOAT, dim, cellsX, cellsY, cellsZ);
+    addSection("pressureGuess",    CHECKPOINT_FLOAT, 1, _parameters.geometry.sizeX + 2,
+               _parameters.geometry.sizeY + 2, dim == 3 ? _parameters.geometry.sizeZ + 2 : 1);
+    if (_turbulent) {
+        addSection("turbViscosity",   CHECKPOINT_FLOAT, 1, cellsX, cellsY, cellsZ);
+        addSection("distNearestWall", CHECKPOINT_FLOAT, 1, cellsX, cellsY, cellsZ);
+    }
+    if (_spalartAllmaras) {
+        addSection("nuTilde",         CHECKPOINT_FLOAT, 1, cellsX, cellsY, cellsZ);
+    }
+
     // Create the restart directory if it doesn't exist
     mkdir(_parameters.checkpoint.directory.c_str(), S_IRWXU | S_IRWXG | S_IROTH);
 
 }
 
-Checkpoint::~Checkpoint () {}
+Checkpoint::~Checkpoint () {
+    MPI_Type_free(&_filetype);
+}
+
+void Checkpoint::addTurbViscUpdates ( int & age, ScalarField * reference ) {
+    _turbViscSection = _sections.size();
+    _turbViscAge = &age;
+    _strainRateReference = reference;
+    addSection("turbViscAge", CHECKPOINT_INT, 1, 1, 1, 1);
+    if (reference != NULL) {
+        addSection("strainRateReference", CHECKPOINT_FLOAT, 1, _parameters.geometry.sizeX + 3,
+                   _parameters.geometry.sizeY + 3,
+                   _parameters.geometry.dim == 3 ? _parameters.geometry.sizeZ + 3 : 1);
+    }
+}
+
+void Checkpoint::addSection ( const std::string & name, int type, int components,
+                              int sizeX, int sizeY, int sizeZ ) {
+    CheckpointSection section;
+    memset(&section, 0, sizeof(CheckpointSection));
+    strncpy(section.name, name.c_str(), sizeof(section.name) - 1);
+    section.type = type;
+    section.components = components;
+    section.sizes[0] = sizeX;
+    section.sizes[1] = sizeY;
+    section.sizes[2] = sizeZ;
+    section.offset = 0;     // set when writing
+    section.bytes = (long long) components * sizeX * sizeY * sizeZ *
+                    (type == CHECKPOINT_INT ? sizeof(int) : sizeof(FLOAT));
+    _sections.push_back(section);
+}
+
+void Checkpoint::getFieldBlock ( int first[3], int length[3], int localFirst[3], bool write ) const {
+    for (int d = 0; d < 3; d++) {
+        if (d == 2 && _parameters.geometry.dim == 2) {
+            first[d] = 0; length[d] = 1; localFirst[d] = 0;
+            continue;
+        }
+        int low  = 0;
+        int high = _parameters.parallel.localSize[d] + 3;
+        if (write) {
+            // Ghost layers between subdomains belong to the neighbour
+            if (_parameters.parallel.indices[d] != 0) {
+                low = 2;
+            }
+            if (_parameters.parallel.indices[d] != _parameters.parallel.numProcessors[d] - 1) {
+                high = _parameters.parallel.localSize[d] + 2;
+            }
+        }
+        localFirst[d] = low;
+        first[d] = _parameters.parallel.firstCorner[d] + low;
+        length[d] = high - low;
+    }
+}
+
+void Checkpoint::writeBlock ( MPI_File & fh, CheckpointSection & section, const void * buffer,
+                              const int first[3], const int length[3] ) {
+    section.offset = _position;
+    if (_writeEncoding != CHECKPOINT_RAW) {
+        writeEncodedBlock(fh, section, buffer, first, length);
+        _position += section.bytes;
+        return;
+    }
+    _position += section.bytes;
+
+    MPI_Datatype etype = section.type == CHECKPOINT_INT ? MPI_INT : MY_MPI_FLOAT;
+    MPI_Datatype filetype;
+    MPI_Status status;
+
+    // C order: z slowest, x and the components fastest
+    int sizes[3]    = {section.sizes[2], section.sizes[1], section.components * section.sizes[0]};
+    int subsizes[3] = {length[2], length[1], section.components * length[0]};
+    int starts[3]   = {first[2], first[1], section.components * first[0]};
+
+    MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, etype, &filetype);
+    MPI_Type_commit(&filetype);
+
+    // Note: we assume that we are only using the same machine always, for performance reasons.
+    MPI_File_set_view(fh, section.offset, etype, filetype, "native", MPI_INFO_NULL);
+    int ierr = MPI_File_write_all(fh, const_cast<void*>(buffer), subsizes[0] * subsizes[1] * subsizes[2],
+                                  etype, &status);
+    if (ierr != MPI_SUCCESS) {
+        handleError(1, "Cannot write the cell data to the checkpoint file.");
+    }
+    MPI_Type_free(&filetype);
+}
+
+void Checkpoint::readBlock ( MPI_File & fh, const CheckpointSection & section, void * buffer,
+                             const int first[3], const int length[3] ) {
+    if (_readEncoding != CHECKPOINT_RAW) {
+        readEncodedBlock(fh, section, buffer, first, length);
+        return;
+    }
+
+    MPI_Datatype etype = section.type == CHECKPOINT_INT ? MPI_INT : MY_MPI_FLOAT;
+    MPI_Datatype filetype;
+    MPI_Status status;
+
+    int sizes[3]    = {section.sizes[2], section.sizes[1], section.components * section.sizes[0]};
+    int subsizes[3] = {length[2], length[1], section.components * length[0]};
+    int starts[3]   = {first[2], first[1], section.components * first[0]};
+
+    MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, etype, &filetype);
+    MPI_Type_commit(&filetype);
+
+    MPI_File_set_view(fh, section.offset, etype, filetype, "native", MPI_INFO_NULL);
+    int ierr = MPI_File_read_all(fh, buffer, subsizes[0] * subsizes[1] * subsizes[2], etype, &status);
+    if (ierr != MPI_SUCCESS) {
+        handleError(1, "Cannot read the cell data from the checkpoint file.");
+    }
+    MPI_Type_free(&filetype);
+}
+
+void Checkpoint::writeEncodedBlock ( MPI_File & fh, CheckpointSection & section, const void * buffer,
+                                     const int first[3], const int length[3] ) {
+    MPI_Status status;
+    int nproc;
+    MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+
+    const size_t width = section.type == CHECKPOINT_INT ? sizeof(int) : sizeof(FLOAT);
+    const size_t count = (size_t) section.components * length[0] * length[1] * length[2];
+    const char * data = (const char *) buffer;
+    std::vector<char> values(data, data + count * width);
+
+    // Keyframes are kept to compute the following deltas, which are mostly zero
+    std::vector<char> & keyframe = _keyframeData[section.name];
+    if (_writeEncoding == CHECKPOINT_KEYFRAME) {
+        keyframe = values;
+    } else {
+        if (keyframe.size() != values.size()) {
+            handleError(1, "The keyframe of the checkpoint does not match the block of this rank.");
+        }
+        for (size_t b = 0; b < values.size(); b++) {
+            values[b] ^= keyframe[b];
+        }
+    }
+
+    std::vector<char> shuffled(values.size());
+    shuffleBytes(bufferStart(values), bufferStart(shuffled), count, width);
+    std::vector<char> compressed;
+    compressLZ(bufferStart(shuffled), shuffled.size(), compressed);
+
+    // Offset index: all ranks know the size of all blocks, so each one can write its block
+    // collectively at the right position
+    CheckpointBlock local;
+    memset(&local, 0, sizeof(CheckpointBlock));
+    for (int d = 0; d < 3; d++) {
+        local.first[d] = first[d];
+        local.length[d] = length[d];
+    }
+    local.bytes = compressed.size();
+
+    std::vector<CheckpointBlock> blocks(nproc);
+    MPI_Allgather(&local, sizeof(CheckpointBlock), MPI_BYTE, &blocks[0], sizeof(CheckpointBlock),
+                  MPI_BYTE, PETSC_COMM_WORLD);
+
+    const long long nBlocks = nproc;
+    long long position = section.offset + sizeof(long long) + nproc * sizeof(CheckpointBlock);
+    for (int r = 0; r < nproc; r++) {
+        blocks[r].offset = position;
+        position += blocks[r].bytes;
+    }
+    section.bytes = position - section.offset;
+
+    if (_parameters.parallel.rank == 0) {
+        MPI_File_write_at(fh, section.offset, const_cast<long long*>(&nBlocks), 1, MPI_LONG_LONG, &status);
+        MPI_File_write_at(fh, section.offset + sizeof(long long), &blocks[0],
+                          nproc * sizeof(CheckpointBlock), MPI_BYTE, &status);
+    }
+
+    // All ranks take part in as many collective writes as the rank with the largest block needs
+    const long long bytes = compressed.size();
+    long long pieces = (bytes + MAX_TRANSFER_BYTES - 1) / MAX_TRANSFER_BYTES, maxPieces = 0;
+    MPI_Allreduce(&pieces, &maxPieces, 1, MPI_LONG_LONG, MPI_MAX, PETSC_COMM_WORLD);
+    for (long long p = 0; p < maxPieces; p++) {
+        const long long begin = std::min(p * MAX_TRANSFER_BYTES, bytes);
+        const long long size = std::min(MAX_TRANSFER_BYTES, bytes - begin);
+        int ierr = MPI_File_write_at_all(fh, blocks[_parameters.parallel.rank].offset + begin,
+                                         size > 0 ? &compressed[begin] : NULL, (int) size, MPI_BYTE, &status);
+        if (ierr != MPI_SUCCESS) {
+            handleError(1, "Cannot write the compressed cell data to the checkpoint file.");
+        }
+    }
+}
+
+void Checkpoint::readIndex ( MPI_File & fh, const CheckpointSection & section,
+                             std::vector<CheckpointBlock> & blocks ) {
+    MPI_Status status;
+    long long nBlocks = 0;
+
+    MPI_File_read_at(fh, section.offset, &nBlocks, 1, MPI_LONG_LONG, &status);
+    if (nBlocks <= 0 || nBlocks * (long long) sizeof(CheckpointBlock) > section.bytes) {
+        handleError(1, "Corrupted offset index in the restart file.");
+    }
+    blocks.resize(nBlocks);
+    int ierr = MPI_File_read_at(fh, section.offset + sizeof(long long), &blocks[0],
+                                nBlocks * sizeof(CheckpointBlock), MPI_BYTE, &status);
+    if (ierr != MPI_SUCCESS) {
+        handleError(1, "Cannot read the offset index from the restart file.");
+    }
+}
+
+void Checkpoint::decodeBlock ( MPI_File & fh, const CheckpointBlock & block, size_t width,
+                               size_t count, std::vector<char> & values ) {
+    MPI_Status status;
+    std::vector<char> compressed(block.bytes);
+    std::vector<char> shuffled(count * width);
+
+    int ierr = MPI_SUCCESS;
+    for (long long begin = 0; begin < block.bytes && ierr == MPI_SUCCESS; begin += MAX_TRANSFER_BYTES) {
+        const long long size = std::min(MAX_TRANSFER_BYTES, block.bytes - begin);
+        ierr = MPI_File_read_at(fh, block.offset + begin, &compressed[begin], (int) size, MPI_BYTE, &status);
+    }
+    if (ierr != MPI_SUCCESS ||
+        !decompressLZ(bufferStart(compressed), compressed.size(), bufferStart(shuffled), shuffled.size())) {
+        handleError(1, "Cannot decompress the cell data of the restart file.");
+    }
+    values.resize(count * width);
+    unshuffleBytes(bufferStart(shuffled), bufferStart(values), count, width);
+}
+
+void Checkpoint::readEncodedBlock ( MPI_File & fh, const CheckpointSection & section, void * buffer,
+                                    const int first[3], const int length[3] ) {
+    const size_t width = section.type == CHECKPOINT_INT ? sizeof(int) : sizeof(FLOAT);
+    const size_t entryBytes = width * section.components;
+
+    std::vector<CheckpointBlock> blocks, keyframeBlocks;
+    readIndex(fh, section, blocks);
+
+    if (_readEncoding == CHECKPOINT_DELTA) {
+        const CheckpointSection * keyframeSection = NULL;
+        for (unsigned int s = 0; s < _keyframeSections.size(); s++) {
+            if (strncmp(_keyframeSections[s].name, section.name, sizeof(section.name)) == 0) {
+                keyframeSection = &_keyframeSections[s];
+            }
+        }
+        if (keyframeSection == NULL) {
+            handleError(1, "A section of the restart file is missing in its keyframe.");
+        }
+        readIndex(_keyframeFile, *keyframeSection, keyframeBlocks);
+        if (keyframeBlocks.size() != blocks.size()) {
+            handleError(1, "The keyframe of the restart file was written with other blocks.");
+        }
+    }
+
+    std::vector<char> values, keyframe;
+    for (unsigned int b = 0; b < blocks.size(); b++) {
+        const CheckpointBlock & block = blocks[b];
+
+        // Overlap of the block with the requested range
+        int low[3], high[3];
+        bool overlaps = true;
+        for (int d = 0; d < 3; d++) {
+            low[d]  = std::max(first[d], block.first[d]);
+            high[d] = std::min(first[d] + length[d], block.first[d] + block.length[d]);
+            overlaps = overlaps && low[d] < high[d];
+        }
+        if (!overlaps) {
+            continue;
+        }
+
+        const size_t count = (size_t) section.components * block.length[0] * block.length[1] * block.length[2];
+        decodeBlock(fh, block, width, count, values);
+
+        if (_readEncoding == CHECKPOINT_DELTA) {
+            for (int d = 0; d < 3; d++) {
+                if (keyframeBlocks[b].first[d] != block.first[d] || keyframeBlocks[b].length[d] != block.length[d]) {
+                    handleError(1, "The keyframe of the restart file was written with other blocks.");
+                }
+            }
+            decodeBlock(_keyframeFile, keyframeBlocks[b], width, count, keyframe);
+            for (size_t i = 0; i < values.size(); i++) {
+                values[i] ^= keyframe[i];
+            }
+        }
+
+        // Copy the overlapping rows
+        const size_t rowBytes = (high[0] - low[0]) * entryBytes;
+        for (int k = low[2]; k < high[2]; k++) {
+            for (int j = low[1]; j < high[1]; j++) {
+                const size_t source = ((size_t) (k - block.first[2]) * block.length[1] + (j - block.first[1]))
+                                      * block.length[0] + (low[0] - block.first[0]);
+                const size_t target = ((size_t) (k - first[2]) * length[1] + (j - first[1]))
+                                      * length[0] + (low[0] - first[0]);
+                memcpy((char *) buffer + target * entryBytes, &values[source * entryBytes], rowBytes);
+            }
+        }
+    }
+}
+
+void Checkpoint::writeField ( MPI_File & fh, CheckpointSection & section, ScalarField & field ) {
+    int first[3], length[3], local[3];
+    getFieldBlock(first, length, local, true);
+    std::vector<FLOAT> buffer(length[0] * length[1] * length[2]);
+    int counter = 0;
+    for (int k = local[2]; k < local[2] + length[2]; k++) {
+        for (int j = local[1]; j < local[1] + length[1]; j++) {
+            for (int i = local[0]; i < local[0] + length[0]; i++) {
+                buffer[counter++] = field.getScalar(i, j, k);
+            }
+        }
+    }
+    writeBlock(fh, section, &buffer[0], first, length);
+}
+
+void Checkpoint::writeField ( MPI_File & fh, CheckpointSection & section, VectorField & field ) {
+    int first[3], length[3], local[3];
+    getFieldBlock(first, length, local, true);
+    std::vector<FLOAT> buffer(section.components * length[0] * length[1] * length[2]);
+    int counter = 0;
+    for (int k = local[2]; k < local[2] + length[2]; k++) {
+        for (int j = local[1]; j < local[1] + length[1]; j++) {
+            for (int i = local[0]; i < local[0] + length[0]; i++) {
+                const FLOAT * value = field.getVector(i, j, k);
+                for (int c = 0; c < section.components; c++) {
+                    buffer[counter++] = value[c];
+                }
+            }
+        }
+    }
+    writeBlock(fh, section, &buffer[0], first, length);
+}
+
+void Checkpoint::writeField ( MPI_File & fh, CheckpointSection & section, IntScalarField & field ) {
+    int first[3], length[3], local[3];
+    getFieldBlock(first, length, local, true);
+    std::vector<int> buffer(length[0] * length[1] * length[2]);
+    int counter = 0;
+    for (int k = local[2]; k < local[2] + length[2]; k++) {
+        for (int j = local[1]; j < local[1] + length[1]; j++) {
+            for (int i = local[0]; i < local[0] + length[0]; i++) {
+                buffer[counter++] = field.getValue(i, j, k);
+            }
+        }
+    }
+    writeBlock(fh, section, &buffer[0], first, length);
+}
+
+void Checkpoint::readField ( MPI_File & fh, const CheckpointSection & section, ScalarField & field ) {
+    int first[3], length[3], local[3];
+    getFieldBlock(first, length, local, false);
+    std::vector<FLOAT> buffer(length[0] * length[1] * length[2]);
+    readBlock(fh, section, &buffer[0], first, length);
+    int counter = 0;
+    for (int k = local[2]; k < local[2] + length[2]; k++) {
+        for (int j = local[1]; j < local[1] + length[1]; j++) {
+            for (int i = local[0]; i < local[0] + length[0]; i++) {
+                field.getScalar(i, j, k) = buffer[counter++];
+            }
+        }
+    }
+}
+
+void Checkpoint::readField ( MPI_File & fh, const CheckpointSection & section, VectorField & field ) {
+    int first[3], length[3], local[3];
+    getFieldBlock(first, length, local, false);
+    std::vector<FLOAT> buffer(section.components * length[0] * length[1] * length[2]);
+    readBlock(fh, section, &buffer[0], first, length);
+    int counter = 0;
+    for (int k = local[2]; k < local[2] + length[2]; k++) {
+        for (int j = local[1]; j < local[1] + length[1]; j++) {
+            for (int i = local[0]; i < local[0] + length[0]; i++) {
+                FLOAT * value = field.getVector(i, j, k);
+                for (int c = 0; c < section.components; c++) {
+                    value[c] = buffer[counter++];
+                }
+            }
+        }
+    }
+}
+
+void Checkpoint::readField ( MPI_File & fh, const CheckpointSection & section, IntScalarField & field ) {
+    int first[3], length[3], local[3];
+    getFieldBlock(first, length, local, false);
+    std::vector<int> buffer(length[0] * length[1] * length[2]);
+    readBlock(fh, section, &buffer[0], first, length);
+    int counter = 0;
+    for (int k = local[2]; k < local[2] + length[2]; k++) {
+        for (int j = local[1]; j < local[1] + length[1]; j++) {
+            for (int i = local[0]; i < local[0] + length[0]; i++) {
+                field.getValue(i, j, k) = buffer[counter++];
+            }
+        }
+    }
+}
+
+bool Checkpoint::readTable ( MPI_File & fh, CheckpointHeader & header,
+                             std::vector<CheckpointSection> & sections ) const {
+    MPI_Status status;
+    int count;
+
+    // Files in the original format start with the time step and are not long enough or don't
+    // carry the tag
+    memset(&header, 0, sizeof(CheckpointHeader));
+    MPI_File_read_at(fh, 0, &header, sizeof(CheckpointHeader), MPI_BYTE, &status);
+    MPI_Get_count(&status, MPI_BYTE, &count);
+    if (count != (int) sizeof(CheckpointHeader) ||
+        memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+        return false;
+    }
+
+    if (header.version > CHECKPOINT_VERSION) {
+        handleError(1, "The restart file was written by a newer version of the checkpoint format.");
+    }
+    if (header.dim != _parameters.geometry.dim ||
+        header.sizes[0] != _parameters.geometry.sizeX ||
+        header.sizes[1] != _parameters.geometry.sizeY ||
+        (header.dim == 3 && header.sizes[2] != _parameters.geometry.sizeZ)) {
+        handleError(1, "The geometry of the restart file does not match the configuration.");
+    }
+
+    sections.resize(header.nSections);
+    if (header.nSections > 0) {
+        int ierr = MPI_File_read_at(fh, sizeof(CheckpointHeader), &sections[0],
+                                    header.nSections * sizeof(CheckpointSection), MPI_BYTE, &status);
+        if (ierr != MPI_SUCCESS) {
+            handleError(1, "Cannot read the section table from the restart file.");
+        }
+    }
+    return true;
+}
+
+bool Checkpoint::containsState ( const std::vector<CheckpointSection> & sections ) const {
+    for (unsigned int s = 0; s < _sections.size(); s++) {
+        // Files of version 2 have no encoding
+        if (strcmp(_sections[s].name, "encoding") == 0) {
+            continue;
+        }
+        bool found = false;
+        for (unsigned int f = 0; f < sections.size(); f++) {
+            if (strncmp(_sections[s].name, sections[f].name, sizeof(sections[f].name)) == 0) {
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Checkpoint::isComplete () const {
+    MPI_File fh_restart;
+    CheckpointHeader header;
+    std::vector<CheckpointSection> sections;
+
+    char* tmp_filename = new char[_parameters.restart.filename.size() + 1];
+    strcpy(tmp_filename, _parameters.restart.filename.c_str());
+    int ierr = MPI_File_open(PETSC_COMM_WORLD, tmp_filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh_restart);
+    delete[] tmp_filename;
+
+    if (ierr != MPI_SUCCESS) {
+        handleError(1, "Cannot open the restart file.");
+    }
+
+    bool complete = readTable(fh_restart, header, sections) && containsState(sections);
+    MPI_File_close(&fh_restart);
+    return complete;
+}
 
-void Checkpoint::read ( int& timeStep, FLOAT& time ) {
+bool Checkpoint::read ( int& timeStep, FLOAT& time ) {
     MPI_File fh_restart;
     MPI_Status status;
-    MPI_Offset disp;
+    CheckpointHeader header;
+    std::vector<CheckpointSection> sections;
     int ierr;
 
     // Open the restart file
-    char* tmp_filename = new char[strlen(_parameters.restart.filename.c_str())];
+    char* tmp_filename = new char[_parameters.restart.filename.size() + 1];
     strcpy(tmp_filename, _parameters.restart.filename.c_str());
     ierr = MPI_File_open(PETSC_COMM_WORLD, tmp_filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh_restart);
     delete[] tmp_filename;
@@ -68,14 +576,111 @@ void Checkpoint::read ( int& timeStep, FLOAT& time ) {
         handleError(1, "Cannot open the restart file.");
     }
 
+    if (!readTable(fh_restart, header, sections)) {
+        readLegacy(fh_restart, timeStep, time);
+        return false;
+    }
+
+    timeStep = header.timeStep;
+    time = header.time;
+
+    // The encoding applies to all field sections, so it is read first
+    _readEncoding = CHECKPOINT_RAW;
+    int encoding[2] = {CHECKPOINT_RAW, -1};
+    for (unsigned int s = 0; s < sections.size(); s++) {
+        if (strcmp(sections[s].name, "encoding") == 0) {
+            MPI_File_read_at(fh_restart, sections[s].offset, encoding, 2, MPI_INT, &status);
+            _readEncoding = encoding[0];
+        }
+    }
+
+    // Deltas are stored against a keyframe in the same directory: prefix.<keyframe time step>
+    if (_readEncoding == CHECKPOINT_DELTA) {
+        const std::string keyframeFileName = getKeyframeFileName(_parameters.restart.filename, encoding[1]);
+
+        tmp_filename = new char[keyframeFileName.size() + 1];
+        strcpy(tmp_filename, keyframeFileName.c_str());
+        ierr = MPI_File_open(PETSC_COMM_WORLD, tmp_filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &_keyframeFile);
+        delete[] tmp_filename;
+
+        CheckpointHeader keyframeHeader;
+        if (ierr != MPI_SUCCESS || !readTable(_keyframeFile, keyframeHeader, _keyframeSections)) {
+            handleError(1, "Cannot open the keyframe of the restart file.");
+        }
+    }
+
+    for (unsigned int s = 0; s < sections.size(); s++) {
+        const CheckpointSection & section = sections[s];
+        const std::string name(section.name, strnlen(section.name, sizeof(section.name)));
+
+        // Each rank reads the same sections, which keeps the collective reads matched
+        ierr = MPI_SUCCESS;
+        if (name == "dt") {
+            ierr = MPI_File_read_at(fh_restart, section.offset, &_parameters.timestep.dt, 1, MY_MPI_FLOAT, &status);
+        } else if (name == "solverStatistics") {
+            int statistics[2];
+            ierr = MPI_File_read_at(fh_restart, section.offset, statistics, 2, MPI_INT, &status);
+            _solver.setStatistics(statistics[0], statistics[1]);
+        } else if (name == "flags") {
+            readField(fh_restart, section, _flowField.getFlags());
+        } else if (name == "pressure") {
+            readField(fh_restart, section, _flowField.getPressure());
+        } else if (name == "velocity") {
+            if (section.components != _parameters.geometry.dim) {
+                handleError(1, "Wrong number of velocity components in the restart file.");
+            }
+            readField(fh_restart, section, _flowField.getVelocity());
+        } else if (name == "pressureGuess") {
+            int first[3], length[3];
+            _solver.getLocalBlock(first, length);
+            std::vector<FLOAT> buffer(length[0] * length[1] * length[2]);
+            readBlock(fh_restart, section, &buffer[0], first, length);
+            _solver.setSolution(&buffer[0]);
+        } else if (name == "turbViscosity" && _turbulent) {
+            readField(fh_restart, section, _turbFlowField->getTurbViscosity());
+        } else if (name == "distNearestWall" && _turbulent) {
+            readField(fh_restart, section, _turbFlowField->getDistNearestWall());
+        } else if (name == "nuTilde" && _spalartAllmaras) {
+            readField(fh_restart, section, _turbFlowField->getNuTilde());
+        } else if (name == "turbViscAge" && _turbViscAge != NULL) {
+            // the fields read before it have changed the view
+            MPI_File_set_view(fh_restart, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL);
+            ierr = MPI_File_read_at(fh_restart, section.offset, _turbViscAge, 1, MPI_INT, &status);
+        } else if (name == "strainRateReference" && _strainRateReference != NULL) {
+            readField(fh_restart, section, *_strainRateReference);
+        }
+        // Other sections, e.g. turbulent fields in a DNS, are skipped
+        if (ierr != MPI_SUCCESS) {
+            handleError(1, "Cannot read a section of the restart file.");
+        }
+    }
+
+    if (_readEncoding == CHECKPOINT_DELTA) {
+        MPI_File_close(&_keyframeFile);
+    }
+
+    // Close the file
+    ierr = MPI_File_close(&fh_restart);
+    if (ierr != MPI_SUCCESS) {
+        handleError(1, "Cannot close the restart file.");
+    }
+
+    return containsState(sections);
+}
+
+void Checkpoint::readLegacy ( MPI_File & fh_restart, int& timeStep, FLOAT& time ) {
+    MPI_Status status;
+    MPI_Offset disp;
+    int ierr;
+
     // Read the timeStep
-    MPI_File_read_at(fh_restart, 0, &timeStep, 1, MPI_INT, &status);
+    ierr = MPI_File_read_at(fh_restart, 0, &timeStep, 1, MPI_INT, &status);
     if (ierr != MPI_SUCCESS) {
         handleError(1, "Cannot read the timeStep from the restart file.");
     }
 
     // Read the time
-    MPI_File_read_at(fh_restart, sizeof(int), &time, 1, MY_MPI_FLOAT, &status);
+    ierr = MPI_File_read_at(fh_restart, sizeof(int), &time, 1, MY_MPI_FLOAT, &status);
     if (ierr != MPI_SUCCESS) {
         handleError(1, "Cannot read the time from the restart file.");
     }
@@ -143,16 +748,18 @@ void Checkpoint::read ( int& timeStep, FLOAT& time ) {
 void Checkpoint::create ( int timeStep, FLOAT time ) {
     MPI_File fh_checkpoint;
     MPI_Status status;
-    MPI_Offset disp;
+    SimpleTimer timer;
     int ierr;
 
+    timer.start();
+
     // Set the filename of the checkpoint file
     std::ostringstream checkpointFileName;
     checkpointFileName << _parameters.checkpoint.directory << _parameters.checkpoint.prefix
              << "." << std::setfill('0') << std::setw(6) << timeStep;
 
     // Open the file and assign it to the handler fh_checkpoint.
-    char* tmp_filename = new char[strlen(checkpointFileName.str().c_str())];
+    char* tmp_filename = new char[checkpointFileName.str().size() + 1];
     strcpy(tmp_filename, checkpointFileName.str().c_str());
     ierr = MPI_File_open(PETSC_COMM_WORLD, tmp_filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh_checkpoint);
     delete[] tmp_filename;
@@ -161,79 +768,107 @@ void Checkpoint::create ( int timeStep, FLOAT time ) {
         handleError(1, "Cannot open/create checkpoint file.");
     }
 
-    // Write the header of the file using Rank0.
-    if (_parameters.parallel.rank == 0) {
+    // Drop the contents of an older file with the same name
+    MPI_File_set_size(fh_checkpoint, 0);
 
-        // Write the timeStep
-        ierr = MPI_File_write(fh_checkpoint, &timeStep, 1, MPI_INT, &status);
+    // Raw, keyframe or delta. The first checkpoint of a run is always a keyframe.
+    if (!_parameters.checkpoint.compress) {
+        _writeEncoding = CHECKPOINT_RAW;
+    } else if (_keyframeStep < 0 || _sinceKeyframe >= _parameters.checkpoint.keyframeInterval) {
+        _writeEncoding = CHECKPOINT_KEYFRAME;
+        _keyframeStep = timeStep;
+        _sinceKeyframe = 0;
+    } else {
+        _writeEncoding = CHECKPOINT_DELTA;
+    }
+    _sinceKeyframe++;
+
+    // The offsets and lengths are filled in while writing. The data follows the header and the
+    // section table.
+    std::vector<CheckpointSection> sections = _sections;
+    long long rawBytes = sizeof(CheckpointHeader) + sections.size() * sizeof(CheckpointSection);
+    for (unsigned int s = 0; s < sections.size(); s++) {
+        rawBytes += sections[s].bytes;
+    }
+    _position = sizeof(CheckpointHeader) + sections.size() * sizeof(CheckpointSection);
+
+    // Records common to all ranks, written by Rank0
+    int statistics[2] = {_solver.getSolves(), _solver.getIterations()};
+    int encoding[2] = {_writeEncoding, _writeEncoding == CHECKPOINT_RAW ? -1 : _keyframeStep};
+    for (int s = 0; s < 3; s++) {
+        sections[s].offset = _position;
+        _position += sections[s].bytes;
+    }
+    if (_turbViscAge != NULL) {
+        sections[_turbViscSection].offset = _position;
+        _position += sections[_turbViscSection].bytes;
+    }
+    if (_parameters.parallel.rank == 0) {
+        ierr = MPI_File_write_at(fh_checkpoint, sections[0].offset, &_parameters.timestep.dt, 1, MY_MPI_FLOAT, &status);
         if (ierr != MPI_SUCCESS) {
-            handleError(1, "Cannot write the timeStep to the checkpoint file.");
+            handleError(1, "Cannot write the time step size to the checkpoint file.");
         }
-
-        // Write the time
-        ierr = MPI_File_write(fh_checkpoint, &time, 1, MY_MPI_FLOAT, &status);
+        ierr = MPI_File_write_at(fh_checkpoint, sections[1].offset, statistics, 2, MPI_INT, &status);
         if (ierr != MPI_SUCCESS) {
-            handleError(1, "Cannot write the time to the checkpoint file.");
+            handleError(1, "Cannot write the solver statistics to the checkpoint file.");
+        }
+        ierr = MPI_File_write_at(fh_checkpoint, sections[2].offset, encoding, 2, MPI_INT, &status);
+        if (ierr != MPI_SUCCESS) {
+            handleError(1, "Cannot write the encoding to the checkpoint file.");
+        }
+        if (_turbViscAge != NULL) {
+            ierr = MPI_File_write_at(fh_checkpoint, sections[_turbViscSection].offset, _turbViscAge, 1, MPI_INT, &status);
+            if (ierr != MPI_SUCCESS) {
+                handleError(1, "Cannot write the age of the turbulent viscosity to the checkpoint file.");
+            }
         }
-
     }
 
-    // Displacement of the file view from the begining of the file.
-    // The header we wrote consists of an int and a FLOAT.
-    disp = sizeof(int) + sizeof(FLOAT);
+    // Fields, written collectively in the order of the section table
+    writeField(fh_checkpoint, sections[3], _flowField.getFlags());
+    writeField(fh_checkpoint, sections[4], _flowField.getPressure());
+    writeField(fh_checkpoint, sections[5], _flowField.getVelocity());
 
-    // Note: we assume that we are only using the same machine always, for performance reasons.
-    MPI_File_set_view(fh_checkpoint, disp, MY_MPI_FLOAT, _filetype, "native", MPI_INFO_NULL);
+    int first[3], length[3];
+    _solver.getLocalBlock(first, length);
+    std::vector<FLOAT> guess(length[0] * length[1] * length[2]);
+    _solver.getSolution(&guess[0]);
+    writeBlock(fh_checkpoint, sections[6], &guess[0], first, length);
 
-    // 2D or 3D case?
-    if (_parameters.geometry.dim == 2) {
-    // 2D case
-        FLOAT localarray[_parameters.parallel.localSize[0]][3*_parameters.parallel.localSize[1]];
-
-        // Prepare the cell data for writting to the file.
-        for (int i=0; i < _parameters.parallel.localSize[0]; i++) {
-            for (int j=0; j < _parameters.parallel.localSize[1]; j++) {
-                // Pressure
-                localarray[i][3*j] = _flowField.getPressure().getScalar(i+2,j+2);
-                // Velocities per x,y
-                localarray[i][3*j+1] = _flowField.getVelocity().getVector(i+2,j+2)[0];
-                localarray[i][3*j+2] = _flowField.getVelocity().getVector(i+2,j+2)[1];
-            }
-        }
-
-        // Number of elements to write
-        int data_count = 3 * _parameters.parallel.localSize[0] * _parameters.parallel.localSize[1];
+    if (_turbulent) {
+        writeField(fh_checkpoint, sections[7], _turbFlowField->getTurbViscosity());
+        writeField(fh_checkpoint, sections[8], _turbFlowField->getDistNearestWall());
+    }
+    if (_spalartAllmaras) {
+        writeField(fh_checkpoint, sections[9], _turbFlowField->getNuTilde());
+    }
+    if (_strainRateReference != NULL) {
+        writeField(fh_checkpoint, sections[_turbViscSection + 1], *_strainRateReference);
+    }
 
-        // Write the cell data to the file
-        ierr = MPI_File_write(fh_checkpoint, localarray, data_count, MY_MPI_FLOAT, &status);
+    // Write the header and the section table using Rank0, now that all the sizes are known.
+    MPI_File_set_view(fh_checkpoint, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL);
+    if (_parameters.parallel.rank == 0) {
+        CheckpointHeader header;
+        memset(&header, 0, sizeof(CheckpointHeader));
+        memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        header.version = CHECKPOINT_VERSION;
+        header.dim = _parameters.geometry.dim;
+        header.sizes[0] = _parameters.geometry.sizeX;
+        header.sizes[1] = _parameters.geometry.sizeY;
+        header.sizes[2] = _parameters.geometry.dim == 3 ? _parameters.geometry.sizeZ : 1;
+        header.timeStep = timeStep;
+        header.time = time;
+        header.nSections = sections.size();
+
+        ierr = MPI_File_write_at(fh_checkpoint, 0, &header, sizeof(CheckpointHeader), MPI_BYTE, &status);
         if (ierr != MPI_SUCCESS) {
-            handleError(1, "Cannot write the cell data to the checkpoint file.");
+            handleError(1, "Cannot write the header to the checkpoint file.");
         }
-    } else {
-    // 3D case
-        FLOAT localarray[_parameters.parallel.localSize[0]][_parameters.parallel.localSize[1]][4*_parameters.parallel.localSize[2]];
-
-        // Prepare the data to write to the file.
-        for (int i=0; i < _parameters.parallel.localSize[0]; i++) {
-            for (int j=0; j < _parameters.parallel.localSize[1]; j++) {
-                for (int k=0; k < _parameters.parallel.localSize[2]; k++) {
-                    // Pressure
-                    localarray[i][j][4*k] = _flowField.getPressure().getScalar(i+2,j+2,k+2);
-                    // Velocities per x,y,z
-                    localarray[i][j][4*k+1] = _flowField.getVelocity().getVector(i+2,j+2,k+2)[0];
-                    localarray[i][j][4*k+2] = _flowField.getVelocity().getVector(i+2,j+2,k+2)[1];
-                    localarray[i][j][4*k+3] = _flowField.getVelocity().getVector(i+2,j+2,k+2)[2];
-                }
-            }
-        }
-
-        // Number of elements to write
-        int data_count = 4 * _parameters.parallel.localSize[0] * _parameters.parallel.localSize[1] * _parameters.parallel.localSize[2];
-
-        // Write the cell data to the file
-        ierr = MPI_File_write(fh_checkpoint, localarray, data_count, MY_MPI_FLOAT, &status);
+        ierr = MPI_File_write_at(fh_checkpoint, sizeof(CheckpointHeader), &sections[0],
+                                 sections.size() * sizeof(CheckpointSection), MPI_BYTE, &status);
         if (ierr != MPI_SUCCESS) {
-            handleError(1, "Cannot write the cell data to the checkpoint file.");
+            handleError(1, "Cannot write the section table to the checkpoint file.");
         }
     }
 
@@ -242,6 +877,15 @@ void Checkpoint::create ( int timeStep, FLOAT time ) {
     if (ierr != MPI_SUCCESS) {
         handleError(1, "Cannot close the checkpoint file.");
     }
+
+    // Report the effect of the compression
+    if (_parameters.checkpoint.compress && _parameters.parallel.rank == 0) {
+        const FLOAT elapsed = timer.getTimeAndContinue();
+        printf("Checkpoint %d (%s): %.3f MB -> %.3f MB, ratio %.2f, %.1f MB/s\n", timeStep,
+               _writeEncoding == CHECKPOINT_KEYFRAME ? "keyframe" : "delta",
+               rawBytes / 1.0e6, _position / 1.0e6, (FLOAT) rawBytes / _position,
+               _position / 1.0e6 / elapsed);
+    }
 }
 
 void Checkpoint::cleandir () {
@@ -249,11 +893,11 @@ void Checkpoint::cleandir () {
     // Clean the directory from previous restart data
     DIR *checkpointDir = opendir(_parameters.checkpoint.directory.c_str());
     struct dirent *next_file;
-    char filepath[256];
+    std::string filepath;
 
     while( (next_file = readdir(checkpointDir)) != NULL ) {
-        sprintf(filepath, "%s/%s", _parameters.checkpoint.directory.c_str(), next_file->d_name);
-        remove(filepath);
+        filepath = _parameters.checkpoint.directory + "/" + next_file->d_name;
+        remove(filepath.c_str());
     }
     closedir(checkpointDir);
 
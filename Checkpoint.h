@@ -4,42 +4,163 @@
 #include "Definitions.h"
 #include "Parameters.h"
 #include "FlowField.h"
+#include "TurbulentFlowField.h"
+#include "solvers/PetscSolver.h"
+#include "CheckpointFormat.h"
+#include "Compression.h"
+#include "SimpleTimer.h"
 #include "sstream"
 #include "iomanip"
+#include "vector"
+#include "map"
 #include "dirent.h"
 #include "sys/stat.h"
 
+/** Writes and reads checkpoints.
+ *
+ * The fields are stored including the ghost layers of the global boundary, so that a restart
+ * restores the state of the previous run without initializing the flow field again. Besides
+ * pressure and velocity, the flags, the turbulent fields, the last time step, the statistics of
+ * the linear solver and its initial guess are stored in named sections, as well as the state of
+ * subcycled updates of the turbulent viscosity.
+ *
+ * With compression enabled, every keyframeInterval-th checkpoint is a keyframe, in which each
+ * rank compresses its blocks. The checkpoints in between only store the compressed XOR against
+ * the keyframe, so a restart needs the delta file and its keyframe.
+ */
 class Checkpoint {
 
     private:
 
         FlowField & _flowField;
-        const Parameters & _parameters;
+        Parameters & _parameters;
+        PetscSolver & _solver;
 
-        MPI_Datatype _filetype;
+        bool _turbulent;
+        bool _spalartAllmaras;      //! Whether the working variable of the Spalart-Allmaras model is stored
+        TurbulentFlowField * _turbFlowField;
+
+        // State of the subcycled updates of the turbulent viscosity, if it is stored
+        int _turbViscSection;               //! Index of its first section, -1 if not stored
+        int * _turbViscAge;                 //! Time steps since the last update
+        ScalarField * _strainRateReference; //! Strain rate norms of the last update, NULL without threshold
+
+        MPI_Datatype _filetype;   //! File view of the original format, used to read old files
+
+        std::vector<CheckpointSection> _sections;   //! Sections written by this simulation
+
+        // State of compressed checkpointing
+        int _keyframeStep;      //! Time step of the last keyframe, -1 if none was written yet
+        int _sinceKeyframe;     //! Number of checkpoints written since the last keyframe
+        std::map<std::string, std::vector<char> > _keyframeData;   //! Local blocks of the last keyframe
+
+        int _writeEncoding;     //! Encoding of the file being written
+        long long _position;    //! Position of the next section in the file being written
+
+        int _readEncoding;      //! Encoding of the file being read
+        MPI_File _keyframeFile; //! Keyframe of the delta being read
+        std::vector<CheckpointSection> _keyframeSections;
+
+        /** Adds a section to the table, placing its data after the previous section */
+        void addSection ( const std::string & name, int type, int components,
+                          int sizeX, int sizeY, int sizeZ );
+
+        /** Reads the header and the section table of an open restart file. Returns false if the
+         *  file has the original format.
+         */
+        bool readTable ( MPI_File & fh, CheckpointHeader & header,
+                         std::vector<CheckpointSection> & sections ) const;
+
+        /** Checks whether the section table contains the state of this simulation */
+        bool containsState ( const std::vector<CheckpointSection> & sections ) const;
+
+        /** Reads a file in the original format (pressure and velocity of the inner cells) */
+        void readLegacy ( MPI_File & fh, int& timeStep, FLOAT& time );
+
+        /** Writes the local block of a field section collectively at the current position, in
+         *  the encoding of the file. Sets the offset and the length of the section.
+         * @param first Global index of the first local entry per dimension
+         * @param length Number of local entries per dimension
+         */
+        void writeBlock ( MPI_File & fh, CheckpointSection & section, const void * buffer,
+                          const int first[3], const int length[3] );
+
+        /** Compresses the local block, writes it and the offset index of all blocks */
+        void writeEncodedBlock ( MPI_File & fh, CheckpointSection & section, const void * buffer,
+                                 const int first[3], const int length[3] );
+
+        /** Reads a local block of a field section collectively */
+        void readBlock ( MPI_File & fh, const CheckpointSection & section, void * buffer,
+                         const int first[3], const int length[3] );
+
+        /** Reads a local block from the compressed blocks overlapping it, so that files written
+         *  with a different domain decomposition can be read as well
+         */
+        void readEncodedBlock ( MPI_File & fh, const CheckpointSection & section, void * buffer,
+                                const int first[3], const int length[3] );
+
+        /** Reads the offset index of a compressed section */
+        void readIndex ( MPI_File & fh, const CheckpointSection & section,
+                         std::vector<CheckpointBlock> & blocks );
+
+        /** Reads and decompresses a block of values of the given width in bytes */
+        void decodeBlock ( MPI_File & fh, const CheckpointBlock & block, size_t width,
+                           size_t count, std::vector<char> & values );
+
+        /** Local range of a flow field array in the global array of the checkpoint. For writing,
+         *  only the inner cells and the ghost layers at the global boundary are considered, so
+         *  that the blocks of different ranks do not overlap.
+         */
+        void getFieldBlock ( int first[3], int length[3], int localFirst[3], bool write ) const;
+
+        void writeField ( MPI_File & fh, CheckpointSection & section, ScalarField & field );
+        void writeField ( MPI_File & fh, CheckpointSection & section, VectorField & field );
+        void writeField ( MPI_File & fh, CheckpointSection & section, IntScalarField & field );
+        void readField ( MPI_File & fh, const CheckpointSection & section, ScalarField & field );
+        void readField ( MPI_File & fh, const CheckpointSection & section, VectorField & field );
+        void readField ( MPI_File & fh, const CheckpointSection & section, IntScalarField & field );
 
     public:
 
         /** Constructor
          *
-         * @param parameters Parameters of the problem
+         * @param flowField Flow field to store. Turbulent fields are included in turbulent
+         *                  simulations
+         * @param parameters Parameters of the problem. The time step is restored when reading
+         * @param solver Pressure solver, whose initial guess and statistics are stored as well
          */
-        Checkpoint ( FlowField & flowField, const Parameters & parameters );
+        Checkpoint ( FlowField & flowField, Parameters & parameters, PetscSolver & solver );
 
         ~Checkpoint();
 
+        /** Stores the state of the subcycled updates of the turbulent viscosity as well, so that
+         *  a restart updates it in the same time steps as the original run. Called before the
+         *  first checkpoint is read or written.
+         * @param age Time steps since the last update, -1 before the first one
+         * @param reference Strain rate norms of the last update, NULL if the updates do not
+         *                  depend on the change of the strain rate
+         */
+        void addTurbViscUpdates ( int & age, ScalarField * reference );
+
         /** Reads a checkpoint file
         * @param timeStep the restart timestep
         * @param time the restart time
+        * @return true if the file contained all the sections of this simulation, i.e. the flow
+        *         field did not have to be initialized before reading it
         */
-        void read ( int& timeStep, FLOAT& time );
+        bool read ( int& timeStep, FLOAT& time );
+
+        /** Checks whether the restart file contains all the sections written by this simulation.
+         *  If so, the initialization of the flow field can be skipped when restarting.
+         */
+        bool isComplete () const;
 
         /** Creates a checkpoint file
          * @param timeStep the current timestep
          * @param time the current time
          */
         void create ( int timeStep, FLOAT time );
-        
+
         /** Clean the restart directory
         */
         void cleandir ();
@@ -0,0 +1,71 @@
+#ifndef _CHECKPOINT_FORMAT_H_
+#define _CHECKPOINT_FORMAT_H_
+
+#include "Definitions.h"
+#include <string>
+#include <sstream>
+#include <iomanip>
+
+//! Tag at the beginning of versioned checkpoint files. Files without it use the original format
+//! (int timeStep, FLOAT time, followed by pressure and velocity of the inner cells).
+const char CHECKPOINT_MAGIC[8] = {'N','S','E','O','F','C','K','P'};
+const int CHECKPOINT_VERSION = 3;
+
+//! Data types of the sections
+enum CheckpointType {
+    CHECKPOINT_FLOAT = 0,
+    CHECKPOINT_INT   = 1
+};
+
+//! Storage of the field sections, given by the "encoding" record. Version 2 files are raw.
+enum CheckpointEncoding {
+    CHECKPOINT_RAW      = 0,    //! Global array, written with a subarray file view
+    CHECKPOINT_KEYFRAME = 1,    //! Compressed block of each rank
+    CHECKPOINT_DELTA    = 2     //! Compressed XOR of each block with the one of the last keyframe
+};
+
+/** Header of a versioned checkpoint file, written by rank 0 at the beginning of the file */
+struct CheckpointHeader {
+    char magic[8];      //! CHECKPOINT_MAGIC
+    int version;        //! Format version
+    int dim;            //! Dimension of the problem
+    int sizes[3];       //! Global number of cells (sizeZ = 1 in 2D)
+    int timeStep;       //! Time step of the checkpoint
+    FLOAT time;         //! Simulation time of the checkpoint
+    int nSections;      //! Number of entries in the section table following the header
+};
+
+/** Entry of the section table. A section is either a field over a global grid, stored in the
+ *  memory order of a single-process flow field (x fastest, components interleaved), or a small
+ *  record of values common to all ranks (sizes = 1,1,1).
+ */
+struct CheckpointSection {
+    char name[32];      //! Name of the section, e.g. "pressure"
+    int type;           //! CheckpointType of the entries
+    int components;     //! Number of entries per cell
+    int sizes[3];       //! Global extent of the section
+    long long offset;   //! Position of the data from the beginning of the file, in bytes
+    long long bytes;    //! Length of the data, in bytes
+};
+
+/** Entry of the offset index of a compressed section. The index starts with the number of blocks
+ *  (long long) and is followed by the compressed blocks, one per rank of the writing run.
+ */
+struct CheckpointBlock {
+    int first[3];       //! Global index of the first entry of the block
+    int length[3];      //! Extent of the block
+    long long offset;   //! Position of the compressed data from the beginning of the file
+    long long bytes;    //! Length of the compressed data
+};
+
+/** Name of the keyframe of a delta checkpoint: the prefix of the delta file name followed by the
+ *  time step of the keyframe
+ */
+inline std::string getKeyframeFileName ( const std::string & filename, int keyframeStep ) {
+    std::ostringstream keyframeFileName;
+    keyframeFileName << filename.substr(0, filename.find_last_of("."))
+                     << "." << std::setfill('0') << std::setw(6) << keyframeStep;
+    return keyframeFileName.str();
+}
+
+#endif
@@ -0,0 +1,388 @@
+#include "CheckpointReader.h"
+#include "Compression.h"
+#include "MeshsizeFactory.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+CheckpointReader::CheckpointReader ( const std::string & filename, const Parameters & parameters ) :
+_parameters(parameters),
+_filename(filename),
+_fd(-1),
+_data(NULL),
+_size(0),
+_legacy(false),
+_encoding(CHECKPOINT_RAW),
+_keyframeStep(-1),
+_keyframe(NULL)
+{
+    struct stat status;
+    _fd = open(filename.c_str(), O_RDONLY);
+    if (_fd < 0 || fstat(_fd, &status) != 0) {
+        handleError(1, "Cannot open the checkpoint file.");
+    }
+    _size = status.st_size;
+    if (_size > 0) {
+        void * mapping = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        if (mapping == MAP_FAILED) {
+            handleError(1, "Cannot map the checkpoint file into memory.");
+        }
+        _data = (const char *) mapping;
+        // The sections are mostly read from the beginning to the end
+        madvise(mapping, _size, MADV_SEQUENTIAL);
+    }
+
+    memset(&_header, 0, sizeof(CheckpointHeader));
+    if (!readTable()) {
+        readLegacy();
+    }
+}
+
+CheckpointReader::~CheckpointReader () {
+    delete _keyframe;
+    if (_data != NULL) {
+        munmap(const_cast<char *>(_data), _size);
+    }
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+bool CheckpointReader::readTable () {
+    if (_size < sizeof(CheckpointHeader) ||
+        memcmp(_data, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+        return false;
+    }
+    memcpy(&_header, _data, sizeof(CheckpointHeader));
+
+    if (_header.version > CHECKPOINT_VERSION) {
+        handleError(1, "The checkpoint file was written by a newer version of the checkpoint format.");
+    }
+    if (_header.dim != _parameters.geometry.dim ||
+        _header.sizes[0] != _parameters.geometry.sizeX ||
+        _header.sizes[1] != _parameters.geometry.sizeY ||
+        (_header.dim == 3 && _header.sizes[2] != _parameters.geometry.sizeZ)) {
+        handleError(1, "The geometry of the checkpoint file does not match the configuration.");
+    }
+
+    const size_t tableEnd = sizeof(CheckpointHeader) + (size_t) _header.nSections * sizeof(CheckpointSection);
+    if (_header.nSections < 0 || tableEnd > _size) {
+        handleError(1, "Corrupted section table in the checkpoint file.");
+    }
+    _sections.resize(_header.nSections);
+    if (_header.nSections > 0) {
+        memcpy(&_sections[0], _data + sizeof(CheckpointHeader), _header.nSections * sizeof(CheckpointSection));
+    }
+    for (unsigned int s = 0; s < _sections.size(); s++) {
+        if (_sections[s].offset < 0 || _sections[s].bytes < 0 ||
+            (size_t) (_sections[s].offset + _sections[s].bytes) > _size) {
+            handleError(1, "A section exceeds the end of the checkpoint file.");
+        }
+    }
+
+    // Version 2 files have no encoding and are raw
+    const CheckpointSection * encoding = findSection("encoding");
+    if (encoding != NULL) {
+        int values[2];
+        memcpy(values, _data + encoding->offset, sizeof(values));
+        _encoding = values[0];
+        _keyframeStep = values[1];
+    }
+    return true;
+}
+
+void CheckpointReader::readLegacy () {
+    // The original format starts with the time step and the time, followed by pressure and
+    // velocity of the inner cells: [i][j][k][p,u,v,w] in 3D and [i][j][p,u,v] in 2D
+    _legacy = true;
+    const int dim = _parameters.geometry.dim;
+    const int sizeX = _parameters.geometry.sizeX;
+    const int sizeY = _parameters.geometry.sizeY;
+    const int sizeZ = dim == 3 ? _parameters.geometry.sizeZ : 1;
+    const size_t headerBytes = sizeof(int) + sizeof(FLOAT);
+    const size_t count = (size_t) (dim + 1) * sizeX * sizeY * sizeZ;
+
+    if (_size != headerBytes + count * sizeof(FLOAT)) {
+        handleError(1, "The checkpoint file has neither the versioned nor the original format of this geometry.");
+    }
+    memcpy(_header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    _header.version = 1;
+    _header.dim = dim;
+    _header.sizes[0] = sizeX;
+    _header.sizes[1] = sizeY;
+    _header.sizes[2] = sizeZ;
+    memcpy(&_header.timeStep, _data, sizeof(int));
+    memcpy(&_header.time, _data + sizeof(int), sizeof(FLOAT));
+
+    const int cellsX = sizeX + 3;
+    const int cellsY = sizeY + 3;
+    const int cellsZ = dim == 3 ? sizeZ + 3 : 1;
+    const int offsetZ = dim == 3 ? 2 : 0;
+    std::vector<char> & pressureBytes = addDecodedSection("pressure", CHECKPOINT_FLOAT, 1, cellsX, cellsY, cellsZ);
+    std::vector<char> & velocityBytes = addDecodedSection("velocity", CHECKPOINT_FLOAT, dim, cellsX, cellsY, cellsZ);
+    FLOAT * pressure = (FLOAT *) &pressureBytes[0];
+    FLOAT * velocity = (FLOAT *) &velocityBytes[0];
+
+    std::vector<FLOAT> cell(dim + 1);
+    const char * source = _data + headerBytes;
+    for (int i = 0; i < sizeX; i++) {
+        for (int j = 0; j < sizeY; j++) {
+            for (int k = 0; k < sizeZ; k++) {
+                memcpy(&cell[0], source, (dim + 1) * sizeof(FLOAT));
+                source += (dim + 1) * sizeof(FLOAT);
+                const size_t index = ((size_t) (k + offsetZ) * cellsY + (j + 2)) * cellsX + (i + 2);
+                pressure[index] = cell[0];
+                for (int d = 0; d < dim; d++) {
+                    velocity[dim * index + d] = cell[1 + d];
+                }
+            }
+        }
+    }
+}
+
+std::vector<char> & CheckpointReader::addDecodedSection ( const std::string & name, int type, int components,
+                                                          int sizeX, int sizeY, int sizeZ ) {
+    CheckpointSection section;
+    memset(&section, 0, sizeof(CheckpointSection));
+    strncpy(section.name, name.c_str(), sizeof(section.name) - 1);
+    section.type = type;
+    section.components = components;
+    section.sizes[0] = sizeX;
+    section.sizes[1] = sizeY;
+    section.sizes[2] = sizeZ;
+    section.offset = -1;    // not stored in the file
+    section.bytes = (long long) components * sizeX * sizeY * sizeZ *
+                    (type == CHECKPOINT_INT ? sizeof(int) : sizeof(FLOAT));
+    _sections.push_back(section);
+
+    std::vector<char> & values = _decoded[name];
+    values.assign(section.bytes, 0);
+    return values;
+}
+
+const CheckpointSection * CheckpointReader::findSection ( const std::string & name ) const {
+    for (unsigned int s = 0; s < _sections.size(); s++) {
+        if (strncmp(_sections[s].name, name.c_str(), sizeof(_sections[s].name)) == 0) {
+            return &_sections[s];
+        }
+    }
+    return NULL;
+}
+
+void CheckpointReader::readIndex ( const CheckpointSection & section,
+                                   std::vector<CheckpointBlock> & blocks ) const {
+    long long nBlocks = 0;
+    if (section.bytes < (long long) sizeof(long long)) {
+        handleError(1, "Corrupted offset index in the checkpoint file.");
+    }
+    memcpy(&nBlocks, _data + section.offset, sizeof(long long));
+    if (nBlocks <= 0 || nBlocks * (long long) sizeof(CheckpointBlock) > section.bytes) {
+        handleError(1, "Corrupted offset index in the checkpoint file.");
+    }
+    blocks.resize(nBlocks);
+    memcpy(&blocks[0], _data + section.offset + sizeof(long long), nBlocks * sizeof(CheckpointBlock));
+    for (unsigned int b = 0; b < blocks.size(); b++) {
+        if (blocks[b].offset < 0 || blocks[b].bytes < 0 ||
+            (size_t) (blocks[b].offset + blocks[b].bytes) > _size) {
+            handleError(1, "A compressed block exceeds the end of the checkpoint file.");
+        }
+    }
+}
+
+void CheckpointReader::decodeBlock ( const CheckpointBlock & block, size_t width, size_t count,
+                                     std::vector<char> & values ) const {
+    // a block of a rank without cells of the section holds no entries
+    values.resize(count * width);
+    if (values.empty()) {
+        return;
+    }
+    std::vector<char> shuffled(count * width);
+    if (!decompressLZ(_data + block.offset, block.bytes, &shuffled[0], shuffled.size())) {
+        handleError(1, "Cannot decompress the cell data of the checkpoint file.");
+    }
+    unshuffleBytes(&shuffled[0], &values[0], count, width);
+}
+
+void CheckpointReader::decodeSection ( const CheckpointSection & section, std::vector<char> & values ) {
+    const size_t width = section.type == CHECKPOINT_INT ? sizeof(int) : sizeof(FLOAT);
+    const size_t entryBytes = width * section.components;
+    const std::string name(section.name, strnlen(section.name, sizeof(section.name)));
+
+    std::vector<CheckpointBlock> blocks, keyframeBlocks;
+    readIndex(section, blocks);
+
+    if (_encoding == CHECKPOINT_DELTA) {
+        if (_keyframe == NULL) {
+            _keyframe = new CheckpointReader(getKeyframeFileName(_filename, _keyframeStep), _parameters);
+            if (_keyframe->getEncoding() != CHECKPOINT_KEYFRAME) {
+                handleError(1, "The keyframe of the delta checkpoint is not a keyframe.");
+            }
+        }
+        const CheckpointSection * keyframeSection = _keyframe->findSection(name);
+        if (keyframeSection == NULL) {
+            handleError(1, "A section of the delta checkpoint is missing in its keyframe.");
+        }
+        _keyframe->readIndex(*keyframeSection, keyframeBlocks);
+        if (keyframeBlocks.size() != blocks.size()) {
+            handleError(1, "The keyframe of the delta checkpoint was written with other blocks.");
+        }
+    }
+
+    values.assign((size_t) section.components * section.sizes[0] * section.sizes[1] * section.sizes[2] * width, 0);
+
+    std::vector<char> block, keyframe;
+    for (unsigned int b = 0; b < blocks.size(); b++) {
+        const int * first = blocks[b].first;
+        const int * length = blocks[b].length;
+        for (int d = 0; d < 3; d++) {
+            if (first[d] < 0 || length[d] < 0 || first[d] + length[d] > section.sizes[d]) {
+                handleError(1, "A compressed block exceeds its section of the checkpoint file.");
+            }
+        }
+
+        const size_t count = (size_t) section.components * length[0] * length[1] * length[2];
+        decodeBlock(blocks[b], width, count, block);
+
+        if (_encoding == CHECKPOINT_DELTA) {
+            for (int d = 0; d < 3; d++) {
+                if (keyframeBlocks[b].first[d] != first[d] || keyframeBlocks[b].length[d] != length[d]) {
+                    handleError(1, "The keyframe of the delta checkpoint was written with other blocks.");
+                }
+            }
+            _keyframe->decodeBlock(keyframeBlocks[b], width, count, keyframe);
+            for (size_t i = 0; i < block.size(); i++) {
+                block[i] ^= keyframe[i];
+            }
+        }
+
+        // Copy the rows of the block into the global array
+        const size_t rowBytes = length[0] * entryBytes;
+        for (int k = 0; k < length[2]; k++) {
+            for (int j = 0; j < length[1]; j++) {
+                const size_t source = ((size_t) k * length[1] + j) * length[0];
+                const size_t target = ((size_t) (first[2] + k) * section.sizes[1] + (first[1] + j))
+                                      * section.sizes[0] + first[0];
+                memcpy(&values[target * entryBytes], &block[source * entryBytes], rowBytes);
+            }
+        }
+    }
+}
+
+const char * CheckpointReader::getSectionData ( const CheckpointSection & section ) {
+    const std::string name(section.name, strnlen(section.name, sizeof(section.name)));
+    std::map<std::string, std::vector<char> >::iterator decoded = _decoded.find(name);
+    if (decoded != _decoded.end()) {
+        return &decoded->second[0];
+    }
+
+    // Records (sizes 1,1,1) are never compressed
+    const bool record = section.sizes[0] == 1 && section.sizes[1] == 1 && section.sizes[2] == 1;
+    const char * data = _data + section.offset;
+    if (_encoding == CHECKPOINT_RAW || record) {
+        // Raw sections are used in place, unless they are not aligned for their type
+        const size_t alignment = section.type == CHECKPOINT_INT ? sizeof(int) : sizeof(FLOAT);
+        if ((size_t) data % alignment == 0) {
+            return data;
+        }
+        std::vector<char> & values = _decoded[name];
+        values.assign(data, data + section.bytes);
+        return &values[0];
+    }
+
+    std::vector<char> & values = _decoded[name];
+    decodeSection(section, values);
+    return &values[0];
+}
+
+const FLOAT * CheckpointReader::getFloatSection ( const std::string & name ) {
+    const CheckpointSection * section = findSection(name);
+    if (section == NULL) {
+        return NULL;
+    }
+    if (section->type != CHECKPOINT_FLOAT) {
+        handleError(1, "The section of the checkpoint file does not contain floating point values.");
+    }
+    return (const FLOAT *) getSectionData(*section);
+}
+
+const int * CheckpointReader::getIntSection ( const std::string & name ) {
+    const CheckpointSection * section = findSection(name);
+    if (section == NULL) {
+        return NULL;
+    }
+    if (section->type != CHECKPOINT_INT) {
+        handleError(1, "The section of the checkpoint file does not contain integer values.");
+    }
+    return (const int *) getSectionData(*section);
+}
+
+void initGlobalMeshsize ( Parameters & parameters ) {
+    for (int d = 0; d < 3; d++) {
+        parameters.parallel.numProcessors[d] = 1;
+        parameters.parallel.indices[d] = 0;
+        parameters.parallel.firstCorner[d] = 0;
+    }
+    parameters.parallel.localSize[0] = parameters.geometry.sizeX;
+    parameters.parallel.localSize[1] = parameters.geometry.sizeY;
+    parameters.parallel.localSize[2] = parameters.geometry.dim == 3 ? parameters.geometry.sizeZ : 1;
+    MeshsizeFactory::getInstance().initMeshsize(parameters);
+}
+
+
+static void parseRange ( const char * argument, int & low, int & high ) {
+    if (sscanf(argument, "%d:%d", &low, &high) != 2) {
+        if (sscanf(argument, "%d", &low) != 1) {
+            handleError(1, "Invalid cell range, expected lo:hi or a single index");
+        }
+        high = low;
+    }
+}
+
+static void getInnerSizes ( const Parameters & parameters, int sizes[3] ) {
+    sizes[0] = parameters.geometry.sizeX;
+    sizes[1] = parameters.geometry.sizeY;
+    sizes[2] = parameters.geometry.dim == 3 ? parameters.geometry.sizeZ : 1;
+}
+
+void CheckpointSelection::selectAll ( const Parameters & parameters ) {
+    int sizes[3];
+    getInnerSizes(parameters, sizes);
+    for (int d = 0; d < 3; d++) {
+        low[d] = 0;
+        high[d] = sizes[d] - 1;
+    }
+    fields.clear();
+}
+
+bool CheckpointSelection::parseOption ( int argc, char * argv[], int & arg ) {
+    const std::string option(argv[arg]);
+    if (option == "-fields" && arg + 1 < argc) {
+        std::istringstream list(argv[++arg]);
+        std::string field;
+        while (std::getline(list, field, ',')) {
+            fields.push_back(field);
+        }
+        return true;
+    }
+    if ((option == "-x" || option == "-y" || option == "-z") && arg + 1 < argc) {
+        const int d = option[1] - 'x';
+        parseRange(argv[++arg], low[d], high[d]);
+        return true;
+    }
+    return false;
+}
+
+void CheckpointSelection::checkRegion ( const Parameters & parameters ) const {
+    int sizes[3];
+    getInnerSizes(parameters, sizes);
+    for (int d = 0; d < 3; d++) {
+        if (low[d] < 0 || high[d] >= sizes[d] || low[d] > high[d]) {
+            handleError(1, "The cell range exceeds the domain");
+        }
+    }
+}
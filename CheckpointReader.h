@@ -0,0 +1,131 @@
+#ifndef _CHECKPOINT_READER_H_
+#define _CHECKPOINT_READER_H_
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "CheckpointFormat.h"
+#include <string>
+#include <vector>
+#include <map>
+
+/** Read-only access to a checkpoint file for the post-processing tools.
+ *
+ * The file is mapped into memory, so that the sections of raw files are used in place without
+ * copying them. Compressed sections are decoded on first access into the global array of the
+ * section, the keyframe of a delta is opened on demand. Files in the original format are converted
+ * to pressure and velocity sections with the layout of the versioned format, so the tools only
+ * deal with global arrays including the ghost layers (x fastest, components interleaved).
+ *
+ * Does not use MPI, so several files can be read concurrently by independent processes.
+ */
+class CheckpointReader {
+
+    private:
+
+        const Parameters & _parameters;
+        std::string _filename;
+
+        int _fd;                //! Descriptor of the mapped file
+        const char * _data;     //! Mapping of the whole file
+        size_t _size;           //! Length of the file in bytes
+
+        bool _legacy;           //! Whether the file has the original format
+        CheckpointHeader _header;
+        std::vector<CheckpointSection> _sections;
+
+        int _encoding;          //! CheckpointEncoding of the field sections
+        int _keyframeStep;      //! Time step of the keyframe of a delta
+
+        CheckpointReader * _keyframe;   //! Opened when the first delta section is decoded
+
+        std::map<std::string, std::vector<char> > _decoded;  //! Sections that are not used in place
+
+        /** Reads the header and the section table, returns false for the original format */
+        bool readTable ();
+
+        /** Converts a file of the original format into pressure and velocity sections */
+        void readLegacy ();
+
+        /** Adds a section, whose values are stored in _decoded */
+        std::vector<char> & addDecodedSection ( const std::string & name, int type, int components,
+                                                int sizeX, int sizeY, int sizeZ );
+
+        /** Reads the offset index of a compressed section */
+        void readIndex ( const CheckpointSection & section, std::vector<CheckpointBlock> & blocks ) const;
+
+        /** Decompresses a block of count values of the given width in bytes */
+        void decodeBlock ( const CheckpointBlock & block, size_t width, size_t count,
+                           std::vector<char> & values ) const;
+
+        /** Decodes a compressed section into its global array */
+        void decodeSection ( const CheckpointSection & section, std::vector<char> & values );
+
+        /** Returns the data of a section, decoding or aligning it if necessary */
+        const char * getSectionData ( const CheckpointSection & section );
+
+    public:
+
+        /** Constructor. Maps the file and reads its section table
+         *
+         * @param filename Path of the checkpoint file
+         * @param parameters Parameters of the problem. The geometry has to match the one of the
+         *                   file, and is used to interpret files of the original format
+         */
+        CheckpointReader ( const std::string & filename, const Parameters & parameters );
+
+        ~CheckpointReader ();
+
+        /** Whether the file has the original format (pressure and velocity only) */
+        bool isLegacy () const { return _legacy; }
+
+        const std::string & getFileName () const { return _filename; }
+        int getVersion () const { return _header.version; }
+        int getTimeStep () const { return _header.timeStep; }
+        FLOAT getTime () const { return _header.time; }
+        int getEncoding () const { return _encoding; }
+
+        /** Size of the file in bytes */
+        size_t getFileSize () const { return _size; }
+
+        const std::vector<CheckpointSection> & getSections () const { return _sections; }
+
+        /** Returns the section with the given name, or NULL if the file does not contain it */
+        const CheckpointSection * findSection ( const std::string & name ) const;
+
+        /** Returns the global array of a FLOAT section, or NULL if the file does not contain it.
+         *  The array is valid as long as the reader exists.
+         */
+        const FLOAT * getFloatSection ( const std::string & name );
+
+        /** Returns the global array of an integer section, or NULL if the file does not contain it */
+        const int * getIntSection ( const std::string & name );
+};
+
+/** Sets up the parallel parameters and the meshsize of a single subdomain covering the whole
+ *  domain, so that the meshsize can be evaluated at the indices of the global arrays of the
+ *  checkpoints. Used by the post-processing tools instead of PetscParallelConfiguration.
+ */
+void initGlobalMeshsize ( Parameters & parameters );
+
+/** Sections and region of inner cells selected on the command line of the post-processing tools
+ *  with -fields a,b,... and -x lo:hi, -y lo:hi, -z lo:hi (inclusive, starting at 0, a single index
+ *  selecting a slice of one cell)
+ */
+struct CheckpointSelection {
+    std::vector<std::string> fields;
+    int low[3];         //! First inner cell of the region per dimension
+    int high[3];        //! Last inner cell of the region per dimension
+
+    /** Selects all inner cells of the domain and no sections */
+    void selectAll ( const Parameters & parameters );
+
+    /** Takes the option argv[arg] if it is one of the selection, together with its value
+     * @return Whether the option was taken, arg then pointing to its value
+     */
+    bool parseOption ( int argc, char * argv[], int & arg );
+
+    /** Stops with an error if the region exceeds the domain */
+    void checkRegion ( const Parameters & parameters ) const;
+};
+
+#endif
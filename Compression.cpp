@@ -0,0 +1,164 @@
+#include "Compression.h"
+#include <cstring>
+
+// Parameters of the LZ scheme. A sequence consists of a token (number of literals in the high
+// nibble, match length minus MIN_MATCH in the low nibble), the extension bytes of the literal
+// length, the literals, a 16 bit offset and the extension bytes of the match length. Lengths of
+// 15 or more are continued in bytes of 255 plus a remainder. The last sequence has no match.
+const int HASH_BITS = 14;
+const size_t MIN_MATCH = 4;
+const size_t MAX_OFFSET = 65535;
+
+
+void shuffleBytes(const char * input, char * output, size_t count, size_t width){
+    for (size_t i = 0; i < count; i++){
+        for (size_t b = 0; b < width; b++){
+            output[b*count + i] = input[i*width + b];
+        }
+    }
+}
+
+
+void unshuffleBytes(const char * input, char * output, size_t count, size_t width){
+    for (size_t i = 0; i < count; i++){
+        for (size_t b = 0; b < width; b++){
+            output[i*width + b] = input[b*count + i];
+        }
+    }
+}
+
+
+static unsigned int read32(const char * position){
+    unsigned int value;
+    memcpy(&value, position, sizeof(value));
+    return value;
+}
+
+
+static void writeLength(std::vector<char> & output, size_t length){
+    while (length >= 255){
+        output.push_back((char) 255);
+        length -= 255;
+    }
+    output.push_back((char) length);
+}
+
+
+static void writeSequence(std::vector<char> & output, const char * literals, size_t nLiterals,
+                          size_t offset, size_t matchLength){
+    const size_t matchCode = matchLength >= MIN_MATCH ? matchLength - MIN_MATCH : 0;
+    unsigned char token = (nLiterals < 15 ? nLiterals : 15) << 4;
+    token |= (matchCode < 15 ? matchCode : 15);
+    output.push_back((char) token);
+
+    if (nLiterals >= 15){
+        writeLength(output, nLiterals - 15);
+    }
+    output.insert(output.end(), literals, literals + nLiterals);
+
+    if (matchLength >= MIN_MATCH){
+        output.push_back((char) (offset & 0xff));
+        output.push_back((char) (offset >> 8));
+        if (matchCode >= 15){
+            writeLength(output, matchCode - 15);
+        }
+    }
+}
+
+
+void compressLZ(const char * input, size_t size, std::vector<char> & output){
+    output.clear();
+    output.reserve(size / 2 + 16);
+
+    // Last position at which each hashed 4-byte sequence was found
+    std::vector<long> table(1 << HASH_BITS, -1);
+
+    size_t anchor = 0;
+    size_t position = 0;
+
+    while (position + MIN_MATCH <= size){
+        const unsigned int sequence = read32(input + position);
+        const unsigned int hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+        const long candidate = table[hash];
+        table[hash] = position;
+
+        if (candidate >= 0 && position - candidate <= MAX_OFFSET &&
+            read32(input + candidate) == sequence){
+            // Extend the match as far as possible. It may overlap the current position, which
+            // encodes runs of equal bytes
+            size_t length = MIN_MATCH;
+            while (position + length < size && input[candidate + length] == input[position + length]){
+                length++;
+            }
+            writeSequence(output, input + anchor, position - anchor, position - candidate, length);
+            position += length;
+            anchor = position;
+        } else {
+            position++;
+        }
+    }
+
+    // Remaining literals
+    writeSequence(output, input + anchor, size - anchor, 0, 0);
+}
+
+
+static bool readLength(const unsigned char * & in, const unsigned char * end, size_t & length){
+    unsigned char byte;
+    do {
+        if (in >= end){
+            return false;
+        }
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+
+bool decompressLZ(const char * input, size_t size, char * output, size_t outputSize){
+    const unsigned char * in = (const unsigned char *) input;
+    const unsigned char * end = in + size;
+    size_t out = 0;
+
+    while (in < end){
+        const unsigned char token = *in++;
+
+        size_t nLiterals = token >> 4;
+        if (nLiterals == 15 && !readLength(in, end, nLiterals)){
+            return false;
+        }
+        if (nLiterals > (size_t) (end - in) || out + nLiterals > outputSize){
+            return false;
+        }
+        memcpy(output + out, in, nLiterals);
+        in += nLiterals;
+        out += nLiterals;
+
+        // The last sequence ends after the literals
+        if (in == end){
+            break;
+        }
+
+        if (end - in < 2){
+            return false;
+        }
+        const size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        size_t length = token & 15;
+        if (length == 15 && !readLength(in, end, length)){
+            return false;
+        }
+        length += MIN_MATCH;
+
+        if (offset == 0 || offset > out || out + length > outputSize){
+            return false;
+        }
+        // Byte by byte, since the source may overlap the destination
+        for (size_t i = 0; i < length; i++, out++){
+            output[out] = output[out - offset];
+        }
+    }
+
+    return out == outputSize;
+}
@@ -0,0 +1,37 @@
+#ifndef _COMPRESSION_H_
+#define _COMPRESSION_H_
+
+#include <vector>
+#include <cstddef>
+
+/** Lossless compression of floating point data for the checkpoints.
+ *
+ * The data is first byte-shuffled: the i-th bytes of all the values are stored together, so that
+ * the sign and exponent bytes, which hardly change between neighbouring cells, form long runs.
+ * The result is compressed with a byte oriented LZ77 scheme in the style of LZ4. Deltas of two
+ * similar fields (XOR of their bit patterns) are mostly zero and compress particularly well.
+ */
+
+/** Byte shuffle
+ * @param input Array of count values of width bytes each
+ * @param output Array of the same size. Receives byte 0 of all values, then byte 1, ...
+ */
+void shuffleBytes(const char * input, char * output, size_t count, size_t width);
+
+/** Inverse of shuffleBytes */
+void unshuffleBytes(const char * input, char * output, size_t count, size_t width);
+
+/** Compresses a byte array
+ * @param input Data to compress
+ * @param size Length of the data in bytes
+ * @param output Compressed data. Overwritten
+ */
+void compressLZ(const char * input, size_t size, std::vector<char> & output);
+
+/** Decompresses data written by compressLZ
+ * @param output Array of outputSize bytes, the size of the original data
+ * @return false if the input is corrupted or does not match the output size
+ */
+bool decompressLZ(const char * input, size_t size, char * output, size_t outputSize);
+
+#endif
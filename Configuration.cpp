@@ -114,6 +114,24 @@ void broadcastString (std::string & target, const MPI_Comm & communicator, int r
     delete [] name; name = NULL;
 }
 
+void broadcastFloats (std::vector<FLOAT> & target, const MPI_Comm & communicator, int root = 0){
+    int size = target.size();
+    MPI_Bcast(&size, 1, MPI_INT, root, communicator);
+    target.resize(size);
+    if (size > 0){
+        MPI_Bcast(&target[0], size, MY_MPI_FLOAT, root, communicator);
+    }
+}
+
+void broadcastInts (std::vector<int> & target, const MPI_Comm & communicator, int root = 0){
+    int size = target.size();
+    MPI_Bcast(&size, 1, MPI_INT, root, communicator);
+    target.resize(size);
+    if (size > 0){
+        MPI_Bcast(&target[0], size, MPI_INT, root, communicator);
+    }
+}
+
 Configuration::Configuration(){
     _filename = "";
 }
@@ -213,10 +231,30 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
           readFloatOptional(parameters.geometry.deltaSX,subNode,"deltaSX",parameters.geometry.deltaSX);
           readFloatOptional(parameters.geometry.deltaSY,subNode,"deltaSY",parameters.geometry.deltaSY);
           readFloatOptional(parameters.geometry.deltaSZ,subNode,"deltaSZ",parameters.geometry.deltaSZ);
+        } else if (meshsizeType == "blocks"){
+          parameters.geometry.meshsizeType = BlockRefinement;
+          readIntOptional(parameters.geometry.blockSize,subNode,"blockSize",parameters.geometry.blockSize);
+          readIntOptional(parameters.geometry.refinementLevels,subNode,"levels",parameters.geometry.refinementLevels);
+          if (parameters.geometry.blockSize < 1){
+            handleError(1, "The blocks of the mesh need at least one cell");
+          }
+          if (parameters.geometry.refinementLevels < 0 || parameters.geometry.refinementLevels > 10){
+            handleError(1, "The mesh takes between 0 and 10 levels of refinement");
+          }
         } else {
           handleError(1, "Unknown 'mesh'!");
         }
 
+        // the interior of obstacles is detected after the initialisation and skipped by the sweeps
+        bool trimSolid = false;
+        readBoolOptional(trimSolid, node, "trimSolid", false);
+        parameters.geometry.trimSolid = (int) trimSolid;
+
+        // so are the runs of fluid cells away from obstacles, which take branch-free kernels
+        bool fluidRuns = false;
+        readBoolOptional(fluidRuns, node, "fluidRuns", false);
+        parameters.geometry.fluidRuns = (int) fluidRuns;
+
         // Now, the size of the elements should be set
 
         _dim = parameters.geometry.dim;
@@ -232,7 +270,34 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
         }
 
         readFloatOptional(parameters.timestep.dt, node, "dt", 1);
+        parameters.timestep.maxDt = parameters.timestep.dt;
         readFloatOptional(parameters.timestep.tau, node, "tau", 0.5);
+        bool adaptive = true;
+        readBoolOptional(adaptive, node, "adaptive", true);
+        parameters.timestep.fixedDt = (int) !adaptive;
+
+        // treatment of the viscous terms: viscous="explicit|implicit"
+        parameters.timestep.implicitViscosity = (int) false;
+        if (node->Attribute("viscous") != NULL) {
+            const std::string viscous(node->Attribute("viscous"));
+            if (viscous != "explicit" && viscous != "implicit") {
+                handleError(1, "Unknown treatment of the viscous terms, expected explicit or implicit");
+            }
+            parameters.timestep.implicitViscosity = (int) (viscous == "implicit");
+        }
+
+        // time integration: scheme="euler|rk3"
+        parameters.timestep.rungeKutta = (int) false;
+        if (node->Attribute("scheme") != NULL) {
+            const std::string scheme(node->Attribute("scheme"));
+            if (scheme != "euler" && scheme != "rk3") {
+                handleError(1, "Unknown time integration scheme, expected euler or rk3");
+            }
+            parameters.timestep.rungeKutta = (int) (scheme == "rk3");
+        }
+        if (parameters.timestep.rungeKutta && parameters.timestep.implicitViscosity) {
+            handleError(1, "The Runge-Kutta scheme requires explicit viscous terms");
+        }
 
         //--------------------------------------------------
         // Flow parameters
@@ -259,6 +324,35 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
         readFloatMandatory(parameters.solver.gamma, node, "gamma");
         readIntOptional (parameters.solver.maxIterations, node, "maxIterations");
 
+        // statistics of each solve; the summary is printed by default, the records are only
+        // written on request: <telemetry interval="100" capacity="1000" format="csv|bin">file</telemetry>
+        parameters.solver.telemetry = (int) true;
+        parameters.solver.telemetryFile = "";
+        parameters.solver.telemetryInterval = 100;
+        parameters.solver.telemetryCapacity = 1000;
+        parameters.solver.telemetryBinary = (int) false;
+        subNode = node->FirstChildElement("telemetry");
+        if (subNode != NULL) {
+            bool active;
+            readBoolOptional(active, subNode, "active", true);
+            parameters.solver.telemetry = (int) active;
+            readIntOptional(parameters.solver.telemetryInterval, subNode, "interval", 100);
+            readIntOptional(parameters.solver.telemetryCapacity, subNode, "capacity", 1000);
+            if (parameters.solver.telemetryInterval < 1 || parameters.solver.telemetryCapacity < 1) {
+                handleError(1, "The interval and the capacity of the solver telemetry have to be positive");
+            }
+            if (subNode->Attribute("format") != NULL) {
+                const std::string format(subNode->Attribute("format"));
+                if (format != "csv" && format != "bin") {
+                    handleError(1, "Unknown format of the solver telemetry, expected csv or bin");
+                }
+                parameters.solver.telemetryBinary = (int) (format == "bin");
+            }
+            if (subNode->GetText() != NULL) {
+                readStringMandatory(parameters.solver.telemetryFile, subNode);
+            }
+        }
+
         //--------------------------------------------------
         // Environmental parameters
         //--------------------------------------------------
@@ -299,6 +393,37 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
             handleError (1, "Missing scenario in simulation parameters");
         }
 
+        //--------------------------------------------------
+        // Steady-state parameters
+        //--------------------------------------------------
+
+        // pseudo-time stepping with local steps until the residuals are below the tolerances:
+        // <steady tolerance="1e-6" divergenceTolerance="1e-6" interval="10" />, finalTime bounds
+        // the pseudo-time. The divergence is only bounded on request: on stretched meshes, the
+        // Laplacian of the pressure solver differs from the divergence of the pressure gradient,
+        // so that it does not vanish at the steady state
+        node = confFile.FirstChildElement()->FirstChildElement("steady");
+
+        if (node == NULL) {
+            parameters.steady.active = (int) false;
+        } else {
+            bool active;
+            readBoolOptional(active, node, "active", true);
+            parameters.steady.active = (int) active;
+            readFloatOptional(parameters.steady.tolerance, node, "tolerance", 1e-6);
+            readFloatOptional(parameters.steady.divergenceTolerance, node, "divergenceTolerance", MY_FLOAT_MAX);
+            readIntOptional(parameters.steady.interval, node, "interval", 1);
+            if (parameters.steady.interval < 1) {
+                handleError(1, "The interval of the steady-state checks must be positive");
+            }
+        }
+        if (parameters.steady.active) {
+            if (parameters.timestep.rungeKutta || parameters.timestep.implicitViscosity ||
+                parameters.timestep.fixedDt) {
+                handleError(1, "The steady-state mode requires explicit Euler with adaptive steps");
+            }
+        }
+
         //--------------------------------------------------
         // VTK parameters
         //--------------------------------------------------
@@ -315,6 +440,158 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
             readStringMandatory(parameters.vtk.prefix, node);
         }
 
+        //--------------------------------------------------
+        // Slice and downsampled VTK output
+        //--------------------------------------------------
+
+        for (node = confFile.FirstChildElement()->FirstChildElement("slice"); node != NULL;
+             node = node->NextSiblingElement("slice")) {
+            VtkStreamParameters stream;
+            stream.type = VtkSlice;
+            readFloatMandatory(stream.interval, node, "interval");
+            readFloatMandatory(stream.position, node, "position");
+            const char * axis = node->Attribute("axis");
+            if (axis == NULL || std::string(axis).size() != 1 || axis[0] < 'x' || axis[0] > 'z') {
+                handleError(1, "The axis of a slice has to be x, y or z");
+            }
+            stream.axis = axis[0] - 'x';
+            if (parameters.geometry.dim != 3) {
+                handleError(1, "Slices are only available in 3D");
+            }
+            stream.factor = 1;
+            stream.average = (int) false;
+            readStringMandatory(stream.prefix, node);
+            parameters.vtkStreams.push_back(stream);
+        }
+
+        for (node = confFile.FirstChildElement()->FirstChildElement("downsample"); node != NULL;
+             node = node->NextSiblingElement("downsample")) {
+            VtkStreamParameters stream;
+            stream.type = VtkDownsampled;
+            readFloatMandatory(stream.interval, node, "interval");
+            readIntMandatory(stream.factor, node, "factor");
+            if (stream.factor < 1) {
+                handleError(1, "The downsampling factor has to be at least 1");
+            }
+            const char * mode = node->Attribute("mode");
+            if (mode == NULL || std::string(mode) == "stride") {
+                stream.average = (int) false;
+            } else if (std::string(mode) == "average") {
+                stream.average = (int) true;
+            } else {
+                handleError(1, "Unknown downsampling mode! Currently supported: stride, average");
+            }
+            stream.axis = 0;
+            stream.position = 0.0;
+            readStringMandatory(stream.prefix, node);
+            parameters.vtkStreams.push_back(stream);
+        }
+
+        //--------------------------------------------------
+        // Statistics parameters
+        //--------------------------------------------------
+
+        node = confFile.FirstChildElement()->FirstChildElement("statistics");
+
+        if (node == NULL) {
+            parameters.statistics.active = (int) false;
+        } else {
+            readBoolOptional(buffer, node, "active", true);
+            parameters.statistics.active = (int) buffer;
+            readFloatOptional(parameters.statistics.startTime, node, "startTime", 0);
+            readFloatOptional(parameters.statistics.endTime, node, "endTime", parameters.simulation.finalTime);
+            readBoolOptional(buffer, node, "averageX", false);
+            parameters.statistics.average[0] = (int) buffer;
+            readBoolOptional(buffer, node, "averageY", false);
+            parameters.statistics.average[1] = (int) buffer;
+            readBoolOptional(buffer, node, "averageZ", false);
+            parameters.statistics.average[2] = (int) buffer;
+            readStringMandatory(parameters.statistics.prefix, node);
+            if (parameters.statistics.endTime <= parameters.statistics.startTime) {
+                handleError(1, "The averaging window of the statistics is empty");
+            }
+        }
+
+        //--------------------------------------------------
+        // Probe parameters
+        //--------------------------------------------------
+
+        node = confFile.FirstChildElement()->FirstChildElement("probes");
+
+        if (node == NULL) {
+            parameters.probes.active = (int) false;
+        } else {
+            readBoolOptional(buffer, node, "active", true);
+            parameters.probes.active = (int) buffer;
+            readFloatOptional(parameters.probes.interval, node, "interval");
+
+            subNode = node->FirstChildElement("prefix");
+            if (subNode != NULL) {
+                readStringMandatory(parameters.probes.prefix, subNode);
+            } else {
+                handleError (1, "Missing prefix in probe parameters");
+            }
+
+            for (subNode = node->FirstChildElement("point"); subNode != NULL;
+                 subNode = subNode->NextSiblingElement("point")) {
+                FLOAT coordinate;
+                readFloatMandatory(coordinate, subNode, "x");
+                parameters.probes.points.push_back(coordinate);
+                readFloatMandatory(coordinate, subNode, "y");
+                parameters.probes.points.push_back(coordinate);
+                readFloatOptional(coordinate, subNode, "z");
+                parameters.probes.points.push_back(coordinate);
+            }
+
+            for (subNode = node->FirstChildElement("line"); subNode != NULL;
+                 subNode = subNode->NextSiblingElement("line")) {
+                const char * tags[6] = {"x0", "y0", "z0", "x1", "y1", "z1"};
+                for (int t = 0; t < 6; t++) {
+                    FLOAT coordinate;
+                    if (t % 3 == 2) {
+                        readFloatOptional(coordinate, subNode, tags[t]);
+                    } else {
+                        readFloatMandatory(coordinate, subNode, tags[t]);
+                    }
+                    parameters.probes.lines.push_back(coordinate);
+                }
+                int samples;
+                readIntMandatory(samples, subNode, "n");
+                if (samples < 1) {
+                    handleError(1, "A line rake needs at least one sample");
+                }
+                parameters.probes.lineSamples.push_back(samples);
+
+                std::stringstream name;
+                if (subNode->Attribute("name") != NULL) {
+                    name << subNode->Attribute("name");
+                } else {
+                    name << "line" << parameters.probes.lineNames.size();
+                }
+                parameters.probes.lineNames.push_back(name.str());
+            }
+        }
+
+        //--------------------------------------------------
+        // Timer parameters
+        //--------------------------------------------------
+
+        node = confFile.FirstChildElement()->FirstChildElement("timers");
+
+        // the stages are timed by default, the JSON report is only written on request
+        parameters.timers.active = (int) true;
+        parameters.timers.filename = "";
+        parameters.timers.counters = (int) false;
+        if (node != NULL) {
+            readBoolOptional(buffer, node, "active", true);
+            parameters.timers.active = (int) buffer;
+            readBoolOptional(buffer, node, "counters", false);
+            parameters.timers.counters = (int) buffer;
+            if (node->GetText() != NULL) {
+                readStringMandatory(parameters.timers.filename, node);
+            }
+        }
+
         //--------------------------------------------------
         // StdOut parameters
         //--------------------------------------------------
@@ -344,6 +621,12 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
         readFloatOptional(parameters.checkpoint.incrFactor, node, "incrFactor", 1.1);
         readBoolOptional(buffer, node, "cleanDirectory", false);
         parameters.checkpoint.cleanDirectory = (int) buffer;
+        readBoolOptional(buffer, node, "compress", false);
+        parameters.checkpoint.compress = (int) buffer;
+        readIntOptional(parameters.checkpoint.keyframeInterval, node, "keyframeInterval", 10);
+        if (parameters.checkpoint.keyframeInterval < 1) {
+            handleError(1, "The keyframe interval of the checkpoints must be at least 1");
+        }
 
         subNode = node->FirstChildElement("directory");
         if (subNode != NULL) {
@@ -516,10 +799,65 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
         //------------------------------------------------------
         // WS2: Turbulence model
         //------------------------------------------------------
+        // the turbulent viscosity is updated every step unless <update interval="10" /> keeps it
+        // over 10 steps; <update threshold="0.01" interval="5" /> checks every 5 steps whether the
+        // strain rate norm of a cell has changed by 1% of its maximum since the last update
+        parameters.turbulenceModel.updateInterval = 1;
+        parameters.turbulenceModel.updateThreshold = 0.0;
+        // the normal distance of the channel by default there, the eikonal equation on the flags
+        // elsewhere or on request: <wallDistance>channel|eikonal</wallDistance>
+        parameters.turbulenceModel.wallDistance =
+            parameters.simulation.scenario == "channel" ? ChannelWallDistance : EikonalWallDistance;
+        // the no-slip walls resolve the viscous sublayer unless <wallFunctions intercept="5.2" />
+        // applies the log law u+ = ln(y+)/kappa + intercept to the cells next to them
+        parameters.turbulenceModel.wallFunctions = 0;
+        parameters.turbulenceModel.logLawIntercept = 5.2;
+        // <type>spalartAllmaras</type> transports nu~ instead, with nu~ = 3/Re at the inflow unless
+        // <spalartAllmaras inflowRatio="5" /> sets it to 5/Re
+        parameters.turbulenceModel.spalartAllmaras.inflowRatio = 3.0;
         node = confFile.FirstChildElement()->FirstChildElement("turbulenceModel");
         if (node != NULL) {
             subNode = node->FirstChildElement("type");
             readStringMandatory(parameters.turbulenceModel.type, subNode);
+            if (parameters.turbulenceModel.type != "mixingLength" && parameters.turbulenceModel.type != "spalartAllmaras") {
+                handleError(1, "Unknown turbulence model");
+            }
+            subNode = node->FirstChildElement("wallDistance");
+            if (subNode != NULL) {
+                std::string wallDistance;
+                readStringMandatory(wallDistance, subNode);
+                if (wallDistance == "channel" && parameters.simulation.scenario == "channel") {
+                    parameters.turbulenceModel.wallDistance = ChannelWallDistance;
+                } else if (wallDistance == "eikonal") {
+                    parameters.turbulenceModel.wallDistance = EikonalWallDistance;
+                } else {
+                    handleError(1, "Unknown wall distance, or the channel distance outside the channel");
+                }
+            }
+            subNode = node->FirstChildElement("update");
+            if (subNode != NULL) {
+                readFloatOptional(parameters.turbulenceModel.updateThreshold, subNode, "threshold", 0.0);
+                readIntOptional(parameters.turbulenceModel.updateInterval, subNode, "interval", 1);
+                if (parameters.turbulenceModel.updateInterval < 1 || parameters.turbulenceModel.updateThreshold < 0.0) {
+                    handleError(1, "The update of the turbulent viscosity needs a positive interval and threshold");
+                }
+                if (parameters.turbulenceModel.type == "spalartAllmaras" &&
+                    (parameters.turbulenceModel.updateInterval > 1 || parameters.turbulenceModel.updateThreshold > 0.0)) {
+                    handleError(1, "The Spalart-Allmaras model advances its transport equation in every step");
+                }
+            }
+            subNode = node->FirstChildElement("spalartAllmaras");
+            if (subNode != NULL) {
+                readFloatOptional(parameters.turbulenceModel.spalartAllmaras.inflowRatio, subNode, "inflowRatio", 3.0);
+                if (parameters.turbulenceModel.spalartAllmaras.inflowRatio < 0.0) {
+                    handleError(1, "The inflow of the Spalart-Allmaras model needs a positive ratio");
+                }
+            }
+            subNode = node->FirstChildElement("wallFunctions");
+            if (subNode != NULL) {
+                parameters.turbulenceModel.wallFunctions = 1;
+                readFloatOptional(parameters.turbulenceModel.logLawIntercept, subNode, "intercept", 5.2);
+            }
             subNode = node->FirstChildElement("mixingLengthModel");
             if (subNode != NULL) {
                 readFloatOptional(parameters.turbulenceModel.mixingLengthModel.kappa,
@@ -561,17 +899,30 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
     MPI_Bcast(&(parameters.geometry.stretchX),1,MPI_INT,0,communicator);
     MPI_Bcast(&(parameters.geometry.stretchY),1,MPI_INT,0,communicator);
     MPI_Bcast(&(parameters.geometry.stretchZ),1,MPI_INT,0,communicator);
+    MPI_Bcast(&(parameters.geometry.blockSize),1,MPI_INT,0,communicator);
+    MPI_Bcast(&(parameters.geometry.refinementLevels),1,MPI_INT,0,communicator);
+    MPI_Bcast(&(parameters.geometry.trimSolid),1,MPI_INT,0,communicator);
+    MPI_Bcast(&(parameters.geometry.fluidRuns),1,MPI_INT,0,communicator);
     MPI_Bcast(&(parameters.geometry.lengthX),  1, MY_MPI_FLOAT, 0, communicator);
     MPI_Bcast(&(parameters.geometry.lengthY),  1, MY_MPI_FLOAT, 0, communicator);
     MPI_Bcast(&(parameters.geometry.lengthZ),  1, MY_MPI_FLOAT, 0, communicator);
 
     MPI_Bcast(&(parameters.timestep.dt),  1, MY_MPI_FLOAT, 0, communicator);
     MPI_Bcast(&(parameters.timestep.tau), 1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.timestep.implicitViscosity), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.timestep.maxDt), 1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.timestep.rungeKutta), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.timestep.fixedDt), 1, MPI_INT, 0, communicator);
+
+    MPI_Bcast(&(parameters.steady.active), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.steady.tolerance), 1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.steady.divergenceTolerance), 1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.steady.interval), 1, MPI_INT, 0, communicator);
 
     MPI_Bcast(&(parameters.flow.Re), 1, MY_MPI_FLOAT, 0, communicator);
 
     MPI_Bcast(&(parameters.solver.gamma),         1, MY_MPI_FLOAT, 0, communicator);
-    MPI_Bcast(&(parameters.solver.maxIterations), 1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.solver.maxIterations), 1, MPI_INT, 0, communicator);
 
     MPI_Bcast(&(parameters.environment.gx), 1, MY_MPI_FLOAT, 0, communicator);
     MPI_Bcast(&(parameters.environment.gy), 1, MY_MPI_FLOAT, 0, communicator);
@@ -581,12 +932,48 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
 
     MPI_Bcast(&(parameters.vtk.active), 1, MPI_INT, 0, communicator);
     MPI_Bcast(&(parameters.vtk.interval), 1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.statistics.active), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.statistics.startTime), 1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.statistics.endTime), 1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(parameters.statistics.average, 3, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.probes.active), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.probes.interval), 1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.timers.active), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.timers.counters), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.solver.telemetry), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.solver.telemetryInterval), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.solver.telemetryCapacity), 1, MPI_INT, 0, communicator);
+    MPI_Bcast(&(parameters.solver.telemetryBinary), 1, MPI_INT, 0, communicator);
     MPI_Bcast(&(parameters.stdOut.interval), 1, MY_MPI_FLOAT, 0, communicator);
     MPI_Bcast(&(parameters.checkpoint.iterations), 1, MPI_INT, 0, communicator);
     MPI_Bcast(&(parameters.checkpoint.maxIter), 1, MPI_INT, 0, communicator);
     MPI_Bcast(&(parameters.checkpoint.incrFactor), 1, MY_MPI_FLOAT, 0, communicator);
 
     broadcastString (parameters.vtk.prefix, communicator);
+    int nStreams = parameters.vtkStreams.size();
+    MPI_Bcast(&nStreams, 1, MPI_INT, 0, communicator);
+    parameters.vtkStreams.resize(nStreams);
+    for (int s = 0; s < nStreams; s++) {
+        VtkStreamParameters & stream = parameters.vtkStreams[s];
+        MPI_Bcast(&(stream.type),     1, MPI_INT,      0, communicator);
+        MPI_Bcast(&(stream.interval), 1, MY_MPI_FLOAT, 0, communicator);
+        MPI_Bcast(&(stream.axis),     1, MPI_INT,      0, communicator);
+        MPI_Bcast(&(stream.position), 1, MY_MPI_FLOAT, 0, communicator);
+        MPI_Bcast(&(stream.factor),   1, MPI_INT,      0, communicator);
+        MPI_Bcast(&(stream.average),  1, MPI_INT,      0, communicator);
+        broadcastString (stream.prefix, communicator);
+    }
+    broadcastString (parameters.statistics.prefix, communicator);
+    broadcastString (parameters.probes.prefix, communicator);
+    broadcastFloats (parameters.probes.points, communicator);
+    broadcastFloats (parameters.probes.lines, communicator);
+    broadcastInts (parameters.probes.lineSamples, communicator);
+    parameters.probes.lineNames.resize(parameters.probes.lineSamples.size());
+    for (unsigned int line = 0; line < parameters.probes.lineNames.size(); line++) {
+        broadcastString (parameters.probes.lineNames[line], communicator);
+    }
+    broadcastString (parameters.timers.filename, communicator);
+    broadcastString (parameters.solver.telemetryFile, communicator);
     broadcastString (parameters.checkpoint.directory, communicator);
     broadcastString (parameters.checkpoint.prefix, communicator);
     broadcastString (parameters.restart.filename, communicator);
@@ -595,6 +982,8 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
 
     MPI_Bcast(&(parameters.checkpoint.increaseIter),1,MPI_INT,0,communicator);
     MPI_Bcast(&(parameters.checkpoint.cleanDirectory),1,MPI_INT,0,communicator);
+    MPI_Bcast(&(parameters.checkpoint.compress),1,MPI_INT,0,communicator);
+    MPI_Bcast(&(parameters.checkpoint.keyframeInterval),1,MPI_INT,0,communicator);
     MPI_Bcast(&(parameters.restart.latest),1,MPI_INT,0,communicator);
     MPI_Bcast(&(parameters.restart.startNew),1,MPI_INT,0,communicator);
 
@@ -622,5 +1011,11 @@ void Configuration::loadParameters(Parameters & parameters, const MPI_Comm & com
     MPI_Bcast(&(parameters.turbulenceModel.mixingLengthModel.deltaType),  1, MPI_INT,      0, communicator);
     MPI_Bcast(&(parameters.turbulenceModel.mixingLengthModel.deltaValue), 1, MY_MPI_FLOAT, 0, communicator);
     MPI_Bcast(&(parameters.turbulenceModel.mixingLengthModel.kappa),      1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.turbulenceModel.wallDistance),                 1, MPI_INT,      0, communicator);
+    MPI_Bcast(&(parameters.turbulenceModel.updateInterval),               1, MPI_INT,      0, communicator);
+    MPI_Bcast(&(parameters.turbulenceModel.updateThreshold),              1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.turbulenceModel.wallFunctions),                1, MPI_INT,      0, communicator);
+    MPI_Bcast(&(parameters.turbulenceModel.logLawIntercept),              1, MY_MPI_FLOAT, 0, communicator);
+    MPI_Bcast(&(parameters.turbulenceModel.spalartAllmaras.inflowRatio),  1, MY_MPI_FLOAT, 0, communicator);
 
 }
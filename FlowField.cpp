@@ -1,4 +1,5 @@
 #include "FlowField.h"
+#include <algorithm>
 
 FlowField::FlowField ( int Nx, int Ny ) :
     _size_x ( Nx ), _size_y ( Ny ), _size_z ( 1 ),
@@ -81,6 +82,71 @@ int FlowField::getCellsZ() const{
 }
 
 
+void FlowField::computeFluidIntervals ( int dim ) {
+    const int cellsZ = dim == 3 ? _cellsZ : 1;
+    int solid = OBSTACLE_SELF + OBSTACLE_LEFT + OBSTACLE_RIGHT + OBSTACLE_BOTTOM + OBSTACLE_TOP;
+    if (dim == 3) {
+        solid += OBSTACLE_FRONT + OBSTACLE_BACK;
+    }
+
+    _fluidIntervals.assign(2 * _cellsY * cellsZ, 0);
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < _cellsY; j++) {
+            int begin = _cellsX, end = 0;
+            for (int i = 0; i < _cellsX; i++) {
+                if (_flags.getValue(i, j, k) != solid) {
+                    begin = std::min(begin, i);
+                    end = i + 1;
+                }
+            }
+            _fluidIntervals[2 * (j + _cellsY * k)]     = end > 0 ? begin : 0;
+            _fluidIntervals[2 * (j + _cellsY * k) + 1] = end;
+        }
+    }
+}
+
+
+const int * FlowField::getFluidIntervals () const {
+    return _fluidIntervals.empty() ? NULL : &_fluidIntervals[0];
+}
+
+
+void FlowField::computeFluidRuns ( int dim ) {
+    const int cellsZ = dim == 3 ? _cellsZ : 1;
+
+    _fluidRunOffsets.assign(_cellsY * cellsZ + 1, 0);
+    _fluidRuns.clear();
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < _cellsY; j++) {
+            int i = 0;
+            while (i < _cellsX) {
+                if (_flags.getValue(i, j, k) != 0) {
+                    i++;
+                    continue;
+                }
+                const int begin = i;
+                while (i < _cellsX && _flags.getValue(i, j, k) == 0) {
+                    i++;
+                }
+                _fluidRuns.push_back(begin);
+                _fluidRuns.push_back(i);
+            }
+            _fluidRunOffsets[j + _cellsY * k + 1] = _fluidRuns.size() / 2;
+        }
+    }
+}
+
+
+const int * FlowField::getFluidRunOffsets () const {
+    return _fluidRunOffsets.empty() ? NULL : &_fluidRunOffsets[0];
+}
+
+
+const int * FlowField::getFluidRuns () const {
+    return _fluidRuns.empty() ? NULL : &_fluidRuns[0];
+}
+
+
 ScalarField & FlowField::getPressure () {
     return _pressure;
 }
@@ -3,6 +3,7 @@
 
 #include "DataStructures.h"
 #include "Parameters.h"
+#include <vector>
 
 /** Flow field
  *
@@ -28,6 +29,10 @@ class FlowField {
 
         ScalarField _RHS;      //! Right hand side for the Poisson equation
 
+        std::vector<int> _fluidIntervals;   //! Per row, the cells [begin,end) outside the solid interior
+        std::vector<int> _fluidRunOffsets;  //! Per row, the index of its first fluid run
+        std::vector<int> _fluidRuns;        //! Fluid runs [begin,end) of all rows, one row after the other
+
     public:
 
         /** Constructor for the 2D flow field
@@ -107,6 +112,37 @@ class FlowField {
          */
         ScalarField & getRHS ();
 
+        /** Detects the solid interior, i.e. the obstacle cells whose neighbours are all obstacles,
+         *  from the flags. For each row along X, the cells from the first to the last one outside
+         *  of it form an interval [begin,end), empty for rows inside obstacles. The stencils of the
+         *  time step leave the solid interior as it is, so that the sweeps may skip it.
+         *
+         * @param dim Dimension of the flow field
+         */
+        void computeFluidIntervals ( int dim );
+
+        /** Intervals of the rows as pairs of begin and end, the row (j,k) at 2*(j + cellsY*k), or
+         *  NULL before computeFluidIntervals
+         */
+        const int * getFluidIntervals () const;
+
+        /** Collects the fluid runs, i.e. the maximal ranges along X of fluid cells without obstacle
+         *  neighbours, whose flags are zero. The stencils may treat them without the branches on
+         *  the flags, and the remaining cells of a row are left to the general case.
+         *
+         * @param dim Dimension of the flow field
+         */
+        void computeFluidRuns ( int dim );
+
+        /** Offsets of the runs of the rows, the runs of row (j,k) being the ones from
+         *  offsets[j + cellsY*k] to offsets[j + cellsY*k + 1], or NULL before computeFluidRuns
+         */
+        const int * getFluidRunOffsets () const;
+
+        /** Fluid runs as pairs of begin and end, or NULL without any
+         */
+        const int * getFluidRuns () const;
+
         void getPressureAndVelocity(FLOAT &pressure, FLOAT* const velocity, int i, int j);
         void getVelocityCenter(FLOAT* const velocity, int i, int j);
         void getPressureAndVelocity(FLOAT &pressure, FLOAT* const velocity, int i, int j, int k);
@@ -0,0 +1,435 @@
+#include "ImplicitViscosity.h"
+#include <algorithm>
+
+//! Nodes of a line
+enum NodeType {
+    FreeNode=0,     //! Solved for, coupled with its free neighbours
+    FixedNode       //! Not changed: ghost cells, global boundaries and obstacles
+};
+
+//! Entries sent per line and rank to the reduced system: lower, diagonal, upper and right hand
+//! side of the rows of the first and last owned node, then their types and couplings
+static const int REDUCED_ENTRIES = 12;
+
+
+/** Thomas algorithm on a tridiagonal system, leaving the matrix unchanged
+ *
+ * @param work Scratch of the same size holding the eliminated diagonal
+ */
+static void solveTridiagonal ( const FLOAT * lower, const FLOAT * diagonal, const FLOAT * upper,
+                               FLOAT * rhs, FLOAT * work, int size ) {
+    work[0] = diagonal[0];
+    for (int n = 1; n < size; n++) {
+        const FLOAT factor = lower[n] / work[n-1];
+        work[n] = diagonal[n] - factor * upper[n-1];
+        rhs[n] -= factor * rhs[n-1];
+    }
+    rhs[size-1] /= work[size-1];
+    for (int n = size - 2; n >= 0; n--) {
+        rhs[n] = (rhs[n] - upper[n] * rhs[n+1]) / work[n];
+    }
+}
+
+
+//! Increment beyond a node which is not free, as seen by its free neighbour
+enum Coupling {
+    ZeroCoupling=0,     //! The increment vanishes
+    MirrorCoupling,     //! Opposite increment, tangential velocity at a no-slip wall
+    CopyCoupling        //! Same increment, Neumann boundary
+};
+
+
+ImplicitViscosity::ImplicitViscosity ( FlowField & flowField, const Parameters & parameters ) :
+  _parameters(parameters),
+  _flowField(flowField),
+  _turbFlowField(parameters.simulation.type == "turbulence" ? (TurbulentFlowField*) &flowField : NULL)
+{
+    const int size = std::max(std::max(flowField.getCellsX(), flowField.getCellsY()), flowField.getCellsZ());
+    _lower.resize(size);
+    _diagonal.resize(size);
+    _upper.resize(size);
+    _rhs.resize(size);
+    _type.resize(size);
+    _coupling.resize(size);
+    _work.resize(size);
+    _lowerResponse.resize(size);
+    _upperResponse.resize(size);
+
+    // the ranks sharing the lines along a dimension, ordered along it
+    const int dim = parameters.geometry.dim;
+    for (int d = 0; d < 3; d++) {
+        _lineCommunicators[d] = MPI_COMM_NULL;
+        if (!parameters.timestep.implicitViscosity || d >= dim) {
+            continue;
+        }
+        if (parameters.parallel.numProcessors[d] > 1 && parameters.parallel.localSize[d] < 2) {
+            handleError(1, "The implicit viscous terms need at least two cells per subdomain along each dimension");
+        }
+        const int d1 = (d + 1) % 3, d2 = (d + 2) % 3;
+        const int colour = parameters.parallel.indices[d1] * parameters.parallel.numProcessors[d2] +
+                           parameters.parallel.indices[d2];
+        MPI_Comm_split(PETSC_COMM_WORLD, colour, parameters.parallel.indices[d], &_lineCommunicators[d]);
+    }
+    const int ranks = std::max(std::max(parameters.parallel.numProcessors[0], parameters.parallel.numProcessors[1]),
+                               parameters.parallel.numProcessors[2]);
+    _reducedLower.resize(2 * ranks);
+    _reducedDiagonal.resize(2 * ranks);
+    _reducedUpper.resize(2 * ranks);
+    _reducedRhs.resize(2 * ranks);
+    _reducedWork.resize(2 * ranks);
+}
+
+
+ImplicitViscosity::~ImplicitViscosity () {
+    for (int d = 0; d < 3; d++) {
+        if (_lineCommunicators[d] != MPI_COMM_NULL) {
+            MPI_Comm_free(&_lineCommunicators[d]);
+        }
+    }
+}
+
+
+int ImplicitViscosity::getCells ( int dimension ) const {
+    return dimension == 0 ? _flowField.getCellsX() : (dimension == 1 ? _flowField.getCellsY() : _flowField.getCellsZ());
+}
+
+
+FLOAT ImplicitViscosity::getSpacing ( int dimension, const int index[3] ) const {
+    const Meshsize * ms = _parameters.meshsize;
+    if (_parameters.geometry.dim == 2) {
+        return dimension == 0 ? ms->getDx(index[0], index[1]) : ms->getDy(index[0], index[1]);
+    }
+    return dimension == 0 ? ms->getDx(index[0], index[1], index[2]) :
+          (dimension == 1 ? ms->getDy(index[0], index[1], index[2]) : ms->getDz(index[0], index[1], index[2]));
+}
+
+
+FLOAT ImplicitViscosity::getViscosity ( int component, const int index[3] ) {
+    FLOAT viscosity = 1.0 / _parameters.flow.Re;
+    if (_turbFlowField != NULL) {
+        // the component lies on the face between the cell and its upper neighbour
+        int next[3] = {index[0], index[1], index[2]};
+        next[component]++;
+        ScalarField & turbViscosity = _turbFlowField->getTurbViscosity();
+        viscosity += 0.5 * (turbViscosity.getScalar(index[0], index[1], index[2]) +
+                            turbViscosity.getScalar(next[0], next[1], next[2]));
+    }
+    return viscosity;
+}
+
+
+void ImplicitViscosity::classify ( int component, int direction, int n, const int index[3],
+                                   int & type, int & coupling ) {
+    const int cells = getCells(direction);
+    const int lowerNb[3] = {_parameters.parallel.leftNb, _parameters.parallel.bottomNb, _parameters.parallel.frontNb};
+    const int upperNb[3] = {_parameters.parallel.rightNb, _parameters.parallel.topNb, _parameters.parallel.backNb};
+    const BoundaryType lowerWall[3] = {_parameters.walls.typeLeft, _parameters.walls.typeBottom, _parameters.walls.typeFront};
+    const BoundaryType upperWall[3] = {_parameters.walls.typeRight, _parameters.walls.typeTop, _parameters.walls.typeBack};
+    IntScalarField & flags = _flowField.getFlags();
+
+    type = FixedNode;
+    coupling = ZeroCoupling;
+
+    if (component == direction) {
+        // the node is the face between the cells n and n+1. At a Neumann boundary, the face on the
+        // boundary is computed by the FGH stencil and the one beyond is a copy of it
+        if (n == 0 || n == cells - 1) {
+            const bool lower = n == 0;
+            if ((lower ? lowerNb[direction] : upperNb[direction]) < 0 &&
+                (lower ? lowerWall[direction] : upperWall[direction]) == NEUMANN) {
+                coupling = CopyCoupling;
+            }
+            return;
+        }
+        if (n == 1 || n == cells - 2) {
+            const bool lower = n == 1;
+            if ((lower ? lowerNb[direction] : upperNb[direction]) < 0 &&
+                (lower ? lowerWall[direction] : upperWall[direction]) != NEUMANN) {
+                return;
+            }
+        }
+        int next[3] = {index[0], index[1], index[2]};
+        next[direction]++;
+        if ((flags.getValue(index[0], index[1], index[2]) & OBSTACLE_SELF) ||
+            (flags.getValue(next[0], next[1], next[2]) & OBSTACLE_SELF)) {
+            return;
+        }
+    } else {
+        // the node is the centre of the cell n
+        if (n < 1) {
+            return;
+        }
+        const bool lower = n == 1, upper = n == cells - 1;
+        if (lower || upper) {
+            const int neighbour = lower ? lowerNb[direction] : upperNb[direction];
+            const BoundaryType wall = lower ? lowerWall[direction] : upperWall[direction];
+            if (neighbour < 0 && wall == DIRICHLET) {
+                coupling = MirrorCoupling;
+            } else if (neighbour < 0 && wall == NEUMANN) {
+                coupling = CopyCoupling;
+            }
+            return;
+        }
+        if (flags.getValue(index[0], index[1], index[2]) & OBSTACLE_SELF) {
+            coupling = MirrorCoupling;
+            return;
+        }
+    }
+    type = FreeNode;
+}
+
+
+void ImplicitViscosity::assembleLine ( int component, int direction, int index[3], int first, int last ) {
+    const FLOAT dt = _parameters.timestep.dt;
+    VectorField & fgh = _flowField.getFGH();
+
+    for (int n = first; n <= last; n++) {
+        index[direction] = n;
+        classify(component, direction, n, index, _type[n], _coupling[n]);
+    }
+
+    for (int n = first; n <= last; n++) {
+        index[direction] = n;
+        _rhs[n] = fgh.getVector(index[0], index[1], index[2])[component];
+        _lower[n] = _upper[n] = 0.0;
+        _diagonal[n] = 1.0;
+        if (_type[n] == FixedNode) {
+            continue;
+        }
+
+        // distances to the neighbouring nodes and the width of the control volume
+        int neighbour[3] = {index[0], index[1], index[2]};
+        const FLOAT spacing = getSpacing(direction, index);
+        neighbour[direction] = n + 1;
+        const FLOAT upperSpacing = getSpacing(direction, neighbour);
+        FLOAT lowerDistance, upperDistance;
+        if (component == direction) {
+            lowerDistance = spacing;
+            upperDistance = upperSpacing;
+        } else {
+            neighbour[direction] = n - 1;
+            lowerDistance = 0.5 * (getSpacing(direction, neighbour) + spacing);
+            upperDistance = 0.5 * (spacing + upperSpacing);
+        }
+        const FLOAT width = 0.5 * (lowerDistance + upperDistance);
+        const FLOAT factor = dt * getViscosity(component, index);
+        const FLOAT lowerCoefficient = factor / (lowerDistance * width);
+        const FLOAT upperCoefficient = factor / (upperDistance * width);
+
+        _diagonal[n] += lowerCoefficient + upperCoefficient;
+        const int sides[2] = {n - 1, n + 1};
+        const FLOAT coefficients[2] = {lowerCoefficient, upperCoefficient};
+        for (int side = 0; side < 2; side++) {
+            const int m = sides[side];
+            if (m < first || m > last) {
+                // owned by the neighbouring subdomain, coupled in the reduced system
+                (side == 0 ? _lower[n] : _upper[n]) = coefficients[side];
+            } else if (_type[m] == FreeNode) {
+                (side == 0 ? _lower[n] : _upper[n]) = -coefficients[side];
+            } else if (_coupling[m] == MirrorCoupling) {
+                _diagonal[n] += coefficients[side];
+            } else if (_coupling[m] == CopyCoupling) {
+                _diagonal[n] -= coefficients[side];
+            }
+        }
+    }
+}
+
+
+void ImplicitViscosity::solveLines ( int component, int direction ) {
+    const int dim = _parameters.geometry.dim;
+    const int lowerNb[3] = {_parameters.parallel.leftNb, _parameters.parallel.bottomNb, _parameters.parallel.frontNb};
+    const int upperNb[3] = {_parameters.parallel.rightNb, _parameters.parallel.topNb, _parameters.parallel.backNb};
+    const int cells = getCells(direction);
+    VectorField & fgh = _flowField.getFGH();
+
+    // range of the lines in the other dimensions: the inner cells, and for the component normal to
+    // a dimension the faces shared with a neighbouring subdomain or on a Neumann boundary, but not
+    // the ones on the other global boundaries
+    const BoundaryType lowerWall[3] = {_parameters.walls.typeLeft, _parameters.walls.typeBottom, _parameters.walls.typeFront};
+    const BoundaryType upperWall[3] = {_parameters.walls.typeRight, _parameters.walls.typeTop, _parameters.walls.typeBack};
+    int first[3] = {0, 0, 0}, last[3] = {0, 0, 0};
+    for (int d = 0; d < dim; d++) {
+        first[d] = 2;
+        last[d] = getCells(d) - 2;
+        if (d == component) {
+            first[d] = lowerNb[d] >= 0 || lowerWall[d] == NEUMANN ? 1 : 2;
+            last[d] = upperNb[d] >= 0 || upperWall[d] == NEUMANN ? getCells(d) - 2 : getCells(d) - 3;
+        }
+    }
+    first[direction] = last[direction] = 0;
+
+    int index[3];
+    const int ranks = _parameters.parallel.numProcessors[direction];
+    if (ranks == 1) {
+        for (int k = first[2]; k <= last[2]; k++) {
+            for (int j = first[1]; j <= last[1]; j++) {
+                for (int i = first[0]; i <= last[0]; i++) {
+                    index[0] = i; index[1] = j; index[2] = k;
+                    assembleLine(component, direction, index, 0, cells - 1);
+                    solveTridiagonal(&_lower[0], &_diagonal[0], &_upper[0], &_rhs[0], &_work[0], cells);
+                    for (int n = 0; n < cells; n++) {
+                        index[direction] = n;
+                        fgh.getVector(index[0], index[1], index[2])[component] = _rhs[n];
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    // Each rank owns the nodes from its first inner cell or face to its last one, and the first and
+    // last rank also the nodes beyond the global boundaries. The owned interior of a line is
+    // eliminated locally, leaving the rows of the first and last owned node in terms of the
+    // neighbouring ones; these form a tridiagonal system of two rows per rank, which every rank of
+    // the line solves. The interior then follows from the values at its ends.
+    const int rank = _parameters.parallel.indices[direction];
+    const int owned[2] = {rank == 0 ? 0 : 2, rank == ranks - 1 ? cells - 1 : cells - 2};
+    const int a = owned[0], b = owned[1], interior = b - a - 1;
+    const int lines = (last[0] - first[0] + 1) * (last[1] - first[1] + 1) * (last[2] - first[2] + 1);
+    _reduced.resize(REDUCED_ENTRIES * lines);
+    _gathered.resize(REDUCED_ENTRIES * lines * ranks);
+
+    int line = 0;
+    for (int k = first[2]; k <= last[2]; k++) {
+        for (int j = first[1]; j <= last[1]; j++) {
+            for (int i = first[0]; i <= last[0]; i++, line++) {
+                index[0] = i; index[1] = j; index[2] = k;
+                assembleLine(component, direction, index, a, b);
+
+                // responses of the interior to its right hand side and to unit values at both ends
+                FLOAT * rows = &_reduced[REDUCED_ENTRIES * line];
+                const FLOAT aUpper = _upper[a], bLower = _lower[b];
+                rows[1] = _diagonal[a];  rows[3] = _rhs[a];
+                rows[5] = _diagonal[b];  rows[7] = _rhs[b];
+                rows[2] = aUpper;        rows[4] = bLower;
+                if (interior > 0) {
+                    for (int n = 0; n < interior; n++) {
+                        _lowerResponse[a+1+n] = _upperResponse[a+1+n] = 0.0;
+                    }
+                    _lowerResponse[a+1] = -_lower[a+1];
+                    _upperResponse[b-1] = -_upper[b-1];
+                    solveTridiagonal(&_lower[a+1], &_diagonal[a+1], &_upper[a+1], &_rhs[a+1], &_work[0], interior);
+                    solveTridiagonal(&_lower[a+1], &_diagonal[a+1], &_upper[a+1], &_lowerResponse[a+1], &_work[0], interior);
+                    solveTridiagonal(&_lower[a+1], &_diagonal[a+1], &_upper[a+1], &_upperResponse[a+1], &_work[0], interior);
+                    rows[1] += aUpper * _lowerResponse[a+1];
+                    rows[2] = aUpper * _upperResponse[a+1];
+                    rows[3] -= aUpper * _rhs[a+1];
+                    rows[4] = bLower * _lowerResponse[b-1];
+                    rows[5] += bLower * _upperResponse[b-1];
+                    rows[7] -= bLower * _rhs[b-1];
+                }
+                rows[0] = _lower[a];
+                rows[6] = _upper[b];
+                rows[8] = _type[a];  rows[9] = _coupling[a];
+                rows[10] = _type[b]; rows[11] = _coupling[b];
+            }
+        }
+    }
+
+    MPI_Allgather(&_reduced[0], REDUCED_ENTRIES * lines, MY_MPI_FLOAT,
+                  &_gathered[0], REDUCED_ENTRIES * lines, MY_MPI_FLOAT, _lineCommunicators[direction]);
+
+    line = 0;
+    for (int k = first[2]; k <= last[2]; k++) {
+        for (int j = first[1]; j <= last[1]; j++) {
+            for (int i = first[0]; i <= last[0]; i++, line++) {
+                // reduced system, coupling the ends of the ranks as their owners classified them
+                for (int r = 0; r < ranks; r++) {
+                    const FLOAT * rows = &_gathered[REDUCED_ENTRIES * (r * lines + line)];
+                    for (int row = 0; row < 2; row++) {
+                        _reducedLower[2*r+row] = rows[4*row];
+                        _reducedDiagonal[2*r+row] = rows[4*row+1];
+                        _reducedUpper[2*r+row] = rows[4*row+2];
+                        _reducedRhs[2*r+row] = rows[4*row+3];
+                    }
+                    for (int side = 0; side < 2; side++) {
+                        const int other = side == 0 ? r - 1 : r + 1;
+                        const int row = 2 * r + side;
+                        FLOAT & offDiagonal = side == 0 ? _reducedLower[row] : _reducedUpper[row];
+                        const FLOAT coefficient = offDiagonal;
+                        offDiagonal = 0.0;
+                        if (other < 0 || other >= ranks) {
+                            continue;
+                        }
+                        // the first node of the upper rank or the last one of the lower rank
+                        const FLOAT * otherRows = &_gathered[REDUCED_ENTRIES * (other * lines + line)];
+                        const int type = (int) otherRows[side == 0 ? 10 : 8];
+                        const int coupling = (int) otherRows[side == 0 ? 11 : 9];
+                        if (type == FreeNode) {
+                            offDiagonal = -coefficient;
+                        } else if (coupling == MirrorCoupling) {
+                            _reducedDiagonal[row] += coefficient;
+                        } else if (coupling == CopyCoupling) {
+                            _reducedDiagonal[row] -= coefficient;
+                        }
+                    }
+                }
+                solveTridiagonal(&_reducedLower[0], &_reducedDiagonal[0], &_reducedUpper[0], &_reducedRhs[0],
+                                 &_reducedWork[0], 2 * ranks);
+
+                // interior of the line from the values at its ends
+                index[0] = i; index[1] = j; index[2] = k;
+                assembleLine(component, direction, index, a, b);
+                const FLOAT aValue = _reducedRhs[2*rank], bValue = _reducedRhs[2*rank+1];
+                if (interior > 0) {
+                    _rhs[a+1] -= _lower[a+1] * aValue;
+                    _rhs[b-1] -= _upper[b-1] * bValue;
+                    solveTridiagonal(&_lower[a+1], &_diagonal[a+1], &_upper[a+1], &_rhs[a+1], &_work[0], interior);
+                }
+                _rhs[a] = aValue;
+                _rhs[b] = bValue;
+
+                // the nodes next to the owned ones get the values of their owners, so that the faces
+                // shared with a neighbour agree on both ranks
+                const int from = rank > 0 ? a - 1 : a, to = rank < ranks - 1 ? b + 1 : b;
+                if (rank > 0) {
+                    _rhs[a-1] = _reducedRhs[2*rank-1];
+                }
+                if (rank < ranks - 1) {
+                    _rhs[b+1] = _reducedRhs[2*rank+2];
+                }
+                for (int n = from; n <= to; n++) {
+                    index[direction] = n;
+                    fgh.getVector(index[0], index[1], index[2])[component] = _rhs[n];
+                }
+            }
+        }
+    }
+}
+
+
+void ImplicitViscosity::apply () {
+    const int dim = _parameters.geometry.dim;
+    const int cellsX = _flowField.getCellsX(), cellsY = _flowField.getCellsY();
+    const int cellsZ = dim == 3 ? _flowField.getCellsZ() : 1;   // getCellsZ also counts ghost layers in 2D
+    VectorField & velocity = _flowField.getVelocity();
+    VectorField & fgh = _flowField.getFGH();
+
+    // increments of the explicit step
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < cellsY; j++) {
+            for (int i = 0; i < cellsX; i++) {
+                for (int c = 0; c < dim; c++) {
+                    fgh.getVector(i, j, k)[c] -= velocity.getVector(i, j, k)[c];
+                }
+            }
+        }
+    }
+
+    for (int direction = 0; direction < dim; direction++) {
+        for (int component = 0; component < dim; component++) {
+            solveLines(component, direction);
+        }
+    }
+
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < cellsY; j++) {
+            for (int i = 0; i < cellsX; i++) {
+                for (int c = 0; c < dim; c++) {
+                    fgh.getVector(i, j, k)[c] += velocity.getVector(i, j, k)[c];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef _IMPLICIT_VISCOSITY_H_
+#define _IMPLICIT_VISCOSITY_H_
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "FlowField.h"
+#include "TurbulentFlowField.h"
+#include <vector>
+
+/** Backward Euler step of the viscous terms, applied to the FGH field computed explicitly.
+ *
+ * The explicit FGH holds u + dt*(E + D(u)), where D are the viscous terms with the viscosity
+ * 1/Re + nu_t. Solving (I - dt*D) delta = FGH - u and setting FGH = u + delta gives
+ * (I - dt*D) FGH = u + dt*E, i.e. the convection explicit and the viscous terms implicit, without
+ * changing the FGH stencils. The operator is factorised into one tridiagonal solve per dimension
+ * (ADI), so that the cost is a few line sweeps per velocity component. Since delta vanishes if and
+ * only if FGH = u, the steady states are the ones of the explicit scheme.
+ *
+ * Beyond no-slip walls and obstacles, the increments of the tangential components are mirrored and
+ * the ones of the normal component vanish; at Neumann boundaries they are copied. The lines span the
+ * global domain: with several ranks along a dimension, each rank eliminates the nodes it owns down
+ * to the two at its ends, and the ranks of the line solve the resulting system together, so that
+ * the result does not depend on the process grid.
+ */
+class ImplicitViscosity {
+    private:
+
+        const Parameters & _parameters;
+        FlowField & _flowField;
+        TurbulentFlowField * _turbFlowField;    //! NULL in DNS
+
+        // Tridiagonal system of one line
+        std::vector<FLOAT> _lower;
+        std::vector<FLOAT> _diagonal;
+        std::vector<FLOAT> _upper;
+        std::vector<FLOAT> _rhs;
+        std::vector<int> _type;     //! NodeType of each node of the line
+        std::vector<int> _coupling; //! Coupling of the free neighbours of a node which is not free
+        std::vector<FLOAT> _work;           //! Eliminated diagonal of the Thomas algorithm
+        std::vector<FLOAT> _lowerResponse;  //! Interior of a line for a unit value at its first owned node
+        std::vector<FLOAT> _upperResponse;  //! Interior of a line for a unit value at its last owned node
+
+        // Reduced system of the ends of the lines on all ranks along a dimension
+        MPI_Comm _lineCommunicators[3];     //! Ranks sharing the lines along each dimension, ordered along it
+        std::vector<FLOAT> _reduced;        //! Rows of the local ends of all lines
+        std::vector<FLOAT> _gathered;       //! Rows of the ends of all lines on all ranks of the line
+        std::vector<FLOAT> _reducedLower;
+        std::vector<FLOAT> _reducedDiagonal;
+        std::vector<FLOAT> _reducedUpper;
+        std::vector<FLOAT> _reducedRhs;
+        std::vector<FLOAT> _reducedWork;
+
+        /** Number of cells (inner and ghost) along a dimension */
+        int getCells ( int dimension ) const;
+
+        /** Mesh width of the cell along a dimension */
+        FLOAT getSpacing ( int dimension, const int index[3] ) const;
+
+        /** Viscosity at the position of a velocity component, 1/Re + nu_t */
+        FLOAT getViscosity ( int component, const int index[3] );
+
+        /** Classifies the node of a line of a velocity component and sets its coupling */
+        void classify ( int component, int direction, int n, const int index[3], int & type, int & coupling );
+
+        /** Sets up the rows of the nodes first to last of a line. Couplings to nodes outside of
+         *  this range are kept as positive coefficients in the lower and upper diagonal
+         */
+        void assembleLine ( int component, int direction, int index[3], int first, int last );
+
+        /** Solves the lines of a velocity component along one dimension, on the increments held
+         *  in the FGH field
+         */
+        void solveLines ( int component, int direction );
+
+    public:
+
+        /** Constructor
+         *
+         * @param flowField Flow field, a TurbulentFlowField in the turbulent simulation
+         * @param parameters Parameters of the problem
+         */
+        ImplicitViscosity ( FlowField & flowField, const Parameters & parameters );
+
+        /** Destructor, frees the communicators of the lines */
+        ~ImplicitViscosity ();
+
+        /** Replaces the explicit FGH by the one with the viscous terms implicit, for the current
+         *  time step. Apply after the global boundary values of FGH have been set.
+         */
+        void apply ();
+};
+
+#endif
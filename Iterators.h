@@ -3,6 +3,7 @@
 
 #include "Stencil.h"
 #include "Parameters.h"
+#include <algorithm>
 
 
 /** Iterator class
@@ -27,6 +28,8 @@ class Iterator {
          */
         Iterator ( FlowField & flowfield, const Parameters& parameters ): _flowField(flowfield), _parameters(parameters){}
 
+        virtual ~Iterator () {}
+
         /** Perform the stencil operation on inner, non-ghost cells
          */
         virtual void iterate () = 0;
@@ -46,15 +49,25 @@ class FieldIterator : public Iterator<FlowField> {
         const int _highOffset;
         //@}
 
+        const bool _fluidOnly;  //! Whether the solid interior is skipped and the fluid runs are used, if the flow field has them
+
+        /** Applies the stencil to the cells [first,last) of the row (j,k), with the fast kernel
+         * on its fluid runs and the general one on the cells between them
+         */
+        void applyRow ( int first, int last, int j, int k );
+
     public:
 
         FieldIterator (FlowField & flowField, const Parameters& parameters, FieldStencil<FlowField> & stencil,
-                       int lowOffset = 0, int highOffset = 0);
+                       int lowOffset = 0, int highOffset = 0, bool fluidOnly = false);
 
         /** Volume iteration over the field.
          *
          * Volume iteration. The stencil will be applied to all cells in the domain plus the upper
-         * boundaries. Lower boundaries are not included.
+         * boundaries. Lower boundaries are not included. With fluidOnly, each row is limited to its
+         * fluid interval, once the flow field has them; the stencil must not change the obstacle
+         * cells whose neighbours are all obstacles. Likewise, the fluid runs of the flow field take
+         * the fast kernel of the stencil.
          */
         void iterate ();
 };
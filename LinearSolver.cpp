@@ -1,4 +1,9 @@
 #include "LinearSolver.h"
 
 LinearSolver::LinearSolver(FlowField & flowField, const Parameters & parameters):
-    _flowField(flowField), _parameters(parameters){}
+    _flowField(flowField), _parameters(parameters){
+    _lastSolve.iterations = 0;
+    _lastSolve.initialResidual = _lastSolve.finalResidual = 0.0;
+    _lastSolve.setupTime = _lastSolve.solveTime = 0.0;
+    _lastSolve.converged = 0;
+}
@@ -4,11 +4,22 @@
 #include "Parameters.h"
 #include "FlowField.h"
 
+/** Statistics of one solve of the linear system, filled in by the backends */
+struct SolveRecord {
+    int iterations;
+    FLOAT initialResidual;  //! Residual norm before the first iteration, as defined by the backend
+    FLOAT finalResidual;
+    double setupTime;       //! Assembly of the operator and setup of the preconditioner, seconds
+    double solveTime;       //! Iterations, seconds
+    int converged;          //! Convergence reason of the backend, positive if converged
+};
+
 // Abstract class for linear solvers for the pressure
 class LinearSolver {
     protected:
         FlowField & _flowField;  //! Reference to the flow field
         const Parameters & _parameters;  //! Reference to the parameters
+        SolveRecord _lastSolve;  //! Statistics of the last call to solve
 
     public:
         /** Constructor
@@ -20,6 +31,9 @@ class LinearSolver {
         /** Solve the linear system for the pressure
          */
         virtual void solve() = 0;
+
+        /** Returns the statistics of the last solve */
+        const SolveRecord & getLastSolve() const { return _lastSolve; }
 };
 
 #endif
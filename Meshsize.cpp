@@ -35,7 +35,8 @@ TanhMeshStretching::TanhMeshStretching(
    _stretchX(stretchX), _stretchY(stretchY), _stretchZ(stretchZ),
    _dxMin(stretchX ? 0.5*parameters.geometry.lengthX*(1.0 + tanh(parameters.geometry.deltaSX*(2.0/parameters.geometry.sizeX-1.0))/tanh(parameters.geometry.deltaSX)) : _uniformMeshsize.getDx(0,0,0)),
    _dyMin(stretchY ? 0.5*parameters.geometry.lengthY*(1.0 + tanh(parameters.geometry.deltaSY*(2.0/parameters.geometry.sizeY-1.0))/tanh(parameters.geometry.deltaSY)) : _uniformMeshsize.getDy(0,0,0)),
-   _dzMin(stretchZ ? 0.5*parameters.geometry.lengthZ*(1.0 + tanh(parameters.geometry.deltaSZ*(2.0/parameters.geometry.sizeZ-1.0))/tanh(parameters.geometry.deltaSZ)) : _uniformMeshsize.getDz(0,0,0))
+   _dzMin(stretchZ ? 0.5*parameters.geometry.lengthZ*(1.0 + tanh(parameters.geometry.deltaSZ*(2.0/parameters.geometry.sizeZ-1.0))/tanh(parameters.geometry.deltaSZ)) : _uniformMeshsize.getDz(0,0,0)),
+   _coordinatesX(NULL), _coordinatesY(NULL), _coordinatesZ(NULL)
 { }
 
 TanhMeshStretching::~TanhMeshStretching(){
@@ -160,3 +161,117 @@ FLOAT BfsMeshStretching::computeCoordinateY(int i) const {
     return _parameters.bfStep.yRatio*_lengthY + computeCoordinate(i-_sizeYBelowStep,_firstCornerY,_sizeYAboveStep,(1.0-_parameters.bfStep.yRatio)*_lengthY,_parameters.geometry.deltaSY,_dyMinAbove);
   }
 }
+
+
+
+BlockMeshRefinement::BlockMeshRefinement(
+  const Parameters & parameters
+): TanhMeshStretching(parameters,true,true,parameters.geometry.dim==3),
+   _blockSize(parameters.geometry.blockSize), _levels(parameters.geometry.refinementLevels)
+{ }
+
+BlockMeshRefinement::~BlockMeshRefinement(){}
+
+int BlockMeshRefinement::getLevel(int m, int n, bool lower, bool upper) const {
+  if (!lower && !upper){
+    return 0;
+  }
+  int distance = n;
+  if (lower){
+    distance = std::min(distance, m);
+  }
+  if (upper){
+    distance = std::min(distance, n-1-m);
+  }
+  return std::max(0, _levels - distance/_blockSize);
+}
+
+FLOAT BlockMeshRefinement::computeCoarseWidth(FLOAT length, int n, bool lower, bool upper) const {
+  FLOAT cells = 0.0;
+  for (int m = 0; m < n; m++){
+    cells += ldexp(1.0, -getLevel(m,n,lower,upper));
+  }
+  return length/cells;
+}
+
+void BlockMeshRefinement::fillSegment(std::vector<FLOAT> & faces, int first, int n, FLOAT start, FLOAT end,
+                                      bool lower, bool upper) const {
+  const FLOAT coarseWidth = computeCoarseWidth(end-start, n, lower, upper);
+  faces[first] = start;
+  for (int m = 0; m < n; m++){
+    faces[first+m+1] = faces[first+m] + coarseWidth*ldexp(1.0, -getLevel(m,n,lower,upper));
+  }
+  faces[first+n] = end;
+}
+
+void BlockMeshRefinement::computeFaces(std::vector<FLOAT> & faces, FLOAT length, int size, FLOAT feature,
+                                       bool walls) const {
+  faces.assign(size+1, 0.0);
+  if (feature <= 0.0 || feature >= length){
+    fillSegment(faces, 0, size, 0.0, length, walls, walls);
+    return;
+  }
+
+  // split the cells so that the coarse cells on both sides of the feature are alike
+  int split = -1;
+  FLOAT bestRatio = MY_FLOAT_MAX;
+  for (int n = 1; n < size; n++){
+    const FLOAT ratio = fabs(log(computeCoarseWidth(feature, n, walls, true) /
+                                 computeCoarseWidth(length-feature, size-n, true, walls)));
+    if (ratio < bestRatio){
+      bestRatio = ratio;
+      split = n;
+    }
+  }
+  if (split < 0){
+    handleError(1,"The block mesh needs at least one cell on each side of the step!");
+  }
+  fillSegment(faces, 0, split, 0.0, feature, walls, true);
+  fillSegment(faces, split, size-split, feature, length, true, walls);
+}
+
+void BlockMeshRefinement::precomputeCoordinates(){
+  // the global boundaries which are walls, as set up by the GlobalBoundaryFactory
+  const std::string & scenario = _parameters.simulation.scenario;
+  const bool walls = scenario == "cavity" || scenario == "channel" || scenario == "pressure-channel";
+  const bool step = _parameters.bfStep.xRatio > 0.0 && _parameters.bfStep.yRatio > 0.0;
+
+  computeFaces(_facesX, _lengthX, _sizeX, step ? _parameters.bfStep.xRatio*_lengthX : -1.0, scenario == "cavity");
+  computeFaces(_facesY, _lengthY, _sizeY, step ? _parameters.bfStep.yRatio*_lengthY : -1.0, walls);
+  if (_parameters.geometry.dim == 3){
+    computeFaces(_facesZ, _lengthZ, _sizeZ, -1.0, walls);
+  }
+
+  std::vector<FLOAT> * faces[3] = {&_facesX, &_facesY, &_facesZ};
+  for (int d = 0; d < 3; d++){
+    _minWidths[d] = faces[d]->size() > 1 ? MY_FLOAT_MAX : 0.0;
+    for (unsigned int i = 1; i < faces[d]->size(); i++){
+      _minWidths[d] = std::min(_minWidths[d], (*faces[d])[i] - (*faces[d])[i-1]);
+    }
+  }
+
+  TanhMeshStretching::precomputeCoordinates();
+}
+
+FLOAT BlockMeshRefinement::computeBlockCoordinate(const std::vector<FLOAT> & faces, int i, int firstCorner) const {
+  const int index = i-2+firstCorner;
+  const int size = faces.size()-1;
+  if (index < 0){
+    return faces[0] + index*(faces[1]-faces[0]);
+  } else if (index > size){
+    return faces[size] + (index-size)*(faces[size]-faces[size-1]);
+  }
+  return faces[index];
+}
+
+FLOAT BlockMeshRefinement::computeCoordinateX(int i) const {
+  return computeBlockCoordinate(_facesX,i,_firstCornerX);
+}
+
+FLOAT BlockMeshRefinement::computeCoordinateY(int i) const {
+  return computeBlockCoordinate(_facesY,i,_firstCornerY);
+}
+
+FLOAT BlockMeshRefinement::computeCoordinateZ(int i) const {
+  return computeBlockCoordinate(_facesZ,i,_firstCornerZ);
+}
@@ -3,11 +3,12 @@
 
 #include "Definitions.h"
 #include <cmath>
+#include <vector>
 
 // forward declaration of Parameters
 class Parameters;
 
-enum MeshsizeType{Uniform=0,TanhStretching=1,BfsStretching=2};
+enum MeshsizeType{Uniform=0,TanhStretching=1,BfsStretching=2,BlockRefinement=3};
 
 /** defines the local mesh size.
  *  @author Philipp Neumann
@@ -184,4 +185,52 @@ class BfsMeshStretching: public TanhMeshStretching {
     FLOAT _dyMinBelow;
     FLOAT _dyMinAbove;
 };
+
+
+/** Static block-structured refinement towards the walls and the backward-facing step.
+ *
+ *  Each axis is graded in blocks of blockSize cells: the block next to a refined face has cells of
+ *  2^-levels of the coarse width, and each following block doubles the width until it reaches
+ *  the coarse one, so that neighbouring blocks differ by at most one level. Refined faces are the
+ *  global boundaries that are walls in the scenario and, with a backward-facing step, the faces of
+ *  the step, which split the axis into two segments. The cells of an axis are split among them so
+ *  that their coarse widths are as equal as possible, and the step lies on a face.
+ *
+ *  The tensor product of the axes keeps the single structured grid, so that the discretisation of
+ *  stretched meshes and the pressure solver apply unchanged.
+ */
+class BlockMeshRefinement: public TanhMeshStretching {
+  public:
+    BlockMeshRefinement(const Parameters & parameters);
+    virtual ~BlockMeshRefinement();
+
+    virtual FLOAT getDxMin() const { return _minWidths[0]; }
+    virtual FLOAT getDyMin() const { return _minWidths[1]; }
+    virtual FLOAT getDzMin() const { return _minWidths[2]; }
+
+    virtual void precomputeCoordinates();
+
+  protected:
+    virtual FLOAT computeCoordinateX(int i) const;
+    virtual FLOAT computeCoordinateY(int i) const;
+    virtual FLOAT computeCoordinateZ(int i) const;
+
+    // refinement level of the cell m of a segment of n cells, refined at its lower and/or upper end
+    int getLevel(int m, int n, bool lower, bool upper) const;
+    // width of the coarse cells of a segment
+    FLOAT computeCoarseWidth(FLOAT length, int n, bool lower, bool upper) const;
+    // sets the n+1 faces of a segment from first on, starting at the coordinate start
+    void fillSegment(std::vector<FLOAT> & faces, int first, int n, FLOAT start, FLOAT end, bool lower, bool upper) const;
+    // global faces of an axis, with an inner face to refine at feature if it lies inside
+    void computeFaces(std::vector<FLOAT> & faces, FLOAT length, int size, FLOAT feature, bool walls) const;
+    // coordinate of the local cell i from the global faces, continued with the outer widths beyond them
+    FLOAT computeBlockCoordinate(const std::vector<FLOAT> & faces, int i, int firstCorner) const;
+
+    const int _blockSize;
+    const int _levels;
+    std::vector<FLOAT> _facesX;
+    std::vector<FLOAT> _facesY;
+    std::vector<FLOAT> _facesZ;
+    FLOAT _minWidths[3];
+};
 #endif // _MESHSIZE_H_
@@ -48,6 +48,12 @@ class MeshsizeFactory {
           //                         parameters
           //                       );
           break;}
+        // block-structured refinement towards walls and the step
+        case BlockRefinement:{
+          BlockMeshRefinement * mesh = new BlockMeshRefinement(parameters);
+          mesh->precomputeCoordinates();
+          parameters.meshsize = mesh;
+          break;}
         default:
           handleError(1,"Unknown meshsize type!");
           break;
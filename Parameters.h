@@ -4,6 +4,7 @@
 #include "Definitions.h"
 #include <petscsys.h>
 #include <string>
+#include <vector>
 #include "Meshsize.h"
 
 //! Classes for the parts of the parameters
@@ -12,6 +13,18 @@ class TimestepParameters{
     public:
         FLOAT dt; //! Timestep
         FLOAT tau;  //! Security factor
+        int implicitViscosity;  //! Viscous terms backward Euler, dt then only bounded by the velocity
+        FLOAT maxDt;    //! The dt of the configuration; replaces the viscous bound of dt/tau if implicit
+        int rungeKutta; //! Low-storage three-stage Runge-Kutta instead of explicit Euler
+        int fixedDt;    //! The dt of the configuration in every step instead of the adaptive one
+};
+
+class SteadyStateParameters{
+    public:
+        int active;                 //! Pseudo-time stepping with local steps until the steady state
+        FLOAT tolerance;            //! Bound of the maximum of |u^{n+1} - u^n|/dt of the velocity
+        FLOAT divergenceTolerance;  //! Bound of the maximum of |div u|, none by default
+        int interval;               //! Number of steps between two checks of the convergence
 };
 
 class SimulationParameters{
@@ -39,11 +52,16 @@ class SolverParameters{
         FLOAT gamma;  //! Donor cell balance coefficient
         int maxIterations;  //! Maximum number of iterations in the linear solver
 
+        int telemetry;              //! Whether to record the statistics of each solve
+        std::string telemetryFile;  //! Output of the recorded solves, none if empty
+        int telemetryInterval;      //! Time steps between two writes of the recorded solves
+        int telemetryCapacity;      //! Number of solves held in memory
+        int telemetryBinary;        //! Binary records instead of CSV
 };
 
 class GeometricParameters{
     public:
-        GeometricParameters() : deltaSX(2.7), deltaSY(2.7), deltaSZ(2.7) {} // set standard parameters
+        GeometricParameters() : deltaSX(2.7), deltaSY(2.7), deltaSZ(2.7), blockSize(4), refinementLevels(2) {} // set standard parameters
 
         // Dimensions
         int dim;
@@ -68,6 +86,13 @@ class GeometricParameters{
         int stretchX;
         int stretchY;
         int stretchZ;
+        // for block refinement: cells per block and levels, each halving the cell width
+        int blockSize;
+        int refinementLevels;
+        // whether the sweeps skip the cells inside obstacles, whose neighbours are all obstacles
+        int trimSolid;
+        // whether the sweeps treat the runs of fluid cells without obstacle neighbours separately
+        int fluidRuns;
 };
 
 class WallParameters{
@@ -104,6 +129,49 @@ class VTKParameters{
         int active;
 };
 
+enum VtkStreamType{
+    VtkSlice=0,
+    VtkDownsampled=1
+};
+
+class VtkStreamParameters{
+    public:
+        int type;             //! VtkSlice or VtkDownsampled
+        FLOAT interval;       //! Time interval for file printing
+        std::string prefix;   //! Output filename
+        int axis;             //! Slice: normal direction, 0 to 2 for x to z
+        FLOAT position;       //! Slice: coordinate along the normal direction
+        int factor;           //! Downsampled: cells per block and dimension
+        int average;          //! Downsampled: average the blocks instead of taking their first cell
+};
+
+class StatisticsParameters{
+    public:
+        int active;
+        FLOAT startTime;      //! Begin of the averaging window
+        FLOAT endTime;        //! End of the averaging window
+        int average[3];       //! Whether to average along the x-, y- and z-direction (homogeneous directions)
+        std::string prefix;   //! Output filename, without extension
+};
+
+class ProbeParameters{
+    public:
+        int active;
+        FLOAT interval;                     //! Time interval between two samples
+        std::string prefix;                 //! Prefix of the output files
+        std::vector<FLOAT> points;          //! Coordinates of the point probes, three per probe
+        std::vector<FLOAT> lines;           //! Start and end coordinates of the line rakes, six per rake
+        std::vector<int> lineSamples;       //! Number of samples of each line rake
+        std::vector<std::string> lineNames; //! Name of each line rake, part of its file name
+};
+
+class TimerParameters{
+    public:
+        int active;            //! Whether to time the stages of the time steps
+        std::string filename;  //! JSON report written at exit, none if empty
+        int counters;          //! Whether to count hardware events, needs -DPERF_COUNTERS
+};
+
 class StdOutParameters{
     public:
         FLOAT interval;
@@ -118,6 +186,8 @@ class CheckpointParameters{
         std::string directory; //! Directory in which to create checkpoints.
         std::string prefix;    //! Prefix of the checkpoint data to create.
         int cleanDirectory;    //! Option to delete the previous files from the directory.
+        int compress;          //! Option to write compressed keyframes and deltas instead of raw data.
+        int keyframeInterval;  //! Number of checkpoints from one keyframe to the next in case of compress.
 };
 
 class RestartParameters{
@@ -165,21 +235,37 @@ enum MixingLengthModelDeltaType{
     TurbulentFlatPlate=3
 };
 
+enum WallDistanceType{
+    ChannelWallDistance=0,      // normal distance to the walls and the step of the channel
+    EikonalWallDistance=1       // eikonal equation on the flags, for any geometry
+};
+
 class MixingLengthModelParameters{  // example: <mixingLengthModel kappa="0.41">
                                     //            <delta fixedValue="0.001">fixed</delta>
                                     //          </mixingLengthModel>
     public:
-        MixingLengthModelParameters() : deltaValue(0.41) {} // standard parameters
+        MixingLengthModelParameters() : deltaValue(0.41), kappa(0.41) {} // standard parameters
 
         int deltaType;              // type of estimation of boundary layer thickness, 0=ignored, 1=fixed, 2=Blasius or 3=turbulentFlatPlate
         FLOAT deltaValue;           // value of the boundary layer thickness for type "fixed"
         FLOAT kappa;         // defaults to 0.41
 };
 
+class SpalartAllmarasParameters{  // example: <spalartAllmaras inflowRatio="3" />
+    public:
+        FLOAT inflowRatio;          // working variable of the inflow relative to 1/Re, defaults to 3
+};
+
 class TurbulenceModelParameters{
     public:
-        std::string type;     // currently only "mixingLength" supported
+        std::string type;     // "mixingLength" or "spalartAllmaras"
         MixingLengthModelParameters mixingLengthModel;
+        SpalartAllmarasParameters spalartAllmaras;
+        int wallDistance;           // computation of the distance to the nearest wall, a WallDistanceType
+        int updateInterval;         // steps between updates, or checks with a threshold, of the turbulent viscosity
+        FLOAT updateThreshold;      // relative change of the strain rate norm which triggers an update, 0 if disabled
+        int wallFunctions;          // whether the cells next to no-slip global boundaries follow the log law
+        FLOAT logLawIntercept;      // B in u+ = ln(y+)/kappa + B
 };
 
 
@@ -194,12 +280,17 @@ class Parameters {
 
         SimulationParameters    simulation;
         TimestepParameters      timestep;
+        SteadyStateParameters   steady;
         EnvironmentalParameters environment;
         FlowParameters          flow;
         SolverParameters        solver;
         GeometricParameters     geometry;
         WallParameters          walls;
         VTKParameters           vtk;
+        std::vector<VtkStreamParameters> vtkStreams;
+        StatisticsParameters    statistics;
+        ProbeParameters         probes;
+        TimerParameters         timers;
         ParallelParameters      parallel;
         StdOutParameters        stdOut;
         CheckpointParameters    checkpoint;
@@ -0,0 +1,102 @@
+#include "PerfCounters.h"
+
+#ifdef PERF_COUNTERS
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#endif
+
+PerfCounters::PerfCounters () {
+    for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+        _fd[e] = -1;
+    }
+}
+
+
+PerfCounters::~PerfCounters () {
+#ifdef PERF_COUNTERS
+    for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+        if (_fd[e] >= 0) {
+            close(_fd[e]);
+        }
+    }
+#endif
+}
+
+
+const char * PerfCounters::getName ( PerfEvent event ) {
+    static const char * names[NUMBER_OF_PERF_EVENTS] = {
+        "cycles", "instructions", "llcReferences", "llcMisses"
+    };
+    return names[event];
+}
+
+
+#ifdef PERF_COUNTERS
+
+bool PerfCounters::open () {
+    const uint64_t configs[NUMBER_OF_PERF_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES
+    };
+
+    for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[e];
+        attr.disabled = e == 0;     // the group starts with its leader
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // this thread, any CPU
+        _fd[e] = syscall(__NR_perf_event_open, &attr, 0, -1, e == 0 ? -1 : _fd[0], 0);
+        if (_fd[e] < 0) {
+            for (int opened = 0; opened < e; opened++) {
+                close(_fd[opened]);
+                _fd[opened] = -1;
+            }
+            _fd[e] = -1;
+            return false;
+        }
+    }
+    ioctl(_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+
+void PerfCounters::read ( long long values[NUMBER_OF_PERF_EVENTS] ) const {
+    // number of events, time enabled, time running, then the counts in the order of opening
+    uint64_t buffer[3 + NUMBER_OF_PERF_EVENTS];
+    if (_fd[0] < 0 || ::read(_fd[0], buffer, sizeof(buffer)) != (ssize_t) sizeof(buffer)) {
+        for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+            values[e] = 0;
+        }
+        return;
+    }
+    const double scale = buffer[2] > 0 ? (double) buffer[1] / buffer[2] : 1.0;
+    for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+        values[e] = (long long) (buffer[3 + e] * scale);
+    }
+}
+
+#else
+
+bool PerfCounters::open () {
+    return false;
+}
+
+
+void PerfCounters::read ( long long values[NUMBER_OF_PERF_EVENTS] ) const {
+    for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+        values[e] = 0;
+    }
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef _PERF_COUNTERS_H_
+#define _PERF_COUNTERS_H_
+
+/** Hardware events counted around the timer regions */
+enum PerfEvent {
+    PerfCycles=0,
+    PerfInstructions,
+    PerfCacheReferences,    //! Last level cache references
+    PerfCacheMisses,        //! Last level cache misses, each one a cache line from memory
+    NUMBER_OF_PERF_EVENTS
+};
+
+
+/** Hardware performance counters of the calling thread, read through the Linux perf_event_open
+ *  system call. The events form one group, so that a single read returns all of them for the
+ *  same interval; if the kernel multiplexes the group, the counts are scaled by the fraction of
+ *  the time it was scheduled. Only user space is counted, which perf_event_paranoid up to 2
+ *  allows. Without -DPERF_COUNTERS nothing is compiled and open always fails.
+ */
+class PerfCounters {
+    public:
+        PerfCounters ();
+        ~PerfCounters ();
+
+        /** Opens the counters and starts counting. Returns false if the system does not provide
+         *  them, e.g. in a virtual machine without a PMU.
+         */
+        bool open ();
+
+        bool isOpen () const { return _fd[0] >= 0; }
+
+        /** Reads the current counts, which increase monotonically */
+        void read ( long long values[NUMBER_OF_PERF_EVENTS] ) const;
+
+        static const char * getName ( PerfEvent event );
+
+    private:
+        int _fd[NUMBER_OF_PERF_EVENTS];     //! The group leader first, -1 if closed
+};
+
+#endif
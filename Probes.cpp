@@ -0,0 +1,264 @@
+#include "Probes.h"
+#include <iomanip>
+#include <algorithm>
+
+Probes::Probes ( FlowField & flowField, const Parameters & parameters ) :
+  _parameters(parameters),
+  _flowField(flowField),
+  _turbFlowField(parameters.simulation.type == "turbulence" ? (TurbulentFlowField*) &flowField : NULL),
+  _nValues(parameters.geometry.dim + 1 + (parameters.simulation.type == "turbulence" ? 1 : 0)),
+  _nPoints(0)
+{
+    if (!_parameters.probes.active) {
+        return;
+    }
+
+    // expand the point probes and the line rakes into the list of samples
+    const ProbeParameters & probes = _parameters.probes;
+    _nPoints = probes.points.size() / 3;
+    _positions = probes.points;
+    for (unsigned int line = 0; line < probes.lineSamples.size(); line++) {
+        _lineStart.push_back(_positions.size() / 3);
+        const FLOAT * ends = &probes.lines[6*line];
+        const int n = probes.lineSamples[line];
+        for (int s = 0; s < n; s++) {
+            const FLOAT t = n > 1 ? ((FLOAT) s) / (n - 1) : 0.0;
+            for (int d = 0; d < 3; d++) {
+                _positions.push_back(ends[d] + t * (ends[3+d] - ends[d]));
+            }
+        }
+    }
+    const int nSamples = _positions.size() / 3;
+    _lineStart.push_back(nSamples);
+
+    // coordinates of the cell corners, centres and faces of this subdomain for the indices 1 to
+    // localSize+2. The meshes are tensor products, so the coordinates along one dimension do not
+    // depend on the indices of the others.
+    const int dim = _parameters.geometry.dim;
+    Meshsize * ms = _parameters.meshsize;
+    std::vector<FLOAT> corners[3], centres[3], faces[3];
+    for (int d = 0; d < dim; d++) {
+        for (int i = 1; i < _parameters.parallel.localSize[d] + 3; i++) {
+            FLOAT position, width;
+            if (dim == 2) {
+                position = d == 0 ? ms->getPosX(i, 2) : ms->getPosY(2, i);
+                width    = d == 0 ? ms->getDx(i, 2)   : ms->getDy(2, i);
+            } else {
+                position = d == 0 ? ms->getPosX(i, 2, 2) : (d == 1 ? ms->getPosY(2, i, 2) : ms->getPosZ(2, 2, i));
+                width    = d == 0 ? ms->getDx(i, 2, 2)   : (d == 1 ? ms->getDy(2, i, 2)   : ms->getDz(2, 2, i));
+            }
+            corners[d].push_back(position);
+            centres[d].push_back(position + 0.5 * width);
+            faces[d].push_back(position + width);
+        }
+    }
+
+    // each sample belongs to the subdomain containing it, the upper boundary of the domain
+    // belongs to the last subdomain
+    std::vector<int> owners(nSamples, 0);
+    for (int sample = 0; sample < nSamples; sample++) {
+        const FLOAT * position = &_positions[3*sample];
+        ProbeLocation location;
+        location.sample = sample;
+        bool inside = true;
+        for (int d = 0; d < 3; d++) {
+            if (d == dim) {
+                // 2D: the third dimension is never used
+                location.cell[d] = location.centre[d] = location.face[d] = 0;
+                location.centreWeight[d] = location.faceWeight[d] = 0.0;
+                continue;
+            }
+            const int size = _parameters.parallel.localSize[d];
+            const bool last = _parameters.parallel.indices[d] == _parameters.parallel.numProcessors[d] - 1;
+            const FLOAT lower = corners[d][1];
+            const FLOAT upper = corners[d][size + 1];
+            if (position[d] < lower || position[d] > upper || (position[d] == upper && !last)) {
+                inside = false;
+                break;
+            }
+            location.cell[d] = 2;
+            while (location.cell[d] < size + 1 && corners[d][location.cell[d]] <= position[d]) {
+                location.cell[d]++;
+            }
+            locate(position[d], centres[d], location.centre[d], location.centreWeight[d]);
+            locate(position[d], faces[d], location.face[d], location.faceWeight[d]);
+        }
+        if (inside) {
+            _locations.push_back(location);
+            owners[sample] = 1;
+        }
+    }
+
+    std::vector<int> globalOwners(nSamples, 0);
+    if (nSamples > 0) {
+        MPI_Allreduce(&owners[0], &globalOwners[0], nSamples, MPI_INT, MPI_SUM, PETSC_COMM_WORLD);
+    }
+    for (int sample = 0; sample < nSamples; sample++) {
+        if (globalOwners[sample] == 0) {
+            if (_parameters.parallel.rank == 0) {
+                std::cerr << "Probe at " << _positions[3*sample] << ", " << _positions[3*sample+1]
+                          << ", " << _positions[3*sample+2] << " is outside of the domain" << std::endl;
+            }
+            handleError(1, "Probe outside of the domain");
+        }
+    }
+
+    _values.resize(nSamples * _nValues);
+
+    // Rank0 opens the output files and writes their headers
+    if (_parameters.parallel.rank == 0) {
+        _globalValues.resize(nSamples * _nValues);
+        const std::string names = dim == 3 ? "u v w p" : "u v p";
+        const std::string quantities = _turbFlowField != NULL ? names + " nuT" : names;
+
+        if (_nPoints > 0) {
+            std::ofstream * file = new std::ofstream((probes.prefix + "_points.dat").c_str());
+            *file << "# NS-EOF point probes" << std::endl;
+            for (int point = 0; point < _nPoints; point++) {
+                *file << "# probe " << point << ": " << _positions[3*point] << " " << _positions[3*point+1];
+                if (dim == 3) {
+                    *file << " " << _positions[3*point+2];
+                }
+                *file << std::endl;
+            }
+            *file << "# t, then " << quantities << " of each probe" << std::endl;
+            _files.push_back(file);
+        }
+        for (unsigned int line = 0; line < probes.lineNames.size(); line++) {
+            std::ofstream * file = new std::ofstream((probes.prefix + "_" + probes.lineNames[line] + ".dat").c_str());
+            *file << "# NS-EOF line rake " << probes.lineNames[line] << ", "
+                  << _lineStart[line+1] - _lineStart[line] << " samples per block" << std::endl;
+            *file << (dim == 3 ? "# x y z " : "# x y ") << quantities << std::endl;
+            _files.push_back(file);
+        }
+        for (unsigned int f = 0; f < _files.size(); f++) {
+            if (!_files[f]->is_open()) {
+                handleError(1, "Cannot open the output files of the probes");
+            }
+            *_files[f] << std::setprecision(8);
+        }
+    }
+}
+
+Probes::~Probes () {
+    for (unsigned int f = 0; f < _files.size(); f++) {
+        _files[f]->close();
+        delete _files[f];
+    }
+}
+
+
+void Probes::locate ( FLOAT coordinate, const std::vector<FLOAT> & grid, int & index, FLOAT & weight ) {
+    // grid[n] is the coordinate at index n+1
+    int n = 0;
+    while (n < (int) grid.size() - 2 && grid[n+1] <= coordinate) {
+        n++;
+    }
+    index = n + 1;
+    weight = (coordinate - grid[n]) / (grid[n+1] - grid[n]);
+    weight = std::min((FLOAT) 1.0, std::max((FLOAT) 0.0, weight));
+}
+
+
+FLOAT Probes::interpolate ( const ProbeLocation & location, int quantity ) {
+    const int dim = _parameters.geometry.dim;
+
+    // the velocity component along a dimension is stored on the faces, everything else at the
+    // cell centres
+    int index[3];
+    FLOAT weight[3];
+    for (int d = 0; d < 3; d++) {
+        index[d]  = d == quantity ? location.face[d] : location.centre[d];
+        weight[d] = d == quantity ? location.faceWeight[d] : location.centreWeight[d];
+    }
+
+    FLOAT value = 0.0;
+    const int corners = dim == 3 ? 8 : 4;
+    for (int corner = 0; corner < corners; corner++) {
+        const int di = corner & 1, dj = (corner >> 1) & 1, dk = (corner >> 2) & 1;
+        const FLOAT w = (di ? weight[0] : 1.0 - weight[0]) * (dj ? weight[1] : 1.0 - weight[1])
+                      * (dim == 3 ? (dk ? weight[2] : 1.0 - weight[2]) : 1.0);
+        const int i = index[0] + di, j = index[1] + dj, k = index[2] + dk;
+
+        FLOAT cornerValue;
+        if (quantity < 3) {
+            cornerValue = (dim == 3 ? _flowField.getVelocity().getVector(i, j, k)
+                                     : _flowField.getVelocity().getVector(i, j))[quantity];
+        } else if (quantity == 3) {
+            cornerValue = dim == 3 ? _flowField.getPressure().getScalar(i, j, k)
+                                    : _flowField.getPressure().getScalar(i, j);
+        } else {
+            cornerValue = dim == 3 ? _turbFlowField->getTurbViscosity().getScalar(i, j, k)
+                                    : _turbFlowField->getTurbViscosity().getScalar(i, j);
+        }
+        value += w * cornerValue;
+    }
+    return value;
+}
+
+
+void Probes::writeSample ( std::ostream & file, int sample ) const {
+    const FLOAT * values = &_globalValues[_nValues * sample];
+    for (int q = 0; q < _nValues; q++) {
+        file << " " << values[q];
+    }
+}
+
+
+void Probes::sample ( FLOAT time ) {
+    const int dim = _parameters.geometry.dim;
+    std::fill(_values.begin(), _values.end(), 0.0);
+
+    for (unsigned int l = 0; l < _locations.size(); l++) {
+        const ProbeLocation & location = _locations[l];
+        const int obstacle = dim == 3
+            ? _flowField.getFlags().getValue(location.cell[0], location.cell[1], location.cell[2])
+            : _flowField.getFlags().getValue(location.cell[0], location.cell[1]);
+        if ((obstacle & OBSTACLE_SELF) != 0) {
+            continue;
+        }
+
+        // velocity components, pressure and turbulent viscosity
+        FLOAT * values = &_values[_nValues * location.sample];
+        for (int d = 0; d < dim; d++) {
+            values[d] = interpolate(location, d);
+        }
+        values[dim] = interpolate(location, 3);
+        if (_turbFlowField != NULL) {
+            values[dim+1] = interpolate(location, 4);
+        }
+    }
+
+    if (_values.empty()) {
+        return;
+    }
+    MPI_Reduce(&_values[0], _parameters.parallel.rank == 0 ? &_globalValues[0] : NULL,
+               _values.size(), MY_MPI_FLOAT, MPI_SUM, 0, PETSC_COMM_WORLD);
+    if (_parameters.parallel.rank != 0) {
+        return;
+    }
+
+    int f = 0;
+    if (_nPoints > 0) {
+        std::ostream & file = *_files[f++];
+        file << time;
+        for (int point = 0; point < _nPoints; point++) {
+            writeSample(file, point);
+        }
+        file << std::endl;
+    }
+    for (unsigned int line = 0; line + 1 < _lineStart.size(); line++) {
+        std::ostream & file = *_files[f++];
+        file << "\n# t = " << time << "\n";
+        for (int sample = _lineStart[line]; sample < _lineStart[line+1]; sample++) {
+            const FLOAT * position = &_positions[3*sample];
+            file << position[0] << " " << position[1];
+            if (dim == 3) {
+                file << " " << position[2];
+            }
+            writeSample(file, sample);
+            file << "\n";
+        }
+        file.flush();
+    }
+}
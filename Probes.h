@@ -0,0 +1,84 @@
+#ifndef _PROBES_H_
+#define _PROBES_H_
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "FlowField.h"
+#include "TurbulentFlowField.h"
+#include <string>
+#include <vector>
+#include <fstream>
+
+/** Position of a probe in the local subdomain. For each dimension, it holds the lower index and
+ *  the weight of the upper neighbour for the interpolation between cell centres (pressure,
+ *  turbulent viscosity and the velocity components normal to this dimension) and between cell
+ *  faces (velocity component along this dimension).
+ */
+struct ProbeLocation {
+    int sample;             //! Index of the probe among all samples
+    int cell[3];            //! Local cell containing the probe
+    int centre[3];
+    FLOAT centreWeight[3];
+    int face[3];
+    FLOAT faceWeight[3];
+};
+
+/** Point probes and line rakes
+ *
+ * The probes are given in physical coordinates. Each rank maps the probes inside its subdomain to
+ * the local cells through the positions of the Meshsize, and interpolates the velocity, the
+ * pressure and the turbulent viscosity (tri)linearly on the staggered grid, using the ghost layers
+ * at the subdomain boundaries. The samples are reduced to Rank0, which appends them to the output
+ * files: prefix_points.dat holds the time series of all point probes, one line per sample time,
+ * and prefix_<name>.dat the profiles of each line rake, one block per sample time.
+ * Probes inside obstacles yield zeros.
+ */
+class Probes {
+    private:
+
+        const Parameters & _parameters;
+        FlowField & _flowField;
+        TurbulentFlowField * _turbFlowField;    //! NULL in DNS
+
+        const int _nValues;         //! Values per sample: velocity, pressure and nu_t if turbulent
+        int _nPoints;               //! Number of point probes
+        std::vector<int> _lineStart;    //! First sample of each line rake, followed by the total
+
+        std::vector<FLOAT> _positions;  //! Coordinates of all samples, three per sample
+        std::vector<ProbeLocation> _locations;  //! Samples in this subdomain
+
+        std::vector<FLOAT> _values;         //! Local values of all samples
+        std::vector<FLOAT> _globalValues;   //! Reduced values, Rank0 only
+
+        std::vector<std::ofstream*> _files; //! Points first, then one per line rake; Rank0 only
+
+        /** Finds the interval of a 1D grid containing the coordinate and the linear weight of its
+         *  upper end. The grid is given by its coordinates at the indices 1 to size+2.
+         */
+        static void locate ( FLOAT coordinate, const std::vector<FLOAT> & grid, int & index, FLOAT & weight );
+
+        /** Interpolates a quantity (0-2 velocity, 3 pressure, 4 turbulent viscosity) */
+        FLOAT interpolate ( const ProbeLocation & location, int quantity );
+
+        /** Writes the coordinates and the values of a sample */
+        void writeSample ( std::ostream & file, int sample ) const;
+
+    public:
+
+        /** Constructor. Locates the probes in the subdomains and opens the output files
+         *
+         * @param flowField Flow field, a TurbulentFlowField for turbulent simulations
+         * @param parameters Parameters of the problem
+         */
+        Probes ( FlowField & flowField, const Parameters & parameters );
+
+        ~Probes ();
+
+        /** Samples all probes and appends the values to the output files
+         *
+         * @param time Current time
+         */
+        void sample ( FLOAT time );
+};
+
+#endif
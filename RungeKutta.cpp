@@ -0,0 +1,44 @@
+#include "RungeKutta.h"
+
+// Coefficients of the explicit terms of the current and of the previous stage
+static const FLOAT currentCoefficients[RungeKutta::STAGES] = {8.0/15.0, 5.0/12.0, 3.0/4.0};
+static const FLOAT previousCoefficients[RungeKutta::STAGES] = {0.0, -17.0/60.0, -5.0/12.0};
+
+
+RungeKutta::RungeKutta ( FlowField & flowField, const Parameters & parameters ) :
+  _parameters(parameters),
+  _flowField(flowField),
+  _previous(!parameters.timestep.rungeKutta ? VectorField(0, 0) :
+            parameters.geometry.dim == 2 ? VectorField(flowField.getCellsX(), flowField.getCellsY()) :
+            VectorField(flowField.getCellsX(), flowField.getCellsY(), flowField.getCellsZ()))
+{}
+
+
+void RungeKutta::combine ( int stage ) {
+    const int dim = _parameters.geometry.dim;
+    const int cellsX = _flowField.getCellsX(), cellsY = _flowField.getCellsY();
+    const int cellsZ = dim == 3 ? _flowField.getCellsZ() : 1;
+    const FLOAT dt = _parameters.timestep.dt;
+    VectorField & velocity = _flowField.getVelocity();
+    VectorField & fgh = _flowField.getFGH();
+
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < cellsY; j++) {
+            for (int i = 0; i < cellsX; i++) {
+                const FLOAT * u = velocity.getVector(i, j, k);
+                FLOAT * f = fgh.getVector(i, j, k);
+                FLOAT * previous = _previous.getVector(i, j, k);
+                for (int c = 0; c < dim; c++) {
+                    const FLOAT explicitTerms = (f[c] - u[c]) / dt;
+                    f[c] = u[c] + dt * (currentCoefficients[stage] * explicitTerms + previousCoefficients[stage] * previous[c]);
+                    previous[c] = explicitTerms;
+                }
+            }
+        }
+    }
+}
+
+
+FLOAT RungeKutta::getStageFraction ( int stage ) {
+    return currentCoefficients[stage] + previousCoefficients[stage];
+}
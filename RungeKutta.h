@@ -0,0 +1,46 @@
+#ifndef _RUNGE_KUTTA_H_
+#define _RUNGE_KUTTA_H_
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "FlowField.h"
+
+/** Low-storage three-stage Runge-Kutta scheme of Spalart, Moser and Rogers for the projection.
+ *
+ * Each stage k computes the explicit terms H = (FGH - u)/dt with the FGH stencils and replaces FGH
+ * by u + dt*(gamma_k H + zeta_k H_{k-1}); the pressure solve and the velocity update of the stage
+ * then use the step alpha_k dt = (gamma_k + zeta_k) dt. Only the explicit terms of the previous
+ * stage are stored. The first stage does not use them, so nothing has to be kept across time
+ * steps or checkpoints. The stability region covers the imaginary axis up to sqrt(3), so that the
+ * convective limit allows a larger tau than explicit Euler.
+ */
+class RungeKutta {
+    private:
+
+        const Parameters & _parameters;
+        FlowField & _flowField;
+        VectorField _previous;  //! Explicit terms of the previous stage, empty for explicit Euler
+
+    public:
+
+        static const int STAGES = 3;
+
+        /** Constructor
+         *
+         * @param flowField Flow field
+         * @param parameters Parameters of the problem
+         */
+        RungeKutta ( FlowField & flowField, const Parameters & parameters );
+
+        /** Combines the FGH computed with the step parameters.timestep.dt from the velocity at the
+         *  beginning of the stage with the explicit terms of the previous stage
+         */
+        void combine ( int stage );
+
+        /** Fraction alpha_k of the time step covered by the stage, used by the pressure solve and
+         *  the velocity update
+         */
+        static FLOAT getStageFraction ( int stage );
+};
+
+#endif
@@ -15,19 +15,26 @@
 #include "stencils/NeumannBoundaryStencils.h"
 #include "stencils/BFInputStencils.h"
 #include "stencils/InitTaylorGreenFlowFieldStencil.h"
+#include "ImplicitViscosity.h"
+#include "RungeKutta.h"
+#include "SteadyState.h"
 #include "GlobalBoundaryFactory.h"
 #include "Iterators.h"
 #include "Definitions.h"
 #include "VtkOutput.h"
+#include "VtkStreams.h"
+#include "Statistics.h"
+#include "Probes.h"
 #include "Checkpoint.h"
 
 #include "LinearSolver.h"
 #include "solvers/SORSolver.h"
 #include "solvers/PetscSolver.h"
+#include "SolverTelemetry.h"
 
 #include "parallelManagers/PetscParallelManager.h"
 
-#include "SimpleTimer.h"
+#include "Timers.h"
 
 class Simulation {
   protected:
@@ -55,45 +62,69 @@ class Simulation {
     FieldIterator<FlowField> _velocityIterator;
     FieldIterator<FlowField> _obstacleIterator;
 
+    ImplicitViscosity _implicitViscosity;
+    RungeKutta _rungeKutta;
+    SteadyState _steadyState;
+
     VtkOutput _vtkOutput;
+    std::vector<VtkStream*> _vtkStreams;
 
-    Checkpoint _checkpoint;
+    Statistics _statistics;
+
+    Probes _probes;
 
     PetscSolver _solver;
 
-    PetscParallelManager _petscParallelManager;
+    SolverTelemetry _solverTelemetry;
+    std::vector<SolveRecord> _stepSolves;   //! Pressure solves since the last record
 
-    SimpleTimer _timer_solve;
-    SimpleTimer _timer_comm;
+    Checkpoint _checkpoint;
+
+    PetscParallelManager _petscParallelManager;
 
   public:
     Simulation(Parameters &parameters, FlowField &flowField):
        _parameters(parameters),
        _flowField(flowField),
        _maxUStencil(parameters),
-       _maxUFieldIterator(_flowField,parameters,_maxUStencil),
+       _maxUFieldIterator(_flowField,parameters,_maxUStencil,0,0,true),
        _maxUBoundaryIterator(_flowField,parameters,_maxUStencil),
        _globalBoundaryFactory(parameters),
        _wallVelocityIterator(_globalBoundaryFactory.getGlobalBoundaryVelocityIterator(_flowField)),
        _wallFGHIterator(_globalBoundaryFactory.getGlobalBoundaryFGHIterator(_flowField)),
        _fghStencil(parameters),
-       _fghIterator(_flowField,parameters,_fghStencil),
+       _fghIterator(_flowField,parameters,_fghStencil,0,0,true),
        _rhsStencil(parameters),
-       _rhsIterator(_flowField,parameters,_rhsStencil),
+       _rhsIterator(_flowField,parameters,_rhsStencil,0,0,true),
        _velocityStencil(parameters),
        _obstacleStencil(parameters),
-       _velocityIterator(_flowField,parameters,_velocityStencil),
-       _obstacleIterator(_flowField,parameters,_obstacleStencil),
+       _velocityIterator(_flowField,parameters,_velocityStencil,0,0,true),
+       _obstacleIterator(_flowField,parameters,_obstacleStencil,0,0,true),
+       _implicitViscosity(_flowField,parameters),
+       _rungeKutta(_flowField,parameters),
+       _steadyState(_flowField,parameters),
        _vtkOutput(_flowField,parameters),
-       _checkpoint(_flowField, parameters),
+       _statistics(_flowField,parameters),
+       _probes(_flowField,parameters),
        _solver(_flowField,parameters),
-       _petscParallelManager(parameters, _flowField),
-       _timer_solve(),
-       _timer_comm()
+       _solverTelemetry(parameters),
+       _checkpoint(_flowField, parameters, _solver),
+       _petscParallelManager(parameters, _flowField)
        {
+         for (unsigned int s = 0; s < parameters.vtkStreams.size(); s++) {
+           _vtkStreams.push_back(createVtkStream(_flowField, parameters, parameters.vtkStreams[s]));
+         }
+         // the pressure equation of the local steps
+         if (parameters.steady.active) {
+           _solver.setFaceWeights(&_steadyState.getWeights());
+         }
        }
 
-    virtual ~Simulation(){}
+    virtual ~Simulation(){
+      for (unsigned int s = 0; s < _vtkStreams.size(); s++) {
+        delete _vtkStreams[s];
+      }
+    }
 
     /** initialises the flow field according to the scenario */
     virtual void initializeFlowField(){
@@ -106,91 +137,115 @@ class Simulation {
         BFStepInitStencil stencil(_parameters);
         FieldIterator<FlowField> iterator(_flowField,_parameters,stencil,0,1);
         iterator.iterate();
-        _wallVelocityIterator.iterate();
       } else if (_parameters.simulation.scenario=="pressure-channel"){
-        //set pressure boundaries here for left wall
-        const FLOAT value = _parameters.walls.scalarLeft;
-        ScalarField& rhs = _flowField.getRHS();
-
-        if (_parameters.geometry.dim==2){
-          const int sizey = _flowField.getNy();
-          for (int i =0 ;i < sizey+3;i++) {
-            rhs.getScalar(0,i) = value;
-          }
-        } else {
-          const int sizey = _flowField.getNy();
-          const int sizez = _flowField.getNz();
-          for (int i=0;i<sizey+3;i++)
-            for(int j=0;j<sizez + 3;j++)
-              rhs.getScalar(0,i,j) =value;
-	    }
+        initializePressureBoundary();
 
 	    // do same procedure for domain flagging as for regular channel
 	    BFStepInitStencil stencil(_parameters);
         FieldIterator<FlowField> iterator(_flowField,_parameters,stencil,0,1);
         iterator.iterate();
 	    }
-      _solver.reInitMatrix();
+      // ghost layers and boundary values of the initial state, which the first FGH reads; otherwise
+      // the first step sees the boundary values of the second one, an error of first order in dt
+      _petscParallelManager.communicateVelocities();
+      _wallVelocityIterator.iterate();
+      reInitGeometry();
     }
 
-    virtual void solveTimestep(FLOAT &_time_solve, FLOAT &_time_comm){
+    virtual void solveTimestep(){
         // determine and set max. timestep which is allowed in this simulation
         setTimeStep();
 
-        // compute fgh
-        _fghIterator.iterate();
-        // set global boundary values
-        _wallFGHIterator.iterate();
-        // compute the right hand side
-        _rhsIterator.iterate();
+        advance();
+    }
 
-        _timer_solve.start();
-        // solve for pressure
-        _solver.solve();
+    /** WS1: plots the flow field. */
+    virtual void plotVTK(int timeStep, FLOAT time){
+        // WS1: create VTKStencil and respective iterator; iterate stencil
+        //           over _flowField and write flow field information to vtk file
+        ScopedTimer timer(TimerVtk);
+        _vtkOutput.write(timeStep, time);
+    }
 
-        // Use this version to get the time of each call to the solver. Not polished.
-        // FLOAT _time_solve_it = _timer_fgh.getTimeAndContinue();
-        // printf("Time to solution: %f s.\n", _time_solve_it);
-        // _time_solve += _time_solve_it;
-        // Use this version to just increment the timer.
-        _time_solve += _timer_solve.getTimeAndContinue();
+    /** continues the collection files of the run restarted from, which ends at the given time */
+    virtual void continueVtk(FLOAT time){
+        _vtkOutput.continueCollection(time);
+        for (unsigned int s = 0; s < _vtkStreams.size(); s++) {
+          _vtkStreams[s]->continueCollection(time);
+        }
+    }
 
-        _timer_comm.start();
-        // WS2: communicate pressure values
-        // printf("Communicating pressure... (rank %d)\n", _parameters.parallel.rank);
-        _petscParallelManager.communicatePressure();
-        // printf("Communicated pressure!(rank %d)\n", _parameters.parallel.rank);
-        _time_comm += _timer_comm.getTimeAndContinue();
+    /** Writes a snapshot of the slice or downsampled VTK stream with the given index */
+    virtual void plotVtkStream(int stream, int timeStep, FLOAT time){
+        ScopedTimer timer(TimerVtk);
+        _vtkStreams[stream]->write(timeStep, time);
+    }
 
-        // compute velocity
-        _velocityIterator.iterate();
-        // set obstacle boundaries
-        _obstacleIterator.iterate();
+    /** Samples the point probes and line rakes */
+    virtual void sampleProbes(FLOAT time){
+        ScopedTimer timer(TimerProbes);
+        _probes.sample(time);
+    }
 
-        _timer_comm.start();
-        // WS2: communicate velocity values
-        // printf("Communicating velocity... (rank %d)\n", _parameters.parallel.rank);
-        _petscParallelManager.communicateVelocities();
-        // printf("Communicated velocity! (rank %d)\n", _parameters.parallel.rank);
-        _time_comm += _timer_comm.getTimeAndContinue();
+    /** Adds the state after a time step to the time-averaged statistics */
+    virtual void sampleStatistics(FLOAT time, FLOAT dt){
+        ScopedTimer timer(TimerStatistics);
+        _statistics.sample(time, dt);
+    }
 
-        // Iterate for velocities on the boundary
-        _wallVelocityIterator.iterate();
+    /** Writes the time-averaged statistics */
+    virtual void writeStatistics(){
+        ScopedTimer timer(TimerStatistics);
+        _statistics.write();
     }
 
-    /** WS1: plots the flow field. */
-    virtual void plotVTK(int timeStep){
-        // WS1: create VTKStencil and respective iterator; iterate stencil
-        //           over _flowField and write flow field information to vtk file
-        _vtkOutput.write(timeStep);
+    /** Adds the pressure solves of the time step, one per Runge-Kutta stage, to the solver telemetry */
+    virtual void recordSolverTelemetry(int timeStep, FLOAT time){
+        for (unsigned int s = 0; s < _stepSolves.size(); s++) {
+          _solverTelemetry.record(timeStep, time, _stepSolves[s]);
+        }
+        _stepSolves.clear();
+    }
+
+    /** Checks the residual and divergence norms of the steady-state mode against the tolerances */
+    virtual bool isConverged(){
+        ScopedTimer timer(TimerConvergence);
+        return _steadyState.isConverged();
+    }
+
+    /** Local time stepping of the steady-state mode, holding the norms of the last check */
+    const SteadyState & getSteadyState() const {
+        return _steadyState;
     }
 
+    /** Writes the remaining solver telemetry and prints its summary */
+    virtual void writeSolverTelemetry(){
+        _solverTelemetry.printSummary();
+    }
+
+    /** Reports how often the turbulent viscosity has been updated; the DNS has none */
+    virtual void printTurbViscUpdates(FLOAT loopTime){}
+
     virtual void createCheckpoint(int timeStep, FLOAT time){
+        ScopedTimer timer(TimerCheckpoint);
         _checkpoint.create(timeStep, time);
     }
     
+    /** Checks whether the restart file holds the complete state of this simulation. Then,
+     *  initializeFlowField does not need to be called before readCheckpoint. */
+    virtual bool isCheckpointComplete(){
+        return _checkpoint.isComplete();
+    }
+
     virtual void readCheckpoint(int& timeStep, FLOAT& time){
-        _checkpoint.read(timeStep, time);
+        if (_checkpoint.read(timeStep, time)) {
+          // the flags come from the checkpoint, only the boundary values of the right hand side
+          // are not part of it
+          if (_parameters.simulation.scenario=="pressure-channel"){
+            initializePressureBoundary();
+          }
+          reInitGeometry();
+        }
         _petscParallelManager.communicatePressure();
         _petscParallelManager.communicateVelocities();
         _wallVelocityIterator.iterate();
@@ -201,8 +256,153 @@ class Simulation {
     }
 
   protected:
+    /** computes FGH from the current velocity */
+    virtual void computeFGH(){
+        _fghIterator.iterate();
+    }
+
+    /** advances the flow field by the time step parameters.timestep.dt, which has been set */
+    void advance(){
+        if (!_parameters.timestep.rungeKutta) {
+          project(-1);
+          return;
+        }
+        // every stage is a projection from the velocity of the previous one; the full time step is
+        // restored for the time loop
+        const FLOAT dt = _parameters.timestep.dt;
+        for (int stage = 0; stage < RungeKutta::STAGES; stage++) {
+          project(stage);
+          _parameters.timestep.dt = dt;
+        }
+    }
+
+    /** one projection step: FGH, pressure and velocity update. The stage of the Runge-Kutta
+     *  scheme, or -1 for explicit Euler */
+    void project(int stage){
+        // compute fgh
+        {
+          ScopedTimer timer(TimerFGH);
+          computeFGH();
+        }
+        if (_parameters.steady.active) {
+          // local steps of the pseudo-time, carried by the weights of the pressure equation
+          ScopedTimer timer(TimerFGH);
+          _steadyState.combine();
+        }
+        // set global boundary values
+        {
+          ScopedTimer timer(TimerWallBoundaries);
+          _wallFGHIterator.iterate();
+        }
+        if (stage >= 0) {
+          // combine with the previous stage; pressure and velocity update with the step of the stage
+          ScopedTimer timer(TimerFGH);
+          _rungeKutta.combine(stage);
+          _parameters.timestep.dt *= RungeKutta::getStageFraction(stage);
+        } else if (_parameters.timestep.implicitViscosity) {
+          // viscous terms implicit
+          ScopedTimer timer(TimerViscous);
+          _implicitViscosity.apply();
+        }
+        // compute the right hand side
+        {
+          ScopedTimer timer(TimerRHS);
+          _rhsIterator.iterate();
+        }
+
+        // solve for pressure
+        solvePressure();
+
+        // WS2: communicate pressure values
+        {
+          ScopedTimer timer(TimerPressureComm);
+          _petscParallelManager.communicatePressure();
+        }
+
+        // compute velocity
+        {
+          ScopedTimer timer(TimerVelocity);
+          _velocityIterator.iterate();
+        }
+        if (_parameters.steady.active) {
+          ScopedTimer timer(TimerVelocity);
+          _steadyState.correctVelocity();
+        }
+        // set obstacle boundaries
+        {
+          ScopedTimer timer(TimerObstacle);
+          _obstacleIterator.iterate();
+        }
+
+        // WS2: communicate velocity values
+        {
+          ScopedTimer timer(TimerVelocityComm);
+          _petscParallelManager.communicateVelocities();
+        }
+
+        // Iterate for velocities on the boundary
+        {
+          ScopedTimer timer(TimerWallBoundaries);
+          _wallVelocityIterator.iterate();
+        }
+    }
+
+    /** solves the pressure Poisson equation and records the solver iterations */
+    void solvePressure(){
+        ScopedTimer timer(TimerSolve);
+        const int iterations = _solver.getIterations();
+        _solver.solve();
+        if (_parameters.solver.telemetry) {
+          _stepSolves.push_back(_solver.getLastSolve());
+        }
+        TimerRegistry::getInstance().addWork(TimerSolve, _solver.getIterations() - iterations);
+    }
+
+    /** rebuilds what is derived from the flags once they are set or have changed: the fluid
+     *  intervals and runs of the sweeps and the pressure matrix */
+    void reInitGeometry(){
+      if (_parameters.geometry.trimSolid){
+        _flowField.computeFluidIntervals(_parameters.geometry.dim);
+      }
+      if (_parameters.geometry.fluidRuns){
+        _flowField.computeFluidRuns(_parameters.geometry.dim);
+      }
+      _solver.reInitMatrix();
+    }
+
+    /** sets the pressure value at the left wall for the pressure-driven channel */
+    void initializePressureBoundary(){
+      const FLOAT value = _parameters.walls.scalarLeft;
+      ScalarField& rhs = _flowField.getRHS();
+
+      if (_parameters.geometry.dim==2){
+        const int sizey = _flowField.getNy();
+        for (int i =0 ;i < sizey+3;i++) {
+          rhs.getScalar(0,i) = value;
+        }
+      } else {
+        const int sizey = _flowField.getNy();
+        const int sizez = _flowField.getNz();
+        for (int i=0;i<sizey+3;i++)
+          for(int j=0;j<sizez + 3;j++)
+            rhs.getScalar(0,i,j) =value;
+      }
+    }
+
     /** sets the time step*/
     virtual void setTimeStep(){
+      ScopedTimer timer(TimerSetTimeStep);
+
+      // the dt of the configuration, e.g. for studies of the time discretisation error
+      if (_parameters.timestep.fixedDt) {
+        _parameters.timestep.dt = _parameters.timestep.maxDt;
+        return;
+      }
+      // the global step of the pseudo-time, the local ones are kept by the steady state
+      if (_parameters.steady.active) {
+        _parameters.timestep.dt = _steadyState.computeTimeSteps();
+        return;
+      }
 
       FLOAT localMin, globalMin;
       assertion(_parameters.geometry.dim == 2 || _parameters.geometry.dim == 3);
@@ -220,8 +420,11 @@ class Simulation {
         _parameters.timestep.dt = 1.0 / _maxUStencil.getMaxValues()[0];
       }
 
+      // no diffusive limit if the viscous terms are implicit, only the one of the configuration
+      const FLOAT viscousLimit = _parameters.timestep.implicitViscosity ? _parameters.timestep.maxDt :
+                                                                         _parameters.flow.Re/(2*factor);
       localMin = std::min(_parameters.timestep.dt,
-                                        std::min(std::min(_parameters.flow.Re/(2*factor),
+                                        std::min(std::min(viscousLimit,
                                         1.0 / _maxUStencil.getMaxValues()[0]),
                                         1.0 / _maxUStencil.getMaxValues()[1]));
 
@@ -0,0 +1,103 @@
+#include "SolverTelemetry.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+SolverTelemetry::SolverTelemetry ( const Parameters & parameters ) :
+    _parameters(parameters),
+    _rank(parameters.parallel.rank),
+    _ring(std::max(parameters.solver.telemetryCapacity, 1)),
+    _next(0), _pending(0),
+    _interval(std::min(std::max(parameters.solver.telemetryInterval, 1), (int) _ring.size())),
+    _solves(0), _iterations(0), _minIterations(0), _maxIterations(0), _failures(0),
+    _setupTime(0.0), _solveTime(0.0), _logReduction(0.0) {
+
+    if (_rank != 0 || !parameters.solver.telemetry || parameters.solver.telemetryFile == "") {
+        return;
+    }
+    if (parameters.solver.telemetryBinary) {
+        _file.open(parameters.solver.telemetryFile.c_str(), std::ios::out | std::ios::binary);
+        if (!_file) {
+            handleError(1, "Cannot open the solver telemetry file");
+        }
+        const int floatSize = sizeof(FLOAT);
+        _file.write("NSSOLVE1", 8);
+        _file.write((const char *) &floatSize, sizeof(int));
+    } else {
+        _file.open(parameters.solver.telemetryFile.c_str());
+        if (!_file) {
+            handleError(1, "Cannot open the solver telemetry file");
+        }
+        _file << "timeStep,iterations,converged,time,dt,initialResidual,finalResidual,setupTime,solveTime\n";
+    }
+}
+
+
+void SolverTelemetry::record ( int timeStep, FLOAT time, const SolveRecord & solve ) {
+    SolverTelemetryRecord & record = _ring[_next];
+    record.timeStep = timeStep;
+    record.time = time;
+    record.dt = _parameters.timestep.dt;
+    record.solve = solve;
+    _next = (_next + 1) % _ring.size();
+    _pending++;
+
+    _minIterations = _solves == 0 ? solve.iterations : std::min(_minIterations, solve.iterations);
+    _maxIterations = std::max(_maxIterations, solve.iterations);
+    _solves++;
+    _iterations += solve.iterations;
+    _failures += solve.converged > 0 ? 0 : 1;
+    _setupTime += solve.setupTime;
+    _solveTime += solve.solveTime;
+    if (solve.initialResidual > 0.0 && solve.finalResidual > 0.0) {
+        _logReduction += log10(solve.initialResidual / solve.finalResidual);
+    }
+
+    if (_pending >= _interval) {
+        flush();
+    }
+}
+
+
+void SolverTelemetry::write ( const SolverTelemetryRecord & record ) {
+    const SolveRecord & solve = record.solve;
+    if (_parameters.solver.telemetryBinary) {
+        const int ints[3] = {record.timeStep, solve.iterations, solve.converged};
+        const FLOAT floats[4] = {record.time, record.dt, solve.initialResidual, solve.finalResidual};
+        const double times[2] = {solve.setupTime, solve.solveTime};
+        _file.write((const char *) ints, sizeof(ints));
+        _file.write((const char *) floats, sizeof(floats));
+        _file.write((const char *) times, sizeof(times));
+    } else {
+        char line[256];
+        snprintf(line, sizeof(line), "%d,%d,%d,%.10g,%.6e,%.6e,%.6e,%.6e,%.6e\n", record.timeStep,
+                 solve.iterations, solve.converged, (double) record.time, (double) record.dt,
+                 (double) solve.initialResidual, (double) solve.finalResidual, solve.setupTime,
+                 solve.solveTime);
+        _file << line;
+    }
+}
+
+
+void SolverTelemetry::flush () {
+    if (_file.is_open()) {
+        const int size = _ring.size();
+        for (int r = _pending; r > 0; r--) {
+            write(_ring[(_next - r + size) % size]);
+        }
+        _file.flush();
+    }
+    _pending = 0;
+}
+
+
+void SolverTelemetry::printSummary () {
+    flush();
+    if (_rank != 0 || _solves == 0) {
+        return;
+    }
+    printf("Linear solver: %ld solves, iterations min %d / avg %.1f / max %d, %d not converged\n",
+           _solves, _minIterations, (double) _iterations / _solves, _maxIterations, _failures);
+    printf("Linear solver: average residual reduction 1e-%.2f, setup %f s, iterations %f s\n",
+           _logReduction / _solves, _setupTime, _solveTime);
+}
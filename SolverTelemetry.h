@@ -0,0 +1,77 @@
+#ifndef _SOLVER_TELEMETRY_H_
+#define _SOLVER_TELEMETRY_H_
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "LinearSolver.h"
+#include <string>
+#include <vector>
+#include <fstream>
+
+//! A solve together with the time step it belongs to
+struct SolverTelemetryRecord {
+    int timeStep;
+    FLOAT time;
+    FLOAT dt;
+    SolveRecord solve;
+};
+
+/** Records the statistics of each pressure solve in a ring held in memory.
+ *
+ * The pending records are appended to the output file every parameters.solver.telemetryInterval
+ * time steps, and at the latest when the ring is full, so that no record is lost. The CSV file
+ * has one line per solve; the binary file starts with the magic "NSSOLVE1" and the size of FLOAT
+ * as int, followed by the records with the fields in the order of the CSV columns (three int
+ * fields first: timeStep, iterations, converged; then time, dt, initial and final residual as
+ * FLOAT; then setup and solve time as double). Totals over all solves of the run are kept for the
+ * summary. All values are global except for the times, so only Rank0 writes.
+ */
+class SolverTelemetry {
+    private:
+        const Parameters & _parameters;
+        int _rank;
+
+        std::vector<SolverTelemetryRecord> _ring;
+        int _next;      //! Index of the next record in the ring
+        int _pending;   //! Records not written yet, the last ones before _next
+        int _interval;  //! Time steps between two writes, at most the capacity of the ring
+
+        std::ofstream _file;    //! Rank0 only, if a file is given
+
+        // Totals of the run
+        long _solves;
+        long _iterations;
+        int _minIterations;
+        int _maxIterations;
+        int _failures;          //! Solves which did not converge
+        double _setupTime;
+        double _solveTime;
+        double _logReduction;   //! Sum of log10(initial/final residual) over the solves
+
+        /** Writes a record in the format of the file */
+        void write ( const SolverTelemetryRecord & record );
+
+    public:
+
+        /** Constructor. Opens the output file, if any
+         *
+         * @param parameters Parameters of the problem
+         */
+        SolverTelemetry ( const Parameters & parameters );
+
+        /** Adds the last solve of the time step to the ring
+         *
+         * @param timeStep Number of the time step
+         * @param time Time at the end of the time step
+         * @param solve Statistics of the solve
+         */
+        void record ( int timeStep, FLOAT time, const SolveRecord & solve );
+
+        /** Writes the pending records */
+        void flush ();
+
+        /** Writes the pending records and lets Rank0 print the totals of the run */
+        void printSummary ();
+};
+
+#endif
@@ -0,0 +1,259 @@
+#include "Statistics.h"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+// Sums per output cell: geometric weight, x, y, z, fluid weight, u, v, w, p, nu_t, uu, vv, ww, uv
+static const int N_SUMS = 14;
+
+Statistics::Statistics ( FlowField & flowField, const Parameters & parameters ) :
+  FieldStencil<FlowField>(parameters),
+  _flowField(flowField),
+  _turbFlowField(parameters.simulation.type == "turbulence" ? (TurbulentFlowField*) &flowField : NULL),
+  _iterator(flowField, parameters, *this, 1, 0),
+  _nx(parameters.parallel.localSize[0]),
+  _ny(parameters.parallel.localSize[1]),
+  _nz(parameters.geometry.dim == 3 ? parameters.parallel.localSize[2] : 1),
+  _samples(0),
+  _totalWeight(0.0),
+  _firstTime(0.0),
+  _lastTime(0.0),
+  _weight(0.0),
+  _ratio(0.0)
+{
+    if (_parameters.statistics.active) {
+        _mean.resize(5 * _nx * _ny * _nz, 0.0);
+        _moments.resize(4 * _nx * _ny * _nz, 0.0);
+    }
+}
+
+
+void Statistics::sample ( FLOAT time, FLOAT dt ) {
+    // part of the last time step inside the averaging window
+    const FLOAT start = std::max(time - dt, _parameters.statistics.startTime);
+    const FLOAT end   = std::min(time, _parameters.statistics.endTime);
+    if (end <= start) {
+        return;
+    }
+
+    if (_samples == 0) {
+        _firstTime = start;
+    }
+    _lastTime = end;
+    _samples++;
+
+    _weight = end - start;
+    _totalWeight += _weight;
+    _ratio = _weight / _totalWeight;
+
+    _iterator.iterate();
+}
+
+
+void Statistics::update ( int cell, const FLOAT * values ) {
+    // weighted online update (West 1979): the means move by the ratio of the new weight, the
+    // co-moments grow by the product of the deviations from the old and the new mean
+    FLOAT * mean = &_mean[5*cell];
+    FLOAT * moments = &_moments[4*cell];
+
+    FLOAT delta[3];
+    for (int q = 0; q < 5; q++) {
+        const FLOAT d = values[q] - mean[q];
+        if (q < 3) {
+            delta[q] = d;
+        }
+        mean[q] += _ratio * d;
+    }
+
+    moments[0] += _weight * delta[0] * (values[0] - mean[0]);
+    moments[1] += _weight * delta[1] * (values[1] - mean[1]);
+    moments[2] += _weight * delta[2] * (values[2] - mean[2]);
+    moments[3] += _weight * delta[0] * (values[1] - mean[1]);
+}
+
+
+void Statistics::apply ( FlowField & flowField, int i, int j ) {
+    if ((_flowField.getFlags().getValue(i, j) & OBSTACLE_SELF) != 0) {
+        return;
+    }
+
+    // u, v, w, p, nu_t
+    FLOAT values[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+    _flowField.getPressureAndVelocity(values[3], values, i, j);
+    if (_turbFlowField != NULL) {
+        values[4] = _turbFlowField->getTurbViscosity().getScalar(i, j);
+    }
+    update(getCellIndex(i, j, 2), values);
+}
+
+
+void Statistics::apply ( FlowField & flowField, int i, int j, int k ) {
+    if ((_flowField.getFlags().getValue(i, j, k) & OBSTACLE_SELF) != 0) {
+        return;
+    }
+
+    // u, v, w, p, nu_t
+    FLOAT values[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+    _flowField.getPressureAndVelocity(values[3], values, i, j, k);
+    if (_turbFlowField != NULL) {
+        values[4] = _turbFlowField->getTurbViscosity().getScalar(i, j, k);
+    }
+    update(getCellIndex(i, j, k), values);
+}
+
+
+void Statistics::accumulatePlane ( int plane, const int * outputSize, std::vector<FLOAT> & sums ) const {
+    const bool is3D = _parameters.geometry.dim == 3;
+    const int * average = _parameters.statistics.average;
+    const int * firstCorner = _parameters.parallel.firstCorner;
+    Meshsize * ms = _parameters.meshsize;
+
+    for (int k = 2; k < 2 + _nz; k++) {
+        // the output planes are the z-layers, unless the statistics are averaged along z
+        if (is3D && !average[2] && firstCorner[2] + k - 2 != plane) {
+            continue;
+        }
+        for (int j = 2; j < 2 + _ny; j++) {
+            for (int i = 2; i < 2 + _nx; i++) {
+                const int outI = average[0] ? 0 : firstCorner[0] + i - 2;
+                const int outJ = average[1] ? 0 : firstCorner[1] + j - 2;
+                FLOAT * sum = &sums[N_SUMS * (outI + outputSize[0] * outJ)];
+
+                // weight of the cell along the averaged directions
+                FLOAT weight = 1.0;
+                FLOAT position[3] = {0.0, 0.0, 0.0};
+                int obstacle;
+                if (is3D) {
+                    if (average[0]) weight *= ms->getDx(i, j, k);
+                    if (average[1]) weight *= ms->getDy(i, j, k);
+                    if (average[2]) weight *= ms->getDz(i, j, k);
+                    position[0] = ms->getPosX(i, j, k) + 0.5 * ms->getDx(i, j, k);
+                    position[1] = ms->getPosY(i, j, k) + 0.5 * ms->getDy(i, j, k);
+                    position[2] = ms->getPosZ(i, j, k) + 0.5 * ms->getDz(i, j, k);
+                    obstacle = _flowField.getFlags().getValue(i, j, k);
+                } else {
+                    if (average[0]) weight *= ms->getDx(i, j);
+                    if (average[1]) weight *= ms->getDy(i, j);
+                    position[0] = ms->getPosX(i, j) + 0.5 * ms->getDx(i, j);
+                    position[1] = ms->getPosY(i, j) + 0.5 * ms->getDy(i, j);
+                    obstacle = _flowField.getFlags().getValue(i, j);
+                }
+
+                sum[0] += weight;
+                sum[1] += weight * position[0];
+                sum[2] += weight * position[1];
+                sum[3] += weight * position[2];
+
+                if ((obstacle & OBSTACLE_SELF) != 0) {
+                    continue;
+                }
+
+                // second moments about zero, so that cells with different means can be combined
+                const int cell = getCellIndex(i, j, k);
+                const FLOAT * mean = &_mean[5*cell];
+                const FLOAT * moments = &_moments[4*cell];
+                sum[4] += weight;
+                for (int q = 0; q < 5; q++) {
+                    sum[5+q] += weight * mean[q];
+                }
+                sum[10] += weight * (moments[0] / _totalWeight + mean[0] * mean[0]);
+                sum[11] += weight * (moments[1] / _totalWeight + mean[1] * mean[1]);
+                sum[12] += weight * (moments[2] / _totalWeight + mean[2] * mean[2]);
+                sum[13] += weight * (moments[3] / _totalWeight + mean[0] * mean[1]);
+            }
+        }
+    }
+}
+
+
+void Statistics::write () {
+    const bool is3D = _parameters.geometry.dim == 3;
+    const bool turbulent = _turbFlowField != NULL;
+    const int * average = _parameters.statistics.average;
+    const int rank = _parameters.parallel.rank;
+
+    if (_samples == 0) {
+        if (rank == 0) {
+            std::cout << "Statistics: no time step inside the averaging window ["
+                      << _parameters.statistics.startTime << ", " << _parameters.statistics.endTime
+                      << "], nothing written" << std::endl;
+        }
+        return;
+    }
+
+    // the output cells remaining after averaging; they are reduced one z-layer at a time, so the
+    // buffers stay small even if nothing is averaged
+    const int outputSize[3] = {
+        average[0] ? 1 : _parameters.geometry.sizeX,
+        average[1] ? 1 : _parameters.geometry.sizeY,
+        (is3D && !average[2]) ? _parameters.geometry.sizeZ : 1
+    };
+    const int planeValues = N_SUMS * outputSize[0] * outputSize[1];
+    std::vector<FLOAT> sums(planeValues);
+    std::vector<FLOAT> globalSums(rank == 0 ? planeValues : 1);
+
+    std::ofstream file;
+    if (rank == 0) {
+        const std::string fileName = _parameters.statistics.prefix + ".dat";
+        file.open(fileName.c_str());
+        if (!file.is_open()) {
+            handleError(1, "Cannot open the statistics file");
+        }
+        file << "# NS-EOF time-averaged statistics over t = [" << _firstTime << ", " << _lastTime
+             << "], " << _samples << " time steps" << std::endl;
+        file << "# averaged along:" << (average[0] ? " x" : "") << (average[1] ? " y" : "")
+             << (is3D && average[2] ? " z" : "")
+             << (average[0] || average[1] || (is3D && average[2]) ? "" : " -") << std::endl;
+        file << (is3D ? "# x y z U V W p u'u' v'v' w'w' u'v'" : "# x y U V p u'u' v'v' u'v'")
+             << (turbulent ? " nuT" : "") << std::endl;
+        file << std::setprecision(8);
+    }
+
+    for (int plane = 0; plane < outputSize[2]; plane++) {
+        std::fill(sums.begin(), sums.end(), 0.0);
+        accumulatePlane(plane, outputSize, sums);
+        MPI_Reduce(&sums[0], &globalSums[0], planeValues, MY_MPI_FLOAT, MPI_SUM, 0, PETSC_COMM_WORLD);
+
+        if (rank != 0) {
+            continue;
+        }
+        for (int j = 0; j < outputSize[1]; j++) {
+            for (int i = 0; i < outputSize[0]; i++) {
+                const FLOAT * sum = &globalSums[N_SUMS * (i + outputSize[0] * j)];
+                FLOAT mean[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+                FLOAT stress[4] = {0.0, 0.0, 0.0, 0.0};
+                if (sum[4] > 0.0) {
+                    for (int q = 0; q < 5; q++) {
+                        mean[q] = sum[5+q] / sum[4];
+                    }
+                    stress[0] = sum[10] / sum[4] - mean[0] * mean[0];
+                    stress[1] = sum[11] / sum[4] - mean[1] * mean[1];
+                    stress[2] = sum[12] / sum[4] - mean[2] * mean[2];
+                    stress[3] = sum[13] / sum[4] - mean[0] * mean[1];
+                }
+
+                file << sum[1] / sum[0] << " " << sum[2] / sum[0];
+                if (is3D) {
+                    file << " " << sum[3] / sum[0];
+                }
+                file << " " << mean[0] << " " << mean[1];
+                if (is3D) {
+                    file << " " << mean[2];
+                }
+                file << " " << mean[3] << " " << stress[0] << " " << stress[1];
+                if (is3D) {
+                    file << " " << stress[2];
+                }
+                file << " " << stress[3];
+                if (turbulent) {
+                    file << " " << mean[4];
+                }
+                file << "\n";
+            }
+        }
+    }
+
+    if (rank == 0) {
+        file.close();
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef _STATISTICS_H_
+#define _STATISTICS_H_
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "Stencil.h"
+#include "FlowField.h"
+#include "Iterators.h"
+#include "TurbulentFlowField.h"
+#include <vector>
+
+/** Time-averaged turbulence statistics, accumulated while the simulation runs
+ *
+ * After each time step inside the averaging window, the cell-centred velocity, the pressure and
+ * the turbulent viscosity of all fluid cells are added to online (Welford) accumulators, weighted
+ * by the part of the time step inside the window. Besides the means, the accumulators hold the
+ * co-moments of the velocity fluctuations, from which the Reynolds stresses u'u', v'v', w'w' and
+ * u'v' follow.
+ *
+ * Only the statistics are written, once at the end of the run: optionally averaged along
+ * homogeneous directions (weighted by the cell widths), reduced over all ranks and written by
+ * Rank0 as a text file with one line per remaining cell. The accumulators are not part of the
+ * checkpoints, so a restarted run starts averaging anew.
+ */
+class Statistics : private FieldStencil<FlowField> {
+    private:
+
+        FlowField & _flowField;
+        TurbulentFlowField * _turbFlowField;    //! NULL in DNS
+
+        FieldIterator<FlowField> _iterator;
+
+        const int _nx, _ny, _nz;    //! Number of local cells per dimension (_nz = 1 in 2D)
+
+        int _samples;               //! Number of time steps added so far
+        FLOAT _totalWeight;         //! Time averaged over so far
+        FLOAT _firstTime, _lastTime;    //! Part of the window covered by the samples
+
+        FLOAT _weight;              //! Weight of the current sample
+        FLOAT _ratio;               //! Weight of the current sample relative to _totalWeight
+
+        std::vector<FLOAT> _mean;       //! Means of u, v, w, p and nu_t per cell
+        std::vector<FLOAT> _moments;    //! Co-moments of u'u', v'v', w'w' and u'v' per cell
+
+        int getCellIndex ( int i, int j, int k ) const { return (i-2) + _nx*((j-2) + _ny*(k-2)); }
+
+        /** Adds the values of a fluid cell to its accumulators */
+        void update ( int cell, const FLOAT * values );
+
+        void apply ( FlowField & flowField, int i, int j );
+        void apply ( FlowField & flowField, int i, int j, int k );
+
+        /** Sums the geometric weights, the weighted coordinates, means and second moments of the
+         *  local cells, which contribute to the given output plane
+         */
+        void accumulatePlane ( int plane, const int * outputSize, std::vector<FLOAT> & sums ) const;
+
+    public:
+
+        /** Constructor. Allocates the accumulators if the statistics are active
+         *
+         * @param flowField Flow field, a TurbulentFlowField for turbulent simulations
+         * @param parameters Parameters of the problem
+         */
+        Statistics ( FlowField & flowField, const Parameters & parameters );
+
+        /** Adds the current state to the statistics, if the time step ending at the given time
+         *  overlaps the averaging window
+         *
+         * @param time Current time
+         * @param dt Length of the last time step
+         */
+        void sample ( FLOAT time, FLOAT dt );
+
+        /** Reduces the statistics over all ranks and writes them to prefix.dat */
+        void write ();
+};
+
+#endif
@@ -0,0 +1,251 @@
+#include "SteadyState.h"
+#include <algorithm>
+#include <math.h>
+
+SteadyState::SteadyState ( FlowField & flowField, const Parameters & parameters ) :
+  _parameters(parameters),
+  _flowField(flowField),
+  _turbFlowField(parameters.simulation.type == "turbulence" ? (TurbulentFlowField*) &flowField : NULL),
+  _cellDt(!parameters.steady.active ? ScalarField(0, 0) :
+          parameters.geometry.dim == 2 ? ScalarField(flowField.getCellsX(), flowField.getCellsY()) :
+          ScalarField(flowField.getCellsX(), flowField.getCellsY(), flowField.getCellsZ())),
+  _weights(!parameters.steady.active ? VectorField(0, 0) :
+           parameters.geometry.dim == 2 ? VectorField(flowField.getCellsX(), flowField.getCellsY()) :
+           VectorField(flowField.getCellsX(), flowField.getCellsY(), flowField.getCellsZ())),
+  _previousVelocity(!parameters.steady.active ? VectorField(0, 0) :
+                    parameters.geometry.dim == 2 ? VectorField(flowField.getCellsX(), flowField.getCellsY()) :
+                    VectorField(flowField.getCellsX(), flowField.getCellsY(), flowField.getCellsZ())),
+  _residual(MY_FLOAT_MAX),
+  _divergence(MY_FLOAT_MAX)
+{
+    if (!parameters.steady.active) {
+        return;
+    }
+
+    // the plain Laplacian until the first steps are known
+    const int cellsZ = parameters.geometry.dim == 3 ? getCells(2) : 1;
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < getCells(1); j++) {
+            for (int i = 0; i < getCells(0); i++) {
+                for (int c = 0; c < parameters.geometry.dim; c++) {
+                    _weights.getVector(i, j, k)[c] = 1.0;
+                }
+            }
+        }
+    }
+}
+
+
+int SteadyState::getCells ( int dimension ) const {
+    return dimension == 0 ? _flowField.getCellsX() : (dimension == 1 ? _flowField.getCellsY() : _flowField.getCellsZ());
+}
+
+
+FLOAT SteadyState::getSpacing ( int dimension, const int index[3] ) const {
+    const Meshsize * ms = _parameters.meshsize;
+    if (_parameters.geometry.dim == 2) {
+        return dimension == 0 ? ms->getDx(index[0], index[1]) : ms->getDy(index[0], index[1]);
+    }
+    return dimension == 0 ? ms->getDx(index[0], index[1], index[2]) :
+          (dimension == 1 ? ms->getDy(index[0], index[1], index[2]) : ms->getDz(index[0], index[1], index[2]));
+}
+
+
+bool SteadyState::isObstacleFace ( int component, const int index[3] ) {
+    IntScalarField & flags = _flowField.getFlags();
+    int next[3] = {index[0], index[1], index[2]};
+    next[component]++;
+    return (flags.getValue(index[0], index[1], index[2]) & OBSTACLE_SELF) ||
+           (flags.getValue(next[0], next[1], next[2]) & OBSTACLE_SELF);
+}
+
+
+FLOAT SteadyState::computeTimeSteps () {
+    const int dim = _parameters.geometry.dim;
+    const int cellsX = getCells(0), cellsY = getCells(1);
+    // getCellsZ also counts ghost layers in 2D
+    const int firstZ = dim == 3 ? 1 : 0, lastZ = dim == 3 ? getCells(2) - 1 : 0;
+    VectorField & velocity = _flowField.getVelocity();
+
+    // steps of the inner cells and of the ghost cells above the lowest ghost layer, whose lower
+    // faces are the last ones exchanged with the neighbour
+    FLOAT localMin = MY_FLOAT_MAX;
+    int index[3];
+    for (int k = firstZ; k <= lastZ; k++) {
+        for (int j = 1; j < cellsY; j++) {
+            for (int i = 1; i < cellsX; i++) {
+                index[0] = i; index[1] = j; index[2] = k;
+                FLOAT viscosity = 1.0 / _parameters.flow.Re;
+                if (_turbFlowField != NULL) {
+                    viscosity += _turbFlowField->getTurbViscosity().getScalar(i, j, k);
+                }
+                FLOAT inverseSquares = 0.0, convective = MY_FLOAT_MAX;
+                bool inner = true;
+                for (int d = 0; d < dim; d++) {
+                    const FLOAT spacing = getSpacing(d, index);
+                    int lower[3] = {i, j, k};
+                    lower[d]--;
+                    const FLOAT speed = std::max(fabs(velocity.getVector(i, j, k)[d]),
+                                                 fabs(velocity.getVector(lower[0], lower[1], lower[2])[d]));
+                    inverseSquares += 1.0 / (spacing * spacing);
+                    if (speed > 0.0) {
+                        convective = std::min(convective, spacing / speed);
+                    }
+                    inner = inner && index[d] >= 2 && index[d] <= getCells(d) - 2;
+                }
+                const FLOAT cellDt = _parameters.timestep.tau * std::min(0.5 / viscosity / inverseSquares, convective);
+                _cellDt.getScalar(i, j, k) = cellDt;
+                if (inner) {
+                    localMin = std::min(localMin, cellDt);
+                }
+            }
+        }
+    }
+
+    FLOAT globalMin = MY_FLOAT_MAX;
+    MPI_Allreduce(&localMin, &globalMin, 1, MY_MPI_FLOAT, MPI_MIN, PETSC_COMM_WORLD);
+
+    // a component advances with the smaller step of its cells, but not below the global one
+    for (int k = firstZ; k <= lastZ; k++) {
+        for (int j = 1; j < cellsY; j++) {
+            for (int i = 1; i < cellsX; i++) {
+                for (int c = 0; c < dim; c++) {
+                    int next[3] = {i, j, k};
+                    next[c]++;
+                    if (next[c] < getCells(c)) {
+                        const FLOAT faceDt = std::min(_cellDt.getScalar(i, j, k),
+                                                      _cellDt.getScalar(next[0], next[1], next[2]));
+                        _weights.getVector(i, j, k)[c] = std::max(faceDt / globalMin, (FLOAT) 1.0);
+                    }
+                }
+            }
+        }
+    }
+    return globalMin;
+}
+
+
+void SteadyState::combine () {
+    const int dim = _parameters.geometry.dim;
+    const int cellsX = getCells(0), cellsY = getCells(1);
+    const int cellsZ = dim == 3 ? getCells(2) : 1;
+    VectorField & velocity = _flowField.getVelocity();
+    VectorField & fgh = _flowField.getFGH();
+
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < cellsY; j++) {
+            for (int i = 0; i < cellsX; i++) {
+                for (int c = 0; c < dim; c++) {
+                    _previousVelocity.getVector(i, j, k)[c] = velocity.getVector(i, j, k)[c];
+                }
+            }
+        }
+    }
+
+    // the faces of the FGH stencils; the global boundaries are set by the wall iterator afterwards
+    const int firstZ = dim == 3 ? 1 : 0, lastZ = dim == 3 ? cellsZ - 2 : 0;
+    int index[3];
+    for (int k = firstZ; k <= lastZ; k++) {
+        for (int j = 1; j <= cellsY - 2; j++) {
+            for (int i = 1; i <= cellsX - 2; i++) {
+                index[0] = i; index[1] = j; index[2] = k;
+                const FLOAT * u = velocity.getVector(i, j, k);
+                FLOAT * f = fgh.getVector(i, j, k);
+                for (int c = 0; c < dim; c++) {
+                    if (isObstacleFace(c, index)) {
+                        f[c] = u[c];
+                    } else {
+                        f[c] = u[c] + _weights.getVector(i, j, k)[c] * (f[c] - u[c]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+void SteadyState::correctVelocity () {
+    const int dim = _parameters.geometry.dim;
+    const int cellsX = getCells(0), cellsY = getCells(1);
+    const int firstZ = dim == 3 ? 1 : 0, lastZ = dim == 3 ? getCells(2) - 2 : 0;
+    VectorField & velocity = _flowField.getVelocity();
+    VectorField & fgh = _flowField.getFGH();
+
+    // the faces of the VelocityStencil; the ones of obstacles are set by the ObstacleStencil
+    int index[3];
+    for (int k = firstZ; k <= lastZ; k++) {
+        for (int j = 1; j <= cellsY - 2; j++) {
+            for (int i = 1; i <= cellsX - 2; i++) {
+                index[0] = i; index[1] = j; index[2] = k;
+                FLOAT * u = velocity.getVector(i, j, k);
+                const FLOAT * f = fgh.getVector(i, j, k);
+                for (int c = 0; c < dim; c++) {
+                    if (!isObstacleFace(c, index)) {
+                        u[c] = f[c] + _weights.getVector(i, j, k)[c] * (u[c] - f[c]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+VectorField & SteadyState::getWeights () {
+    return _weights;
+}
+
+
+bool SteadyState::isConverged () {
+    const int dim = _parameters.geometry.dim;
+    const int upperNb[3] = {_parameters.parallel.rightNb, _parameters.parallel.topNb, _parameters.parallel.backNb};
+    const int firstZ = dim == 3 ? 2 : 0, lastZ = dim == 3 ? getCells(2) - 2 : 0;
+    const FLOAT dt = _parameters.timestep.dt;
+    VectorField & velocity = _flowField.getVelocity();
+    IntScalarField & flags = _flowField.getFlags();
+
+    // maximum norms over the inner faces and the inner fluid cells
+    FLOAT local[2] = {0.0, 0.0};
+    int index[3];
+    for (int k = firstZ; k <= lastZ; k++) {
+        for (int j = 2; j <= getCells(1) - 2; j++) {
+            for (int i = 2; i <= getCells(0) - 2; i++) {
+                index[0] = i; index[1] = j; index[2] = k;
+                const FLOAT * u = velocity.getVector(i, j, k);
+                const FLOAT * previous = _previousVelocity.getVector(i, j, k);
+                for (int c = 0; c < dim; c++) {
+                    if ((index[c] == getCells(c) - 2 && upperNb[c] < 0) || isObstacleFace(c, index)) {
+                        continue;
+                    }
+                    local[0] = std::max(local[0], fabs(u[c] - previous[c]) / (_weights.getVector(i, j, k)[c] * dt));
+                }
+
+                if (flags.getValue(i, j, k) & OBSTACLE_SELF) {
+                    continue;
+                }
+                FLOAT divergence = 0.0;
+                for (int d = 0; d < dim; d++) {
+                    int lower[3] = {i, j, k};
+                    lower[d]--;
+                    divergence += (u[d] - velocity.getVector(lower[0], lower[1], lower[2])[d]) / getSpacing(d, index);
+                }
+                local[1] = std::max(local[1], fabs(divergence));
+            }
+        }
+    }
+
+    FLOAT global[2];
+    MPI_Allreduce(local, global, 2, MY_MPI_FLOAT, MPI_MAX, PETSC_COMM_WORLD);
+    _residual = global[0];
+    _divergence = global[1];
+    return _residual < _parameters.steady.tolerance && _divergence < _parameters.steady.divergenceTolerance;
+}
+
+
+FLOAT SteadyState::getResidual () const {
+    return _residual;
+}
+
+
+FLOAT SteadyState::getDivergence () const {
+    return _divergence;
+}
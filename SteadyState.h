@@ -0,0 +1,88 @@
+#ifndef _STEADY_STATE_H_
+#define _STEADY_STATE_H_
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "FlowField.h"
+#include "TurbulentFlowField.h"
+
+/** Pseudo-time stepping towards the steady state, with a local time step per cell.
+ *
+ * The step of a cell is tau times the smaller of the viscous bound of the MinDtStencil,
+ * 0.5/(1/Re + nu_t)/sum(1/dx^2), and the convective bound dx/|u| of the MaxUStencil, evaluated
+ * with the quantities of the cell alone; a velocity component advances with the smaller step
+ * dt_face of its two cells. The FGH stencils run with the global step dt_g, the smallest one of
+ * all inner cells, and each component is rescaled to F = u + dt_face/dt_g (FGH - u). The pressure
+ * equation then has to carry the same steps, div(dt_face grad p) = div F: the solver scales the
+ * coefficient of each face of the Laplacian by the weight w = dt_face/dt_g, and the velocity
+ * update u = F - dt_g grad p of the VelocityStencil is rescaled to F - dt_face grad p. Thus each
+ * step is an exact projection, and the fixed points are the steady states of the time-accurate
+ * scheme whatever the local steps. The pseudo-time of the loop advances by dt_g.
+ *
+ * The step of a ghost cell next to the subdomain is computed from the same values as the one of
+ * the inner cell of the neighbour, so both ranks obtain the same weights for the faces they
+ * share. Nothing beyond the velocity and the pressure is carried across pseudo-time steps, so
+ * runs can restart from any checkpoint. Without <steady>, the fields are left empty.
+ */
+class SteadyState {
+    private:
+
+        const Parameters & _parameters;
+        FlowField & _flowField;
+        TurbulentFlowField * _turbFlowField;    //! NULL in DNS
+
+        ScalarField _cellDt;            //! Local step of the cells
+        VectorField _weights;           //! Local step of the velocity components relative to dt_g
+        VectorField _previousVelocity;  //! Velocity at the beginning of the pseudo-time step
+
+        FLOAT _residual;    //! Maximum of |u^{n+1} - u^n|/dt_face of the last check
+        FLOAT _divergence;  //! Maximum of |div u| of the last check
+
+        /** Number of cells (inner and ghost) along a dimension */
+        int getCells ( int dimension ) const;
+
+        /** Mesh width of the cell along a dimension */
+        FLOAT getSpacing ( int dimension, const int index[3] ) const;
+
+        /** Whether the face of a velocity component between the cell and its upper neighbour
+         *  touches an obstacle
+         */
+        bool isObstacleFace ( int component, const int index[3] );
+
+    public:
+
+        /** Constructor
+         *
+         * @param flowField Flow field
+         * @param parameters Parameters of the problem
+         */
+        SteadyState ( FlowField & flowField, const Parameters & parameters );
+
+        /** Computes the local steps of the cells and the weights of the faces from the current
+         *  velocity and turbulent viscosity and returns the global step dt_g over all ranks
+         */
+        FLOAT computeTimeSteps ();
+
+        /** Rescales the FGH computed with the global step to the local steps and stores the
+         *  velocity of the beginning of the step
+         */
+        void combine ();
+
+        /** Rescales the pressure gradient of the velocity computed by the VelocityStencil with
+         *  the global step to the local steps
+         */
+        void correctVelocity ();
+
+        /** Weights of the faces of the pressure equation, dt_face/dt_g */
+        VectorField & getWeights ();
+
+        /** Computes the residual and divergence norms over all ranks and compares them with the
+         *  tolerances
+         */
+        bool isConverged ();
+
+        FLOAT getResidual () const;
+        FLOAT getDivergence () const;
+};
+
+#endif
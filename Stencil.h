@@ -37,6 +37,33 @@ class FieldStencil {
          */
         virtual void apply ( FlowField & flowField, int i, int j, int k) = 0;
 
+        /** Performs the operation in 2D on a run of fluid cells without obstacle neighbours, i.e.
+         * on cells whose flags are zero. Stencils override it with a kernel free of the flag
+         * branches; by default, the general operation is applied to each cell.
+         * @param flowField Flow field data
+         * @param begin First position of the run in the x direction
+         * @param end Position after the run in the x direction
+         * @param j Position in the y direction
+         */
+        virtual void applyFluidRun ( FlowField & flowField, int begin, int end, int j ){
+            for (int i = begin; i < end; i++){
+                apply ( flowField, i, j );
+            }
+        }
+
+        /** Performs the operation in 3D on a run of fluid cells without obstacle neighbours
+         * @param flowField Flow field data
+         * @param begin First position of the run in the x direction
+         * @param end Position after the run in the x direction
+         * @param j Position in the y direction
+         * @param k Position in the z direction
+         */
+        virtual void applyFluidRun ( FlowField & flowField, int begin, int end, int j, int k ){
+            for (int i = begin; i < end; i++){
+                apply ( flowField, i, j, k );
+            }
+        }
+
 };
 
 
@@ -0,0 +1,152 @@
+#include "Timers.h"
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+
+TimerRegistry::TimerRegistry () : _enabled(true), _countersEnabled(false) {
+    for (int r = 0; r < NUMBER_OF_TIMER_REGIONS; r++) {
+        _time[r] = 0.0;
+        _calls[r] = 0;
+        _work[r] = 0;
+        for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+            _events[r][e] = 0;
+        }
+    }
+}
+
+
+bool TimerRegistry::enableCounters () {
+    int available = _counters.isOpen() || _counters.open() ? 1 : 0;
+    int everywhere;
+    MPI_Allreduce(&available, &everywhere, 1, MPI_INT, MPI_MIN, PETSC_COMM_WORLD);
+    _countersEnabled = everywhere == 1;
+    return _countersEnabled;
+}
+
+
+void TimerRegistry::reduceCounters ( long long sums[NUMBER_OF_TIMER_REGIONS][NUMBER_OF_PERF_EVENTS] ) const {
+    MPI_Reduce(&_events[0][0], &sums[0][0], NUMBER_OF_TIMER_REGIONS * NUMBER_OF_PERF_EVENTS,
+               MPI_LONG_LONG, MPI_SUM, 0, PETSC_COMM_WORLD);
+}
+
+
+void TimerRegistry::printCounters () const {
+    int rank;
+    MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+    long long sums[NUMBER_OF_TIMER_REGIONS][NUMBER_OF_PERF_EVENTS];
+    double maxTime[NUMBER_OF_TIMER_REGIONS];
+    reduceCounters(sums);
+    MPI_Reduce(_time, maxTime, NUMBER_OF_TIMER_REGIONS, MPI_DOUBLE, MPI_MAX, 0, PETSC_COMM_WORLD);
+    if (rank != 0) {
+        return;
+    }
+
+    // the memory traffic assumes one 64 byte line per last level cache miss
+    printf("%-16s %12s %12s %8s %10s %10s %12s\n", "Stage", "Gcycles", "Ginstr", "IPC",
+           "LLC miss%", "LLC MPKI", "GB/s (est)");
+    for (int r = 0; r < NUMBER_OF_TIMER_REGIONS; r++) {
+        const long long * events = sums[r];
+        if (events[PerfCycles] == 0) {
+            continue;
+        }
+        const double instructions = (double) events[PerfInstructions];
+        printf("%-16s %12.3f %12.3f %8.2f %10.2f %10.2f %12.2f\n", getName((TimerRegion) r),
+               1e-9 * events[PerfCycles], 1e-9 * instructions,
+               instructions / events[PerfCycles],
+               events[PerfCacheReferences] > 0 ? 100.0 * events[PerfCacheMisses] / events[PerfCacheReferences] : 0.0,
+               instructions > 0.0 ? 1e3 * events[PerfCacheMisses] / instructions : 0.0,
+               maxTime[r] > 0.0 ? 64e-9 * events[PerfCacheMisses] / maxTime[r] : 0.0);
+    }
+}
+
+
+const char * TimerRegistry::getName ( TimerRegion region ) {
+    static const char * names[NUMBER_OF_TIMER_REGIONS] = {
+        "turbVisc", "turbViscComm", "turbViscCheck", "wallBoundaries", "setTimeStep", "fgh", "viscous", "rhs",
+        "solve", "pressureComm", "velocity", "obstacle", "velocityComm", "convergence",
+        "vtk", "checkpoint", "statistics", "probes"
+    };
+    return names[region];
+}
+
+
+/** Writes the minimum, average and maximum of the values of all ranks and the values themselves */
+static void writeDistribution ( std::ostream & file, const std::vector<double> & values ) {
+    double min = values[0], max = values[0], sum = 0.0;
+    for (unsigned int rank = 0; rank < values.size(); rank++) {
+        min = std::min(min, values[rank]);
+        max = std::max(max, values[rank]);
+        sum += values[rank];
+    }
+    file << "\"min\": " << min << ", \"avg\": " << sum / values.size() << ", \"max\": " << max
+         << ", \"ranks\": [";
+    for (unsigned int rank = 0; rank < values.size(); rank++) {
+        file << (rank > 0 ? ", " : "") << values[rank];
+    }
+    file << "]";
+}
+
+
+void TimerRegistry::writeReport ( const std::string & filename, double loopTime, int timeSteps ) const {
+    int rank, nproc;
+    MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+    MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+
+    // the times of the regions followed by the loop time, and the calls followed by the work
+    const int nTimes = NUMBER_OF_TIMER_REGIONS + 1;
+    double times[nTimes];
+    long counts[2 * NUMBER_OF_TIMER_REGIONS];
+    for (int r = 0; r < NUMBER_OF_TIMER_REGIONS; r++) {
+        times[r] = _time[r];
+        counts[r] = _calls[r];
+        counts[NUMBER_OF_TIMER_REGIONS + r] = _work[r];
+    }
+    times[NUMBER_OF_TIMER_REGIONS] = loopTime;
+
+    std::vector<double> allTimes(rank == 0 ? nTimes * nproc : 1);
+    std::vector<long> maxCounts(2 * NUMBER_OF_TIMER_REGIONS);
+    long long events[NUMBER_OF_TIMER_REGIONS][NUMBER_OF_PERF_EVENTS];
+    MPI_Gather(times, nTimes, MPI_DOUBLE, &allTimes[0], nTimes, MPI_DOUBLE, 0, PETSC_COMM_WORLD);
+    MPI_Reduce(counts, &maxCounts[0], 2 * NUMBER_OF_TIMER_REGIONS, MPI_LONG, MPI_MAX, 0, PETSC_COMM_WORLD);
+    if (_countersEnabled) {
+        reduceCounters(events);
+    }
+    if (rank != 0) {
+        return;
+    }
+
+    std::ofstream file(filename.c_str());
+    if (!file.is_open()) {
+        handleError(1, "Cannot open the timer report");
+    }
+    file << std::setprecision(6);
+
+    std::vector<double> values(nproc);
+    for (int p = 0; p < nproc; p++) {
+        values[p] = allTimes[nTimes * p + NUMBER_OF_TIMER_REGIONS];
+    }
+    file << "{\n  \"ranks\": " << nproc << ",\n  \"timeSteps\": " << timeSteps << ",\n  \"loop\": {";
+    writeDistribution(file, values);
+    file << "},\n  \"regions\": {";
+
+    for (int r = 0; r < NUMBER_OF_TIMER_REGIONS; r++) {
+        for (int p = 0; p < nproc; p++) {
+            values[p] = allTimes[nTimes * p + r];
+        }
+        file << (r > 0 ? "," : "") << "\n    \"" << getName((TimerRegion) r) << "\": {\"calls\": "
+             << maxCounts[r] << ", \"work\": " << maxCounts[NUMBER_OF_TIMER_REGIONS + r] << ", ";
+        writeDistribution(file, values);
+        if (_countersEnabled) {
+            file << ", \"counters\": {";
+            for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+                file << (e > 0 ? ", " : "") << "\"" << PerfCounters::getName((PerfEvent) e) << "\": " << events[r][e];
+            }
+            file << "}";
+        }
+        file << "}";
+    }
+    file << "\n  }\n}\n";
+    file.close();
+}
@@ -0,0 +1,165 @@
+#ifndef _TIMERS_H_
+#define _TIMERS_H_
+
+#include "Definitions.h"
+#include "PerfCounters.h"
+#include <string>
+
+/** Stages of a time step and of the output, timed separately */
+enum TimerRegion {
+    TimerTurbVisc=0,        //! Turbulent viscosity
+    TimerTurbViscComm,      //! Communication of the turbulent viscosity
+    TimerTurbViscCheck,     //! Change of the strain rate deciding the update of the turbulent viscosity
+    TimerWallBoundaries,    //! Global boundary iterators (FGH, velocity, turbulent viscosity)
+    TimerSetTimeStep,       //! Time step, including its Allreduce
+    TimerFGH,
+    TimerViscous,           //! Implicit viscous line solves
+    TimerRHS,
+    TimerSolve,             //! Pressure solve; its work is the number of solver iterations
+    TimerPressureComm,
+    TimerVelocity,
+    TimerObstacle,
+    TimerVelocityComm,
+    TimerConvergence,       //! Residual norms of the steady-state mode, including their Allreduce
+    TimerVtk,               //! Full VTK output and the VTK streams
+    TimerCheckpoint,
+    TimerStatistics,
+    TimerProbes,
+    NUMBER_OF_TIMER_REGIONS
+};
+
+
+/** Accumulates the wall-clock time, the number of calls and, where meaningful, the work (e.g.
+ *  solver iterations) of each TimerRegion on this rank. Regions are indexed by the enum, so timing
+ *  costs two clock reads and an addition; while the registry is disabled, only the regions of the
+ *  loop time summary are measured.
+ *  We make use of the singleton pattern, like the MeshsizeFactory.
+ */
+class TimerRegistry {
+    public:
+        static TimerRegistry& getInstance(){
+            static TimerRegistry singleton;
+            return singleton;
+        }
+
+        void setEnabled ( bool enabled ) { _enabled = enabled; }
+        bool isEnabled () const { return _enabled; }
+
+        /** The pressure solve and the ghost layer communication are timed even while the registry
+         *  is disabled, since the summary at the end of the run splits the loop time into them.
+         */
+        bool isTimed ( TimerRegion region ) const {
+            return _enabled || region == TimerSolve || region == TimerTurbViscComm ||
+                   region == TimerPressureComm || region == TimerVelocityComm;
+        }
+
+        /** Adds one call of the given duration to a region */
+        void add ( TimerRegion region, double seconds ) {
+            _time[region] += seconds;
+            _calls[region]++;
+        }
+
+        /** Adds work, e.g. solver iterations, to a region */
+        void addWork ( TimerRegion region, long work ) { _work[region] += work; }
+
+        /** Collective. Opens the hardware counters on all ranks, or on none if they are not
+         *  available on one of them. Returns whether they are counted.
+         */
+        bool enableCounters ();
+        bool countersEnabled () const { return _countersEnabled; }
+
+        /** Reads the current counts, zero if the counters are not enabled */
+        void readCounters ( long long values[NUMBER_OF_PERF_EVENTS] ) const {
+            if (_countersEnabled) {
+                _counters.read(values);
+            } else {
+                for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+                    values[e] = 0;
+                }
+            }
+        }
+
+        /** Adds the events since the given counts to a region */
+        void addCounters ( TimerRegion region, const long long start[NUMBER_OF_PERF_EVENTS] ) {
+            if (_countersEnabled) {
+                long long values[NUMBER_OF_PERF_EVENTS];
+                _counters.read(values);
+                for (int e = 0; e < NUMBER_OF_PERF_EVENTS; e++) {
+                    _events[region][e] += values[e] - start[e];
+                }
+            }
+        }
+
+        /** Collective. Lets Rank0 print the counts summed over the ranks per region, with the
+         *  instructions per cycle, the last level cache miss rate, the misses per thousand
+         *  instructions and the memory traffic they imply.
+         */
+        void printCounters () const;
+
+        double getTime ( TimerRegion region ) const { return _time[region]; }
+
+        /** Time spent in the communication of the ghost layers */
+        double getCommunicationTime () const {
+            return _time[TimerTurbViscComm] + _time[TimerPressureComm] + _time[TimerVelocityComm];
+        }
+
+        static const char * getName ( TimerRegion region );
+
+        /** Collective. Gathers the timers of all ranks and lets Rank0 write them as JSON: per
+         *  region the calls, the work, the time of each rank and its minimum, average and maximum,
+         *  and the hardware counts summed over the ranks if they are enabled.
+         *
+         * @param filename Output file
+         * @param loopTime Wall-clock time of the time loop on this rank
+         * @param timeSteps Number of time steps of the loop
+         */
+        void writeReport ( const std::string & filename, double loopTime, int timeSteps ) const;
+
+    private:
+        TimerRegistry ();
+
+        bool _enabled;
+        double _time[NUMBER_OF_TIMER_REGIONS];
+        long _calls[NUMBER_OF_TIMER_REGIONS];
+        long _work[NUMBER_OF_TIMER_REGIONS];
+
+        PerfCounters _counters;
+        bool _countersEnabled;
+        long long _events[NUMBER_OF_TIMER_REGIONS][NUMBER_OF_PERF_EVENTS];
+
+        /** Sums the counts of all ranks on Rank0 */
+        void reduceCounters ( long long sums[NUMBER_OF_TIMER_REGIONS][NUMBER_OF_PERF_EVENTS] ) const;
+};
+
+
+/** Times the enclosing scope as one call of a region. If compiled with -DPERF_COUNTERS, the
+ *  hardware counters are read around the scope as well.
+ */
+class ScopedTimer {
+    public:
+        ScopedTimer ( TimerRegion region ) :
+            _region(region),
+            _start(TimerRegistry::getInstance().isTimed(region) ? MPI_Wtime() : -1.0) {
+#ifdef PERF_COUNTERS
+            TimerRegistry::getInstance().readCounters(_startEvents);
+#endif
+        }
+
+        ~ScopedTimer () {
+            if (_start >= 0.0) {
+#ifdef PERF_COUNTERS
+                TimerRegistry::getInstance().addCounters(_region, _startEvents);
+#endif
+                TimerRegistry::getInstance().add(_region, MPI_Wtime() - _start);
+            }
+        }
+
+    private:
+        const TimerRegion _region;
+        const double _start;    //! Negative if the region is not timed
+#ifdef PERF_COUNTERS
+        long long _startEvents[NUMBER_OF_PERF_EVENTS];
+#endif
+};
+
+#endif
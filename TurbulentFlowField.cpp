@@ -5,6 +5,9 @@ TurbulentFlowField::TurbulentFlowField(const Parameters & parameters):
     _turbViscosity(parameters.geometry.dim==2 ? ScalarField(getCellsX() + 3, getCellsY() + 3) :
                       ScalarField(getCellsX() + 3, getCellsY() + 3, getCellsZ() + 3)),
     _distNearestWall(parameters.geometry.dim==2 ? ScalarField(getCellsX() + 3, getCellsY() + 3) :
+                      ScalarField(getCellsX() + 3, getCellsY() + 3, getCellsZ() + 3)),
+    _nuTilde(parameters.turbulenceModel.type!="spalartAllmaras" ? ScalarField(0, 0) :
+             parameters.geometry.dim==2 ? ScalarField(getCellsX() + 3, getCellsY() + 3) :
                       ScalarField(getCellsX() + 3, getCellsY() + 3, getCellsZ() + 3))
   {}
 
@@ -15,3 +18,7 @@ ScalarField & TurbulentFlowField::getTurbViscosity () {
 ScalarField & TurbulentFlowField::getDistNearestWall () {
     return _distNearestWall;
 }
+
+ScalarField & TurbulentFlowField::getNuTilde () {
+    return _nuTilde;
+}
@@ -15,6 +15,7 @@ class TurbulentFlowField : public FlowField {
 
         ScalarField _turbViscosity;   //! Scalar field representing the turbulent viscosity
         ScalarField _distNearestWall; //! Scalar field representing the distance to the nearest wall
+        ScalarField _nuTilde;         //! Working variable of the Spalart-Allmaras model, empty for other models
 
     public:
         TurbulentFlowField (const Parameters & parameters);
@@ -27,6 +28,11 @@ class TurbulentFlowField : public FlowField {
          * @return Reference to field
          */
         ScalarField & getDistNearestWall ();
+
+        /** Get field with the working variable of the Spalart-Allmaras model
+         * @return Reference to field
+         */
+        ScalarField & getNuTilde ();
 };
 
 #endif
@@ -6,14 +6,15 @@
 #include "Iterators.h"
 #include "stencils/FGHTurbStencil.h"
 #include "stencils/TurbViscosityStencil.h"
+#include "stencils/StrainRateStencil.h"
 #include "stencils/DistNearestWallStencil.h"
 #include "stencils/MinDtStencil.h"
+#include "stencils/SpalartAllmarasStencil.h"
+#include "WallDistance.h"
 #include "stencils/TurbViscosityBoundaryStencil.h"
 
 #include "parallelManagers/PetscTurbulentParallelManager.h"
 
-#include "SimpleTimer.h"
-
 class TurbulentSimulation : public Simulation {
   protected:
     TurbulentFlowField &_turbFlowField;
@@ -24,111 +25,282 @@ class TurbulentSimulation : public Simulation {
     TurbViscosityStencil &_turbViscStencil;
     FieldIterator<TurbulentFlowField> _turbViscIterator;
 
+    StrainRateStencil _strainRateStencil;
+    FieldIterator<TurbulentFlowField> _strainRateIterator;
+
+    int _turbViscAge;       //! Time steps since the turbulent viscosity was last updated or checked, -1 before
+    int _turbViscSteps;     //! Time steps of this run
+    int _turbViscUpdates;   //! Updates of the turbulent viscosity in this run
+    int _turbViscChecks;    //! Checks of the strain rate in this run
+    bool _timeStepRestored; //! Whether the time step of the last step was read from a checkpoint
+
     MinDtStencil _minDtStencil;
     FieldIterator<TurbulentFlowField> _minDtIterator;
 
     GlobalBoundaryIterator<TurbulentFlowField> _wallTurbViscIterator;
 
-    PetscTurbulentParallelManager _petscTurbParallelManager;
+    // Spalart-Allmaras model, NULL for the mixing length model
+    SpalartAllmarasStencil * _spalartAllmarasStencil;
+    FieldIterator<TurbulentFlowField> * _spalartAllmarasIterator;
+    SpalartAllmarasViscosityStencil * _spalartAllmarasViscosityStencil;
+    FieldIterator<TurbulentFlowField> * _spalartAllmarasViscosityIterator;
 
-    SimpleTimer _timer_solve;
-    SimpleTimer _timer_comm;
+    PetscTurbulentParallelManager _petscTurbParallelManager;
 
   public:
     TurbulentSimulation(Parameters &parameters, TurbulentFlowField &turbFlowField):
       Simulation(parameters,turbFlowField),
       _turbFlowField(turbFlowField),
       _fghTurbStencil(parameters),
-      _fghTurbIterator(turbFlowField,parameters,_fghTurbStencil),
+      _fghTurbIterator(turbFlowField,parameters,_fghTurbStencil,0,0,true),
       _turbViscStencil(createTurbViscosityStencil()),
-      _turbViscIterator(turbFlowField,parameters,_turbViscStencil),
+      _turbViscIterator(turbFlowField,parameters,_turbViscStencil,0,0,true),
+      _strainRateStencil(parameters,turbFlowField),
+      _strainRateIterator(turbFlowField,parameters,_strainRateStencil,0,0,true),
+      _turbViscAge(-1),
+      _turbViscSteps(0),
+      _turbViscUpdates(0),
+      _turbViscChecks(0),
+      _timeStepRestored(false),
       _minDtStencil(parameters),
       _minDtIterator(turbFlowField,parameters,_minDtStencil,1,0), // must not run over ghost layers
       _wallTurbViscIterator(createGlobalBoundaryTurbViscIterator()),
-      _petscTurbParallelManager(parameters,turbFlowField),
-      _timer_solve(),
-      _timer_comm()
+      _spalartAllmarasStencil(NULL),
+      _spalartAllmarasIterator(NULL),
+      _spalartAllmarasViscosityStencil(NULL),
+      _spalartAllmarasViscosityIterator(NULL),
+      _petscTurbParallelManager(parameters,turbFlowField)
     {
+      if (parameters.turbulenceModel.type == "spalartAllmaras") {
+        _spalartAllmarasStencil = new SpalartAllmarasStencil(parameters,turbFlowField);
+        _spalartAllmarasIterator = new FieldIterator<TurbulentFlowField>(turbFlowField,parameters,*_spalartAllmarasStencil,1,0,true);
+        _spalartAllmarasViscosityStencil = new SpalartAllmarasViscosityStencil(parameters,_spalartAllmarasStencil->getNuTildeNext());
+        _spalartAllmarasViscosityIterator = new FieldIterator<TurbulentFlowField>(turbFlowField,parameters,*_spalartAllmarasViscosityStencil,1,0,true);
+      }
+
+      // with a threshold, the updates take the strain rate norms of the check before them
+      if (parameters.turbulenceModel.updateThreshold > 0.0) {
+        _turbViscStencil.setStrainRate(&_strainRateStencil.getStrainRate());
+      }
+
+      // subcycled updates continue in the same time steps after a restart
+      if (parameters.turbulenceModel.updateInterval > 1 || parameters.turbulenceModel.updateThreshold > 0.0) {
+        _checkpoint.addTurbViscUpdates(_turbViscAge, parameters.turbulenceModel.updateThreshold > 0.0 ?
+                                       &_strainRateStencil.getReference() : NULL);
+      }
+    }
+
+    ~TurbulentSimulation(){
+      delete _spalartAllmarasViscosityIterator;
+      delete _spalartAllmarasViscosityStencil;
+      delete _spalartAllmarasIterator;
+      delete _spalartAllmarasStencil;
     }
 
     void initializeFlowField() {
       // call initialization of base class first
       Simulation::initializeFlowField();
 
-      // calculate the distance to the nearest wall for each cell
-      DistNearestWallStencil distStencil(_parameters);
-      FieldIterator<TurbulentFlowField> iterator(_turbFlowField,_parameters,distStencil);
-      iterator.iterate();
+      // calculate the distance to the nearest wall for each cell; complete checkpoints hold it
+      if (_parameters.turbulenceModel.wallDistance == EikonalWallDistance) {
+        WallDistance wallDistance(_parameters,_turbFlowField,_petscTurbParallelManager);
+        wallDistance.compute();
+      } else {
+        DistNearestWallStencil distStencil(_parameters);
+        FieldIterator<TurbulentFlowField> iterator(_turbFlowField,_parameters,distStencil);
+        iterator.iterate();
+      }
+
+      // the working variable of the Spalart-Allmaras model starts from its inflow value
+      if (_spalartAllmarasStencil != NULL) {
+        ScalarField & next = _spalartAllmarasStencil->getNuTildeNext();
+        IntScalarField & flags = _turbFlowField.getFlags();
+        const FLOAT inflow = _parameters.turbulenceModel.spalartAllmaras.inflowRatio / _parameters.flow.Re;
+        const int cellsZ = _parameters.geometry.dim == 3 ? _turbFlowField.getCellsZ() : 1;
+        for (int k = 0; k < cellsZ; k++) {
+          for (int j = 0; j < _turbFlowField.getCellsY(); j++) {
+            for (int i = 0; i < _turbFlowField.getCellsX(); i++) {
+              next.getScalar(i,j,k) = (flags.getValue(i,j,k) & OBSTACLE_SELF) ? 0.0 : inflow;
+            }
+          }
+        }
+        _spalartAllmarasViscosityIterator->iterate();
+        _petscTurbParallelManager.communicateNuTilde();
+        _petscTurbParallelManager.communicateTurbViscosity();
+        _wallTurbViscIterator.iterate();
+      }
+    }
+
+    void readCheckpoint(int& timeStep, FLOAT& time){
+      Simulation::readCheckpoint(timeStep, time);
+      _timeStepRestored = true;
+      if (_parameters.turbulenceModel.updateThreshold > 0.0 && _turbViscAge >= 0) {
+        _strainRateStencil.restore();
+      }
     }
 
     void computeTurbVisc() {
         _turbViscIterator.iterate();
     }
 
-    void solveTimestep(FLOAT &_time_solve, FLOAT &_time_comm){
+    void solveTimestep(){
+      if (_spalartAllmarasStencil != NULL) {
+        solveSpalartAllmarasTimestep();
+        return;
+      }
 
-      // compute turbulent viscosity
-      _turbViscIterator.iterate();
+      // the turbulent viscosity, its ghost layers and its boundary values are kept between updates
+      _turbViscSteps++;
+      if (isTurbViscUpdateDue()) {
+        // compute turbulent viscosity
+        {
+          ScopedTimer timer(TimerTurbVisc);
+          _turbViscIterator.iterate();
+        }
+
+        // WS2: communicate turbulent viscosity values
+        {
+          ScopedTimer timer(TimerTurbViscComm);
+          _petscTurbParallelManager.communicateTurbViscosity();
+        }
+        // set global boundary values for the turbulent viscosity
+        {
+          ScopedTimer timer(TimerWallBoundaries);
+          _wallTurbViscIterator.iterate();
+        }
+        _turbViscUpdates++;
+      }
+      _turbViscAge++;
 
-      _timer_comm.start();
-      // WS2: communicate turbulent viscosity values
-      _petscTurbParallelManager.communicateTurbViscosity();
-      // set global boundary values for the turbulent viscosity
-      _time_comm += _timer_comm.getTimeAndContinue();
+      // the new timestep depends on the turbulent viscosity
+      setTimeStep();
 
-      _wallTurbViscIterator.iterate();
+      // the turbulent viscosity is kept over the stages of the Runge-Kutta scheme
+      advance();
+    }
+
+    /** Collective. Lets Rank0 print how often the turbulent viscosity has been updated and, if the
+     *  timers are active, the loop time saved by keeping it: the cost of a complete update, with
+     *  the strain rate, the mixing length and the communication, in every step, less the time
+     *  actually spent in updates and checks.
+     */
+    void printTurbViscUpdates(FLOAT loopTime){
+      if (_parameters.turbulenceModel.updateInterval == 1 && _parameters.turbulenceModel.updateThreshold == 0.0) {
+        return;
+      }
+      const TimerRegistry & timers = TimerRegistry::getInstance();
+      const FLOAT updateTime = timers.getTime(TimerTurbVisc) + timers.getTime(TimerTurbViscComm);
+      const FLOAT checkTime = timers.getTime(TimerTurbViscCheck);
+      FLOAT completeUpdate = _turbViscUpdates > 0 ? updateTime / _turbViscUpdates : 0.0;
+      if (_turbViscChecks > 0) {
+        completeUpdate += checkTime / _turbViscChecks;
+      }
+      const FLOAT saved = completeUpdate * _turbViscSteps - updateTime - checkTime;
+      FLOAT local[2] = {loopTime, saved}, global[2];
+      MPI_Reduce(local, global, 2, MY_MPI_FLOAT, MPI_MAX, 0, PETSC_COMM_WORLD);
+
+      int rank;
+      MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+      if (rank == 0) {
+        std::cout << "Turbulent viscosity updated in " << _turbViscUpdates << " of " << _turbViscSteps << " steps";
+        if (timers.isEnabled() && global[0] > 0.0) {
+          std::cout << ", " << global[1] << " s of the loop saved, throughput x" << (global[0] + global[1]) / global[0];
+        }
+        std::cout << std::endl;
+      }
+    }
+
+  protected:
+    /** Time step with the Spalart-Allmaras model. Its working variable advances by the last time
+     *  step of the flow, so that the new turbulent viscosity enters the time step of this one; the
+     *  first step takes the time step of the initial viscosity, or the one of the checkpoint when
+     *  restarting.
+     */
+    void solveSpalartAllmarasTimestep(){
+      _turbViscSteps++;
+      if (_turbViscUpdates == 0 && !_timeStepRestored) {
+        setTimeStep();
+      }
+      {
+        ScopedTimer timer(TimerTurbVisc);
+        _spalartAllmarasIterator->iterate();
+        _spalartAllmarasViscosityIterator->iterate();
+      }
+      {
+        ScopedTimer timer(TimerTurbViscComm);
+        _petscTurbParallelManager.communicateNuTilde();
+        _petscTurbParallelManager.communicateTurbViscosity();
+      }
+      {
+        ScopedTimer timer(TimerWallBoundaries);
+        _wallTurbViscIterator.iterate();
+      }
+      _turbViscUpdates++;
 
-      // the new timestep depends on the turbulent viscosity
       setTimeStep();
+      advance();
+    }
 
-      // compute fgh for turbulent case
+    /** Whether the turbulent viscosity is updated in this step. It is reconsidered every
+     *  updateInterval steps, and then updated unless the relative change of the strain rate since
+     *  the last update is below the threshold. All ranks decide alike, so that they skip the
+     *  communication together.
+     */
+    bool isTurbViscUpdateDue(){
+      if (_turbViscAge >= 0 && _turbViscAge < _parameters.turbulenceModel.updateInterval) {
+        return false;
+      }
+      const bool first = _turbViscAge < 0;
+      _turbViscAge = 0;
+      if (_parameters.turbulenceModel.updateThreshold == 0.0) {
+        return true;
+      }
+
+      ScopedTimer timer(TimerTurbViscCheck);
+      _turbViscChecks++;
+      _strainRateStencil.reset();
+      _strainRateIterator.iterate();
+      if (first || _strainRateStencil.getRelativeChange() > _parameters.turbulenceModel.updateThreshold) {
+        _strainRateStencil.accept();
+        return true;
+      }
+      return false;
+    }
+
+    /** computes FGH for the turbulent case */
+    void computeFGH(){
       _fghTurbIterator.iterate();
-      // set global boundary values
-      _wallFGHIterator.iterate();
-      // compute the right hand side
-      _rhsIterator.iterate();
-
-      _timer_solve.start();
-      // solve for pressure
-      _solver.solve();
-      _time_solve += _timer_solve.getTimeAndContinue();
-
-      _timer_comm.start();
-      // WS2: communicate pressure values
-      _petscParallelManager.communicatePressure();
-      _time_comm += _timer_comm.getTimeAndContinue();
-
-      // compute velocity
-      _velocityIterator.iterate();
-      // set obstacle boundaries
-      _obstacleIterator.iterate();
-
-      _timer_comm.start();
-      // WS2: communicate velocity values
-      _petscParallelManager.communicateVelocities();
-      _time_comm += _timer_comm.getTimeAndContinue();
-
-      // Iterate for velocities on the boundary
-      _wallVelocityIterator.iterate();
     }
 
-  protected:
     virtual void setTimeStep(){
       // iterate stencil MinDtStencil over all cells to find smallest dt from formula f
       // f: equation (12) from work sheet p.8, where Re=1/(nu+nuT)
       // then communicate time step to all ranks
+      ScopedTimer timer(TimerSetTimeStep);
+
+      if (_parameters.timestep.fixedDt) {
+        _parameters.timestep.dt = _parameters.timestep.maxDt;
+        return;
+      }
+      if (_parameters.steady.active) {
+        _parameters.timestep.dt = _steadyState.computeTimeSteps();
+        return;
+      }
 
       FLOAT localMin, globalMin;
 
-      // determine minimum timestep from viscosity
+      // determine minimum timestep from viscosity, unless the viscous terms are implicit
       _minDtStencil.reset();
-      _minDtIterator.iterate();
+      if (!_parameters.timestep.implicitViscosity) {
+        _minDtIterator.iterate();
+      }
       // determine maximum velocity
       _maxUStencil.reset();
       _maxUFieldIterator.iterate();
       _maxUBoundaryIterator.iterate();
 
-      localMin = std::min(_minDtStencil.getMinValue(), 1.0 / _maxUStencil.getMaxValues()[0]);
+      localMin = _parameters.timestep.implicitViscosity ? _parameters.timestep.maxDt : _minDtStencil.getMinValue();
+      localMin = std::min(localMin,                    1.0 / _maxUStencil.getMaxValues()[0]);
       localMin = std::min(localMin,                    1.0 / _maxUStencil.getMaxValues()[1]);
       if (_parameters.geometry.dim == 3) {
         localMin = std::min(localMin,                  1.0 / _maxUStencil.getMaxValues()[2]);
@@ -146,7 +318,11 @@ class TurbulentSimulation : public Simulation {
       // if (_parameters.simulation.scenario == "channel"){
         stencils[0] = new BFInputTurbViscosityStencil(_parameters);
         stencils[1] = new NeumannTurbViscosityBoundaryStencil(_parameters);
-        stencils[2] = new MovingWallTurbViscosityStencil(_parameters);
+        if (_parameters.turbulenceModel.wallFunctions) {
+          stencils[2] = new WallFunctionTurbViscosityStencil(_parameters);
+        } else {
+          stencils[2] = new MovingWallTurbViscosityStencil(_parameters);
+        }
         stencils[3] = stencils[2];
         stencils[4] = stencils[2];
         stencils[5] = stencils[2];
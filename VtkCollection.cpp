@@ -0,0 +1,73 @@
+#include "VtkCollection.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+static const char * COLLECTION_CLOSING = "  </Collection>\n</VTKFile>\n";
+
+VtkCollection::VtkCollection ( const std::string & prefix ) :
+    _fileName(prefix + ".pvd"),
+    _nameStart(prefix.find_last_of("/") == std::string::npos ? 0 : prefix.find_last_of("/") + 1),
+    _end(-1),
+    _lastTimeStep(-1),
+    _continuedTime(-1.0) {}
+
+
+void VtkCollection::continueAt ( FLOAT time ) {
+    _continuedTime = time;
+}
+
+
+void VtkCollection::open () {
+    // Entries of the run restarted from, whose times are written with ten digits
+    std::vector<std::string> kept;
+    if (_continuedTime >= 0.0) {
+        std::ifstream previous(_fileName.c_str());
+        std::string line;
+        while (std::getline(previous, line)) {
+            const size_t position = line.find("timestep=\"");
+            if (line.find("<DataSet") != std::string::npos && position != std::string::npos &&
+                atof(line.c_str() + position + 10) <= _continuedTime * (1.0 + 1e-9)) {
+                kept.push_back(line);
+            }
+        }
+        previous.close();
+    }
+
+    std::ofstream file(_fileName.c_str(), std::ios::out | std::ios::trunc);
+    file << "<?xml version=\"1.0\"?>" << std::endl;
+    file << "<VTKFile type=\"Collection\" version=\"0.1\">" << std::endl;
+    file << "  <Collection>" << std::endl;
+    for (unsigned int entry = 0; entry < kept.size(); entry++) {
+        file << kept[entry] << std::endl;
+    }
+    _end = file.tellp();
+    file << COLLECTION_CLOSING;
+    file.close();
+}
+
+
+void VtkCollection::add ( int timeStep, FLOAT time, const std::vector<std::string> & files ) {
+    if (timeStep == _lastTimeStep) {
+        return;
+    }
+    _lastTimeStep = timeStep;
+    if (_end < 0) {
+        open();
+    }
+
+    std::ostringstream entries;
+    for (unsigned int part = 0; part < files.size(); part++) {
+        entries << "    <DataSet timestep=\"" << std::setprecision(10) << time << "\" part=\"" << part
+                << "\" file=\"" << files[part].substr(_nameStart) << "\"/>" << std::endl;
+    }
+
+    // Overwrite the closing tags with the entries, the closing tags follow again
+    std::fstream file(_fileName.c_str(), std::ios::in | std::ios::out);
+    file.seekp(_end);
+    file << entries.str();
+    _end = file.tellp();
+    file << COLLECTION_CLOSING;
+    file.close();
+}
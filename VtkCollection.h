@@ -0,0 +1,46 @@
+#ifndef _VTK_COLLECTION_H_
+#define _VTK_COLLECTION_H_
+
+#include "Definitions.h"
+#include <string>
+#include <vector>
+
+/** Collection file prefix.pvd, which lists the files of the snapshots of a VTK output with their
+ *  times, so that ParaView opens them as a time series.
+ *
+ * The entries of a snapshot are appended in place of the closing tags, which are written again
+ * after them, so that adding a snapshot does not depend on the number of snapshots before it.
+ * A new run replaces an existing file, a restarted run keeps its entries up to the restart time.
+ */
+class VtkCollection {
+    private:
+
+        std::string _fileName;      //! Path of the collection file
+        size_t _nameStart;          //! Length of the directory part of the paths of the snapshots
+        long _end;                  //! Position of the closing tags, -1 before the first snapshot
+        int _lastTimeStep;          //! Time step of the last snapshot
+        FLOAT _continuedTime;       //! Entries of an existing file up to this time are kept, -1 for none
+
+        /** Writes the kept entries of an existing file, if any, and the closing tags */
+        void open ();
+
+    public:
+
+        /** @param prefix Prefix of the output, the collection being prefix.pvd next to the snapshots */
+        VtkCollection ( const std::string & prefix );
+
+        /** Continues the collection of the run restarted from, before the first snapshot is added
+         * @param time Restart time, up to which the existing entries are kept
+         */
+        void continueAt ( FLOAT time );
+
+        /** Lists the files of a snapshot, one per part. A repeated time step is ignored.
+         *
+         * @param timeStep Time step of the snapshot
+         * @param time Time of the snapshot
+         * @param files Paths of the files of the snapshot, listed relative to the collection
+         */
+        void add ( int timeStep, FLOAT time, const std::vector<std::string> & files );
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include "VtkOutput.h"
 #include "Iterators.h"
 #include <string>
+#include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
@@ -12,7 +13,11 @@ VtkOutput::VtkOutput ( FlowField & flowField, const Parameters & parameters ) :
   FieldStencil<FlowField>(parameters),
   _turbulent(parameters.simulation.type=="turbulence"),
   _flowField(flowField),
-  _postIterator(flowField,parameters,*this,1,0)
+  _turbFlowField(NULL),
+  _postIterator(flowField,parameters,*this,1,0),
+  _nTurbPostStencils(0),
+  _turbPostStencils(NULL),
+  _collection(parameters.vtk.prefix)
 {
     _nPostStencils = 2;
     _postStencils = new PostStencil<FlowField>*[_nPostStencils];
@@ -27,6 +32,18 @@ VtkOutput::VtkOutput ( FlowField & flowField, const Parameters & parameters ) :
       _turbPostStencils[0] = new TurbulentPostStencil(_parameters);
       _turbPostStencils[1] = new TurbulentWallPostStencil(_parameters); // only in channel/bfs scenarios
     }
+
+    // the post stencils keep their output arrays in single precision for the whole run
+    size_t bytes = 0;
+    for (int post = 0; post < _nPostStencils; post++) {
+      bytes += _postStencils[post]->getOutputBytes();
+    }
+    for (int post = 0; post < _nTurbPostStencils; post++) {
+      bytes += _turbPostStencils[post]->getOutputBytes();
+    }
+    if (_parameters.vtk.active && _parameters.parallel.rank == 0) {
+      std::cout << "VTK output arrays: " << bytes / 1024.0 << " KiB on rank 0" << std::endl;
+    }
 }
 
 VtkOutput::~VtkOutput (){
@@ -36,6 +53,8 @@ VtkOutput::~VtkOutput (){
   for (int i = 0; i < _nTurbPostStencils; i++) {
     delete _turbPostStencils[i];
   }
+  delete [] _postStencils;
+  delete [] _turbPostStencils;
 }
 
 
@@ -72,7 +91,46 @@ void VtkOutput::apply ( FlowField & flowField, int i, int j, int k ) {
     }
 }
 
-void VtkOutput::write ( int timeStep ) {
+void VtkOutput::encodeGrid () {
+    Meshsize *ms = _parameters.meshsize;
+    int nx = _flowField.getNx();
+    int ny = _flowField.getNy();
+    int nz = _parameters.geometry.dim == 2 ? 0 : _flowField.getNz();
+    const int nPoints = (nx+1)*(ny+1)*(nz+1);
+
+    std::ostringstream grid;
+    grid << "DATASET STRUCTURED_GRID" << std::endl;
+    grid << "DIMENSIONS " << nx+1 << " " << ny+1 << " " << nz+1 << std::endl;
+    grid << "POINTS " << nPoints << " float" << std::endl;
+
+    if (_parameters.geometry.dim == 2){
+        for (int j = 2; j < ny + 3; j++){
+            for (int i = 2; i < nx + 3; i++){
+                grid << ms->getPosX(i, j) << " " << ms->getPosY(i, j) << " 0" << std::endl;
+            }
+        }
+    }else if (_parameters.geometry.dim == 3){
+        for (int k = 2; k < nz + 3; k++){
+            for (int j = 2; j < ny + 3; j++){
+                for (int i = 2; i < nx + 3; i++){
+                    grid << ms->getPosX(i, j, k) << " " << ms->getPosY(i, j, k) << " " << ms->getPosZ(i, j, k) << std::endl;
+                }
+            }
+        }
+    }
+    _grid = grid.str();
+}
+
+std::string VtkOutput::getFileName ( int rank, int timeStep ) const {
+    std::ostringstream fileName;
+    fileName << _parameters.vtk.prefix
+             << "_" << std::setfill('0') << std::setw(4) << rank
+             << "." << std::setfill('0') << std::setw(6) << timeStep
+             << ".vtk";
+    return fileName.str();
+}
+
+void VtkOutput::write ( int timeStep, FLOAT time ) {
     // preapply the post stencils
     for (int post = 0; post < _nPostStencils; post++) {
       _postStencils[post]->preapply(_flowField);
@@ -87,49 +145,25 @@ void VtkOutput::write ( int timeStep ) {
     // iterate all post stencils by iterating "this"
     _postIterator.iterate();
 
-    Meshsize *ms = _parameters.meshsize;
+    if (_grid.empty()) {
+        encodeGrid();
+    }
     int nx = _flowField.getNx();
     int ny = _flowField.getNy();
     int nz = _parameters.geometry.dim == 2 ? 0 : _flowField.getNz();
-    const int nPoints = (nx+1)*(ny+1)*(nz+1);
     const int nCells = _parameters.geometry.dim == 2 ? nx*ny :  nx*ny*nz;
 
     // construct the file name and open the corresponding file
-    std::ostringstream fileName;
-    fileName << _parameters.vtk.prefix
-             << "_" << std::setfill('0') << std::setw(4) << _parameters.parallel.rank
-             << "." << std::setfill('0') << std::setw(6) << timeStep
-             << ".vtk";
     std::ofstream file;
-    file.open(fileName.str().c_str());
-    fileName.clear();
+    file.open(getFileName(_parameters.parallel.rank, timeStep).c_str());
 
     // write VTK header
     file << "# vtk DataFile Version 2.0" << std::endl;
     file << "NS-EOF output for rank = " << _parameters.parallel.rank << " and timestep = " << timeStep << std::endl;
     file << "ASCII\n" << std::endl;
 
-
     // write grid
-    file << "DATASET STRUCTURED_GRID" << std::endl;
-    file << "DIMENSIONS " << nx+1 << " " << ny+1 << " " << nz+1 << std::endl;
-    file << "POINTS " << nPoints << " float" << std::endl;
-
-    if (_parameters.geometry.dim == 2){
-        for (int j = 2; j < ny + 3; j++){
-            for (int i = 2; i < nx + 3; i++){
-                file << ms->getPosX(i, j) << " " << ms->getPosY(i, j) << " 0" << std::endl;
-            }
-        }
-    }else if (_parameters.geometry.dim == 3){
-        for (int k = 2; k < nz + 3; k++){
-            for (int j = 2; j < ny + 3; j++){
-                for (int i = 2; i < nx + 3; i++){
-                    file << ms->getPosX(i, j, k) << " " << ms->getPosY(i, j, k) << " " << ms->getPosZ(i, j, k) << std::endl;
-                }
-            }
-        }
-    }
+    file << _grid;
 
     file << "\nCELL_DATA " << nCells << std::endl;
 
@@ -147,4 +181,15 @@ void VtkOutput::write ( int timeStep ) {
 
     // finally, close the file
     file.close();
+
+    // list the snapshot in the time collection
+    if (_parameters.parallel.rank == 0) {
+        int nproc;
+        MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+        std::vector<std::string> files;
+        for (int rank = 0; rank < nproc; rank++) {
+            files.push_back(getFileName(rank, timeStep));
+        }
+        _collection.add(timeStep, time, files);
+    }
 }
@@ -8,9 +8,15 @@
 #include "Iterators.h"
 #include "TurbulentFlowField.h"
 #include "stencils/PostStencil.h"
+#include "VtkCollection.h"
+#include <string>
+#include <vector>
 
 /** WS1: Stencil for writing VTK files
  *
+ * Each rank writes its subdomain into one file per snapshot. The grid is encoded once and reused
+ * for all snapshots, and Rank0 lists the snapshots of all ranks with their times in the
+ * collection file prefix.pvd, which ParaView opens as a time series.
  */
 class VtkOutput : private FieldStencil<FlowField> {
     private:
@@ -27,6 +33,17 @@ class VtkOutput : private FieldStencil<FlowField> {
         PostStencil<FlowField> ** _postStencils;
         PostStencil<TurbulentFlowField> ** _turbPostStencils;
 
+        std::string _grid;      //! Encoded grid of this rank, computed at the first write
+        VtkCollection _collection;  //! Snapshots of all ranks, written by Rank0
+
+        /** Encodes the dataset, dimensions and points of the local grid. The mesh does not
+         *  change during a run, so this is only done once.
+         */
+        void encodeGrid ();
+
+        /** Name of the file of a rank for a snapshot */
+        std::string getFileName ( int rank, int timeStep ) const;
+
         void apply ( FlowField & flowField, int i, int j );
         void apply ( FlowField & flowField, int i, int j, int k);
 
@@ -40,11 +57,15 @@ class VtkOutput : private FieldStencil<FlowField> {
 
         ~VtkOutput();
 
+        /** Continues the collection of the run restarted from at the given time */
+        void continueCollection ( FLOAT time ) { _collection.continueAt(time); }
+
 
         /** Writes the information to the file
-         * @param flowField Flow field to be written
+         * @param timeStep Current time step, part of the file name
+         * @param time Current time, listed in the collection file
          */
-        void write ( int timeStep );
+        void write ( int timeStep, FLOAT time );
 
 };
 
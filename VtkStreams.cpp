@@ -0,0 +1,369 @@
+#include "VtkStreams.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+VtkStream::VtkStream ( FlowField & flowField, const Parameters & parameters, const VtkStreamParameters & stream ) :
+  _parameters(parameters),
+  _stream(stream),
+  _flowField(flowField),
+  _turbFlowField(parameters.simulation.type == "turbulence" ? (TurbulentFlowField*) &flowField : NULL),
+  _collection(stream.prefix)
+{}
+
+
+FLOAT VtkStream::getPosition ( int axis, int index ) const {
+    Meshsize * ms = _parameters.meshsize;
+    if (_parameters.geometry.dim == 2) {
+        return axis == 0 ? ms->getPosX(index, 2) : (axis == 1 ? ms->getPosY(2, index) : 0.0);
+    }
+    return axis == 0 ? ms->getPosX(index, 2, 2) : (axis == 1 ? ms->getPosY(2, index, 2) : ms->getPosZ(2, 2, index));
+}
+
+FLOAT VtkStream::getWidth ( int axis, int index ) const {
+    Meshsize * ms = _parameters.meshsize;
+    if (_parameters.geometry.dim == 2) {
+        return axis == 0 ? ms->getDx(index, 2) : (axis == 1 ? ms->getDy(2, index) : 1.0);
+    }
+    return axis == 0 ? ms->getDx(index, 2, 2) : (axis == 1 ? ms->getDy(2, index, 2) : ms->getDz(2, 2, index));
+}
+
+
+void VtkStream::getCellValues ( int i, int j, int k, FLOAT * values ) {
+    const int nValues = getNumberOfValues();
+    for (int q = 0; q < nValues; q++) {
+        values[q] = 0.0;
+    }
+
+    if (_parameters.geometry.dim == 2) {
+        if ((_flowField.getFlags().getValue(i, j) & OBSTACLE_SELF) != 0) {
+            return;
+        }
+        _flowField.getPressureAndVelocity(values[0], values + 1, i, j);
+        if (_turbFlowField != NULL) {
+            values[4] = _turbFlowField->getTurbViscosity().getScalar(i, j);
+        }
+    } else {
+        if ((_flowField.getFlags().getValue(i, j, k) & OBSTACLE_SELF) != 0) {
+            return;
+        }
+        _flowField.getPressureAndVelocity(values[0], values + 1, i, j, k);
+        if (_turbFlowField != NULL) {
+            values[4] = _turbFlowField->getTurbViscosity().getScalar(i, j, k);
+        }
+    }
+}
+
+
+std::string VtkStream::getFileName ( int part, int timeStep ) const {
+    std::ostringstream fileName;
+    fileName << _stream.prefix;
+    if (part >= 0) {
+        fileName << "_" << std::setfill('0') << std::setw(4) << part;
+    }
+    fileName << "." << std::setfill('0') << std::setw(6) << timeStep << ".vtk";
+    return fileName.str();
+}
+
+
+void VtkStream::writeHeader ( std::ostream & file, int timeStep ) const {
+    file << "# vtk DataFile Version 2.0" << std::endl;
+    file << "NS-EOF output for rank = " << _parameters.parallel.rank << " and timestep = " << timeStep << std::endl;
+    file << "ASCII\n" << std::endl;
+}
+
+
+void VtkStream::writeCellData ( std::ostream & file, const std::vector<FLOAT> & values, int nCells ) const {
+    const int nValues = getNumberOfValues();
+
+    file << "\nCELL_DATA " << nCells << std::endl;
+    file << "SCALARS pressure float 1" << std::endl;
+    file << "LOOKUP_TABLE default" << std::endl;
+    for (int cell = 0; cell < nCells; cell++) {
+        file << values[nValues*cell] << "\n";
+    }
+
+    file << "\nVECTORS velocity float" << std::endl;
+    for (int cell = 0; cell < nCells; cell++) {
+        const FLOAT * velocity = &values[nValues*cell + 1];
+        file << velocity[0] << " " << velocity[1] << " " << velocity[2] << "\n";
+    }
+
+    if (_turbFlowField != NULL) {
+        file << "\nSCALARS turbViscosity float 1" << std::endl;
+        file << "LOOKUP_TABLE default" << std::endl;
+        for (int cell = 0; cell < nCells; cell++) {
+            file << values[nValues*cell + 4] << "\n";
+        }
+    }
+}
+
+
+void VtkStream::addSnapshot ( int timeStep, FLOAT time, int nParts ) {
+    // the final snapshot may repeat the last one of the interval, which the collection ignores
+    std::vector<std::string> files;
+    for (int part = 0; part < nParts; part++) {
+        files.push_back(getFileName(nParts > 1 ? part : -1, timeStep));
+    }
+    _collection.add(timeStep, time, files);
+}
+
+
+
+VtkSliceStream::VtkSliceStream ( FlowField & flowField, const Parameters & parameters, const VtkStreamParameters & stream ) :
+  VtkStream(flowField, parameters, stream),
+  _communicator(MPI_COMM_NULL),
+  _layer(0)
+{
+    const int axis = _stream.axis;
+    _axes[0] = axis == 0 ? 1 : 0;
+    _axes[1] = axis == 2 ? 1 : 2;
+
+    // the slice belongs to the cell layer containing the position, the upper boundary of the
+    // domain to the last layer
+    const int size = _parameters.parallel.localSize[axis];
+    const bool last = _parameters.parallel.indices[axis] == _parameters.parallel.numProcessors[axis] - 1;
+    const FLOAT lower = getPosition(axis, 2);
+    const FLOAT upper = getPosition(axis, size + 2);
+    const int intersects = _stream.position >= lower &&
+                           (_stream.position < upper || (last && _stream.position == upper));
+
+    int intersecting = 0;
+    MPI_Allreduce(&intersects, &intersecting, 1, MPI_INT, MPI_SUM, PETSC_COMM_WORLD);
+    if (intersecting == 0) {
+        handleError(1, "The slice is outside of the domain");
+    }
+
+    MPI_Comm_split(PETSC_COMM_WORLD, intersects ? 0 : MPI_UNDEFINED, _parameters.parallel.rank, &_communicator);
+    if (_communicator == MPI_COMM_NULL) {
+        return;
+    }
+
+    _layer = 2;
+    while (_layer < size + 1 && getPosition(axis, _layer + 1) <= _stream.position) {
+        _layer++;
+    }
+
+    int subRank, subSize;
+    MPI_Comm_rank(_communicator, &subRank);
+    MPI_Comm_size(_communicator, &subSize);
+
+    int offsets[2], sizes[2];
+    for (int a = 0; a < 2; a++) {
+        offsets[a] = _parameters.parallel.firstCorner[_axes[a]];
+        sizes[a] = _localSize[a] = _parameters.parallel.localSize[_axes[a]];
+    }
+    _globalSize[0] = _axes[0] == 0 ? _parameters.geometry.sizeX : _parameters.geometry.sizeY;
+    _globalSize[1] = _axes[1] == 1 ? _parameters.geometry.sizeY : _parameters.geometry.sizeZ;
+    _values.resize(getNumberOfValues() * _localSize[0] * _localSize[1]);
+
+    if (subRank == 0) {
+        _offsets.resize(2 * subSize);
+        _sizes.resize(2 * subSize);
+    }
+    MPI_Gather(offsets, 2, MPI_INT, subRank == 0 ? &_offsets[0] : NULL, 2, MPI_INT, 0, _communicator);
+    MPI_Gather(sizes,   2, MPI_INT, subRank == 0 ? &_sizes[0]   : NULL, 2, MPI_INT, 0, _communicator);
+
+    // corner coordinates along the directions spanning the slice. The meshes are tensor products,
+    // so each rank contributes its part of the 1D coordinates; where the parts overlap, they agree.
+    std::vector<FLOAT> coordinates[2], globalCoordinates[2];
+    for (int a = 0; a < 2; a++) {
+        coordinates[a].assign(_globalSize[a] + 1, -MY_FLOAT_MAX);
+        for (int i = 2; i < _localSize[a] + 3; i++) {
+            coordinates[a][offsets[a] + i - 2] = getPosition(_axes[a], i);
+        }
+        globalCoordinates[a].resize(_globalSize[a] + 1);
+        MPI_Reduce(&coordinates[a][0], &globalCoordinates[a][0], _globalSize[a] + 1, MY_MPI_FLOAT,
+                   MPI_MAX, 0, _communicator);
+    }
+
+    if (subRank != 0) {
+        return;
+    }
+
+    _counts.resize(subSize);
+    _displacements.resize(subSize);
+    int total = 0;
+    for (int r = 0; r < subSize; r++) {
+        _counts[r] = getNumberOfValues() * _sizes[2*r] * _sizes[2*r+1];
+        _displacements[r] = total;
+        total += _counts[r];
+    }
+    _gathered.resize(total);
+    _slice.resize(getNumberOfValues() * _globalSize[0] * _globalSize[1]);
+
+    // the slice lies at the centre of its cell layer
+    const FLOAT centre = getPosition(axis, _layer) + 0.5 * getWidth(axis, _layer);
+    std::ostringstream grid;
+    grid << "DATASET STRUCTURED_GRID" << std::endl;
+    grid << "DIMENSIONS " << _globalSize[0] + 1 << " " << _globalSize[1] + 1 << " 1" << std::endl;
+    grid << "POINTS " << (_globalSize[0] + 1) * (_globalSize[1] + 1) << " float" << std::endl;
+    for (int j = 0; j < _globalSize[1] + 1; j++) {
+        for (int i = 0; i < _globalSize[0] + 1; i++) {
+            FLOAT point[3];
+            point[axis] = centre;
+            point[_axes[0]] = globalCoordinates[0][i];
+            point[_axes[1]] = globalCoordinates[1][j];
+            grid << point[0] << " " << point[1] << " " << point[2] << std::endl;
+        }
+    }
+    _grid = grid.str();
+}
+
+VtkSliceStream::~VtkSliceStream () {
+    if (_communicator != MPI_COMM_NULL) {
+        MPI_Comm_free(&_communicator);
+    }
+}
+
+
+void VtkSliceStream::write ( int timeStep, FLOAT time ) {
+    if (_communicator == MPI_COMM_NULL) {
+        return;
+    }
+
+    const int nValues = getNumberOfValues();
+    int index[3];
+    index[_stream.axis] = _layer;
+    for (int j = 0; j < _localSize[1]; j++) {
+        for (int i = 0; i < _localSize[0]; i++) {
+            index[_axes[0]] = i + 2;
+            index[_axes[1]] = j + 2;
+            getCellValues(index[0], index[1], index[2], &_values[nValues * (i + _localSize[0] * j)]);
+        }
+    }
+
+    int subRank;
+    MPI_Comm_rank(_communicator, &subRank);
+    MPI_Gatherv(&_values[0], _values.size(), MY_MPI_FLOAT,
+                subRank == 0 ? &_gathered[0] : NULL, subRank == 0 ? &_counts[0] : NULL,
+                subRank == 0 ? &_displacements[0] : NULL, MY_MPI_FLOAT, 0, _communicator);
+    if (subRank != 0) {
+        return;
+    }
+
+    // place the parts of the ranks into the slice
+    for (unsigned int r = 0; r < _counts.size(); r++) {
+        const FLOAT * part = &_gathered[_displacements[r]];
+        for (int j = 0; j < _sizes[2*r+1]; j++) {
+            for (int i = 0; i < _sizes[2*r]; i++) {
+                const int cell = (_offsets[2*r] + i) + _globalSize[0] * (_offsets[2*r+1] + j);
+                std::copy(part + nValues * (i + _sizes[2*r] * j), part + nValues * (i + _sizes[2*r] * j + 1),
+                          &_slice[nValues * cell]);
+            }
+        }
+    }
+
+    std::ofstream file;
+    file.open(getFileName(-1, timeStep).c_str());
+    writeHeader(file, timeStep);
+    file << _grid;
+    writeCellData(file, _slice, _globalSize[0] * _globalSize[1]);
+    file.close();
+
+    addSnapshot(timeStep, time, 1);
+}
+
+
+
+VtkDownsampledStream::VtkDownsampledStream ( FlowField & flowField, const Parameters & parameters, const VtkStreamParameters & stream ) :
+  VtkStream(flowField, parameters, stream)
+{
+    const int dim = _parameters.geometry.dim;
+    for (int d = 0; d < 3; d++) {
+        _blocks[d] = d < dim ? (_parameters.parallel.localSize[d] + _stream.factor - 1) / _stream.factor : 1;
+    }
+    _values.resize(getNumberOfValues() * _blocks[0] * _blocks[1] * _blocks[2]);
+
+    // corners of the blocks
+    std::ostringstream grid;
+    grid << "DATASET STRUCTURED_GRID" << std::endl;
+    grid << "DIMENSIONS " << _blocks[0] + 1 << " " << _blocks[1] + 1 << " " << (dim == 3 ? _blocks[2] + 1 : 1) << std::endl;
+    grid << "POINTS " << (_blocks[0] + 1) * (_blocks[1] + 1) * (dim == 3 ? _blocks[2] + 1 : 1) << " float" << std::endl;
+    for (int k = 0; k < (dim == 3 ? _blocks[2] + 1 : 1); k++) {
+        for (int j = 0; j < _blocks[1] + 1; j++) {
+            for (int i = 0; i < _blocks[0] + 1; i++) {
+                grid << getPosition(0, getBlockStart(0, i)) << " " << getPosition(1, getBlockStart(1, j)) << " "
+                     << (dim == 3 ? getPosition(2, getBlockStart(2, k)) : 0.0) << std::endl;
+            }
+        }
+    }
+    _grid = grid.str();
+}
+
+
+int VtkDownsampledStream::getBlockStart ( int axis, int block ) const {
+    return std::min(2 + block * _stream.factor, 2 + _parameters.parallel.localSize[axis]);
+}
+
+
+void VtkDownsampledStream::write ( int timeStep, FLOAT time ) {
+    const int dim = _parameters.geometry.dim;
+    const int nValues = getNumberOfValues();
+    FLOAT cellValues[5];
+
+    for (int bk = 0; bk < _blocks[2]; bk++) {
+        for (int bj = 0; bj < _blocks[1]; bj++) {
+            for (int bi = 0; bi < _blocks[0]; bi++) {
+                FLOAT * values = &_values[nValues * (bi + _blocks[0] * (bj + _blocks[1] * bk))];
+                const int startK = dim == 3 ? getBlockStart(2, bk) : 2;
+                const int endK   = dim == 3 ? getBlockStart(2, bk + 1) : 3;
+
+                if (!_stream.average) {
+                    getCellValues(getBlockStart(0, bi), getBlockStart(1, bj), startK, values);
+                    continue;
+                }
+
+                // volume average over the fluid cells of the block
+                FLOAT volume = 0.0;
+                for (int q = 0; q < nValues; q++) {
+                    values[q] = 0.0;
+                }
+                for (int k = startK; k < endK; k++) {
+                    for (int j = getBlockStart(1, bj); j < getBlockStart(1, bj + 1); j++) {
+                        for (int i = getBlockStart(0, bi); i < getBlockStart(0, bi + 1); i++) {
+                            const int obstacle = dim == 3 ? _flowField.getFlags().getValue(i, j, k)
+                                                          : _flowField.getFlags().getValue(i, j);
+                            if ((obstacle & OBSTACLE_SELF) != 0) {
+                                continue;
+                            }
+                            const FLOAT cellVolume = getWidth(0, i) * getWidth(1, j) * (dim == 3 ? getWidth(2, k) : 1.0);
+                            getCellValues(i, j, k, cellValues);
+                            for (int q = 0; q < nValues; q++) {
+                                values[q] += cellVolume * cellValues[q];
+                            }
+                            volume += cellVolume;
+                        }
+                    }
+                }
+                if (volume > 0.0) {
+                    for (int q = 0; q < nValues; q++) {
+                        values[q] /= volume;
+                    }
+                }
+            }
+        }
+    }
+
+    std::ofstream file;
+    file.open(getFileName(_parameters.parallel.rank, timeStep).c_str());
+    writeHeader(file, timeStep);
+    file << _grid;
+    writeCellData(file, _values, _blocks[0] * _blocks[1] * _blocks[2]);
+    file.close();
+
+    if (_parameters.parallel.rank == 0) {
+        int nproc;
+        MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+        addSnapshot(timeStep, time, nproc);
+    }
+}
+
+
+VtkStream * createVtkStream ( FlowField & flowField, const Parameters & parameters, const VtkStreamParameters & stream ) {
+    if (stream.type == VtkSlice) {
+        return new VtkSliceStream(flowField, parameters, stream);
+    }
+    return new VtkDownsampledStream(flowField, parameters, stream);
+}
@@ -0,0 +1,131 @@
+#ifndef _VTK_STREAMS_H_
+#define _VTK_STREAMS_H_
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "FlowField.h"
+#include "TurbulentFlowField.h"
+#include "VtkCollection.h"
+#include <string>
+#include <vector>
+#include <ostream>
+
+/** Reduced VTK output, written besides or instead of the full VtkOutput
+ *
+ * Each stream has its own prefix and interval and writes the pressure, the cell-centred velocity
+ * and, for turbulent simulations, the turbulent viscosity as legacy ASCII VTK files, listed with
+ * their times in the collection file prefix.pvd.
+ */
+class VtkStream {
+    protected:
+
+        const Parameters & _parameters;
+        const VtkStreamParameters & _stream;
+        FlowField & _flowField;
+        TurbulentFlowField * _turbFlowField;    //! NULL in DNS
+
+        VtkCollection _collection;  //! Snapshots of the stream, written by the rank writing the first part
+
+        /** Values per cell: pressure, three velocity components and nu_t if turbulent */
+        int getNumberOfValues () const { return _turbFlowField != NULL ? 5 : 4; }
+
+        /** Lower coordinate of the local cell with the given index along an axis */
+        FLOAT getPosition ( int axis, int index ) const;
+
+        /** Width of the local cell with the given index along an axis */
+        FLOAT getWidth ( int axis, int index ) const;
+
+        /** Writes the values of a cell to values, zeros in obstacle cells */
+        void getCellValues ( int i, int j, int k, FLOAT * values );
+
+        /** Name of a file of a snapshot. Part is the rank for files per rank, or -1 */
+        std::string getFileName ( int part, int timeStep ) const;
+
+        /** Writes the header of a VTK file */
+        void writeHeader ( std::ostream & file, int timeStep ) const;
+
+        /** Writes the cell data of the given number of cells, stored interleaved */
+        void writeCellData ( std::ostream & file, const std::vector<FLOAT> & values, int nCells ) const;
+
+        /** Adds a snapshot to the collection file, which lists nParts files per snapshot */
+        void addSnapshot ( int timeStep, FLOAT time, int nParts );
+
+    public:
+
+        VtkStream ( FlowField & flowField, const Parameters & parameters, const VtkStreamParameters & stream );
+        virtual ~VtkStream () {}
+
+        /** Continues the collection of the run restarted from at the given time */
+        void continueCollection ( FLOAT time ) { _collection.continueAt(time); }
+
+        /** Writes a snapshot
+         *
+         * @param timeStep Current time step, part of the file name
+         * @param time Current time, listed in the collection file
+         */
+        virtual void write ( int timeStep, FLOAT time ) = 0;
+};
+
+
+/** Axis-aligned slice through the cell layer containing the given position
+ *
+ * Only the ranks intersecting the slice take part. They are grouped in a sub-communicator, whose
+ * first rank gathers the slice and writes it as a single file per snapshot. 3D only.
+ */
+class VtkSliceStream : public VtkStream {
+    private:
+
+        MPI_Comm _communicator;     //! Ranks intersecting the slice, MPI_COMM_NULL elsewhere
+        int _axes[2];               //! Directions spanning the slice, the first one fastest
+        int _layer;                 //! Local index of the cell layer along the normal direction
+        int _localSize[2];          //! Local cells along the directions spanning the slice
+        int _globalSize[2];         //! Global cells along the directions spanning the slice
+
+        std::vector<int> _offsets;  //! Global index of the first cell of each rank, two per rank
+        std::vector<int> _sizes;    //! Local cells of each rank along the slice, two per rank
+        std::vector<int> _counts;   //! Values sent by each rank
+        std::vector<int> _displacements;
+
+        std::vector<FLOAT> _values;     //! Local part of the slice
+        std::vector<FLOAT> _gathered;   //! Local parts of all ranks, one after the other
+        std::vector<FLOAT> _slice;      //! Assembled slice
+        std::string _grid;              //! Encoded grid of the slice
+
+    public:
+
+        VtkSliceStream ( FlowField & flowField, const Parameters & parameters, const VtkStreamParameters & stream );
+        ~VtkSliceStream ();
+
+        void write ( int timeStep, FLOAT time );
+};
+
+
+/** Coarsened view of the flow field
+ *
+ * The local cells of each rank are grouped in blocks of factor cells per dimension, aligned with
+ * the first cell of the subdomain; the last block along a dimension may be smaller. A block either
+ * takes the values of its first cell (stride) or the volume average over its fluid cells. Each
+ * rank writes its blocks into one file per snapshot.
+ */
+class VtkDownsampledStream : public VtkStream {
+    private:
+
+        int _blocks[3];             //! Blocks per dimension (1 along z in 2D)
+        std::vector<FLOAT> _values;
+        std::string _grid;          //! Encoded grid of the blocks
+
+        /** Local index of the first cell of a block along an axis, or the end for _blocks */
+        int getBlockStart ( int axis, int block ) const;
+
+    public:
+
+        VtkDownsampledStream ( FlowField & flowField, const Parameters & parameters, const VtkStreamParameters & stream );
+
+        void write ( int timeStep, FLOAT time );
+};
+
+
+/** Creates the stream of the given parameters */
+VtkStream * createVtkStream ( FlowField & flowField, const Parameters & parameters, const VtkStreamParameters & stream );
+
+#endif
@@ -0,0 +1,239 @@
+#include "WallDistance.h"
+#include <algorithm>
+#include <math.h>
+
+WallDistance::WallDistance ( const Parameters & parameters, TurbulentFlowField & turbFlowField,
+                             PetscTurbulentParallelManager & parallelManager ) :
+    _parameters(parameters),
+    _turbFlowField(turbFlowField),
+    _parallelManager(parallelManager)
+{
+    const BoundaryType types[6] = {parameters.walls.typeLeft, parameters.walls.typeRight, parameters.walls.typeBottom,
+                                   parameters.walls.typeTop, parameters.walls.typeFront, parameters.walls.typeBack};
+    const int neighbours[6] = {parameters.parallel.leftNb, parameters.parallel.rightNb, parameters.parallel.bottomNb,
+                               parameters.parallel.topNb, parameters.parallel.frontNb, parameters.parallel.backNb};
+    for (int boundary = 0; boundary < 6; boundary++) {
+        _walls[boundary] = neighbours[boundary] < 0 && types[boundary] == DIRICHLET &&
+                           (boundary > 0 || parameters.simulation.scenario != "channel");
+    }
+}
+
+
+int WallDistance::getCells ( int dimension ) const {
+    return dimension == 0 ? _turbFlowField.getCellsX() :
+          (dimension == 1 ? _turbFlowField.getCellsY() : _turbFlowField.getCellsZ());
+}
+
+
+FLOAT WallDistance::getSpacing ( int dimension, const int index[3] ) const {
+    const Meshsize * ms = _parameters.meshsize;
+    if (_parameters.geometry.dim == 2) {
+        return dimension == 0 ? ms->getDx(index[0], index[1]) : ms->getDy(index[0], index[1]);
+    }
+    return dimension == 0 ? ms->getDx(index[0], index[1], index[2]) :
+          (dimension == 1 ? ms->getDy(index[0], index[1], index[2]) : ms->getDz(index[0], index[1], index[2]));
+}
+
+
+FLOAT WallDistance::getWallDistance ( const int index[3] ) {
+    IntScalarField & flags = _turbFlowField.getFlags();
+    FLOAT distance = MY_FLOAT_MAX;
+    for (int d = 0; d < _parameters.geometry.dim; d++) {
+        for (int side = 0; side < 2; side++) {
+            int neighbour[3] = {index[0], index[1], index[2]};
+            neighbour[d] += side == 0 ? -1 : 1;
+            const bool globalWall = side == 0 ? neighbour[d] < 2 && _walls[2 * d]
+                                              : neighbour[d] > getCells(d) - 2 && _walls[2 * d + 1];
+            if (globalWall || (flags.getValue(neighbour[0], neighbour[1], neighbour[2]) & OBSTACLE_SELF)) {
+                distance = std::min(distance, 0.5 * getSpacing(d, index));
+            }
+        }
+    }
+    return distance;
+}
+
+
+FLOAT WallDistance::solve ( FLOAT values[3], FLOAT widths[3], int count ) {
+    // sort the neighbours by their distance
+    for (int a = 1; a < count; a++) {
+        for (int b = a; b > 0 && values[b] < values[b - 1]; b--) {
+            std::swap(values[b], values[b - 1]);
+            std::swap(widths[b], widths[b - 1]);
+        }
+    }
+
+    // solve sum_d ((u - value_d)/width_d)^2 = 1 with the neighbours below u
+    FLOAT A = 0.0, B = 0.0, C = 0.0, solution = MY_FLOAT_MAX;
+    for (int n = 0; n < count; n++) {
+        const FLOAT weight = 1.0 / (widths[n] * widths[n]);
+        A += weight;
+        B += weight * values[n];
+        C += weight * values[n] * values[n];
+        const FLOAT discriminant = B * B - A * (C - 1.0);
+        if (discriminant < 0.0) {
+            break;
+        }
+        solution = (B + sqrt(discriminant)) / A;
+        if (n + 1 == count || solution <= values[n + 1]) {
+            break;
+        }
+    }
+    return solution;
+}
+
+
+bool WallDistance::update ( const int index[3] ) {
+    const int dim = _parameters.geometry.dim;
+    IntScalarField & flags = _turbFlowField.getFlags();
+    ScalarField & distance = _turbFlowField.getDistNearestWall();
+
+    // both neighbours of each dimension; the walls of obstacles and global boundaries are already
+    // part of the initial distance
+    FLOAT values[3][2], widths[3][2];
+    int sides[3];
+    for (int d = 0; d < dim; d++) {
+        sides[d] = 0;
+        for (int side = 0; side < 2; side++) {
+            int neighbour[3] = {index[0], index[1], index[2]};
+            neighbour[d] += side == 0 ? -1 : 1;
+            const FLOAT value = distance.getScalar(neighbour[0], neighbour[1], neighbour[2]);
+            if (value == MY_FLOAT_MAX || (flags.getValue(neighbour[0], neighbour[1], neighbour[2]) & OBSTACLE_SELF)) {
+                continue;
+            }
+            values[d][sides[d]] = value;
+            widths[d][sides[d]] = 0.5 * (getSpacing(d, index) + getSpacing(d, neighbour));
+            sides[d]++;
+        }
+    }
+
+    // on the stretched mesh, the upwind neighbour of a dimension is the one with the larger
+    // difference quotient at the solution. As each choice bounds the solution from above, the
+    // solution is the smallest one over all choices of one neighbour per dimension.
+    FLOAT solution = MY_FLOAT_MAX;
+    int choice[3] = {0, 0, 0};
+    while (true) {
+        FLOAT chosenValues[3], chosenWidths[3];
+        int count = 0;
+        for (int d = 0; d < dim; d++) {
+            if (sides[d] > 0) {
+                chosenValues[count] = values[d][choice[d]];
+                chosenWidths[count] = widths[d][choice[d]];
+                count++;
+            }
+        }
+        if (count == 0) {
+            return false;
+        }
+        solution = std::min(solution, solve(chosenValues, chosenWidths, count));
+
+        // next choice
+        int d = 0;
+        while (d < dim && (sides[d] == 0 || choice[d] == sides[d] - 1)) {
+            choice[d] = 0;
+            d++;
+        }
+        if (d == dim) {
+            break;
+        }
+        choice[d]++;
+    }
+
+    FLOAT & current = distance.getScalar(index[0], index[1], index[2]);
+    if (solution < current) {
+        current = solution;
+        return true;
+    }
+    return false;
+}
+
+
+int WallDistance::sweep () {
+    const int dim = _parameters.geometry.dim;
+    IntScalarField & flags = _turbFlowField.getFlags();
+    int changed = 0;
+
+    // the bits of the ordering give the direction along each dimension
+    for (int ordering = 0; ordering < (1 << dim); ordering++) {
+        int first[3] = {0, 0, 0}, step[3] = {1, 1, 1}, count[3] = {1, 1, 1};
+        for (int d = 0; d < dim; d++) {
+            count[d] = getCells(d) - 3;
+            first[d] = (ordering >> d) & 1 ? getCells(d) - 2 : 2;
+            step[d]  = (ordering >> d) & 1 ? -1 : 1;
+        }
+        int index[3];
+        for (int k = 0; k < count[2]; k++) {
+            index[2] = first[2] + k * step[2];
+            for (int j = 0; j < count[1]; j++) {
+                index[1] = first[1] + j * step[1];
+                for (int i = 0; i < count[0]; i++) {
+                    index[0] = first[0] + i * step[0];
+                    if ((flags.getValue(index[0], index[1], index[2]) & OBSTACLE_SELF) == 0 && update(index)) {
+                        changed++;
+                    }
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+
+int WallDistance::compute () {
+    const int dim = _parameters.geometry.dim;
+    const int cellsZ = dim == 3 ? getCells(2) : 1;
+    IntScalarField & flags = _turbFlowField.getFlags();
+    ScalarField & distance = _turbFlowField.getDistNearestWall();
+
+    // the fluid cells next to walls start from the distance to them, the obstacles from zero
+    int index[3];
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < getCells(1); j++) {
+            for (int i = 0; i < getCells(0); i++) {
+                index[0] = i; index[1] = j; index[2] = k;
+                bool inner = true;
+                for (int d = 0; d < dim; d++) {
+                    inner = inner && index[d] >= 2 && index[d] <= getCells(d) - 2;
+                }
+                if (!inner) {
+                    distance.getScalar(i, j, k) = MY_FLOAT_MAX;
+                } else if (flags.getValue(i, j, k) & OBSTACLE_SELF) {
+                    distance.getScalar(i, j, k) = 0.0;
+                } else {
+                    distance.getScalar(i, j, k) = getWallDistance(index);
+                }
+            }
+        }
+    }
+
+    // until the distances of all ranks are consistent with the ghost layers of the last exchange
+    int rounds = 0, changed = 0;
+    do {
+        _parallelManager.communicateDistNearestWall();
+        const int localChanged = sweep();
+        MPI_Allreduce(&localChanged, &changed, 1, MPI_INT, MPI_SUM, PETSC_COMM_WORLD);
+        rounds++;
+    } while (changed > 0);
+
+    // the global ghost cells lie in the walls or outside the domain
+    int unreached = 0;
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < getCells(1); j++) {
+            for (int i = 0; i < getCells(0); i++) {
+                if (distance.getScalar(i, j, k) == MY_FLOAT_MAX) {
+                    index[0] = i; index[1] = j; index[2] = k;
+                    bool inner = true;
+                    for (int d = 0; d < dim; d++) {
+                        inner = inner && index[d] >= 2 && index[d] <= getCells(d) - 2;
+                    }
+                    unreached += inner ? 1 : 0;
+                    distance.getScalar(i, j, k) = 0.0;
+                }
+            }
+        }
+    }
+    _parallelManager.communicateDistNearestWall();
+    if (unreached > 0) {
+        handleError(1, "The wall distance needs a wall in every connected fluid region");
+    }
+    return rounds;
+}
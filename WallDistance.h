@@ -0,0 +1,70 @@
+#ifndef _WALL_DISTANCE_H_
+#define _WALL_DISTANCE_H_
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "TurbulentFlowField.h"
+#include "parallelManagers/PetscTurbulentParallelManager.h"
+
+/** Distance to the nearest wall for any geometry, as the solution of the eikonal equation
+ *  |grad d| = 1 with d = 0 on the walls, by fast sweeping.
+ *
+ * The walls are the faces of the obstacle cells and the global boundaries with a Dirichlet
+ * condition for the velocity, except for the inflow of the channel. A fluid cell next to a wall
+ * starts from half its width normal to the wall, all others from infinity. A sweep visits the
+ * inner cells in one of the 2^dim orderings and lowers the distance of each fluid cell to the
+ * first-order upwind solution from its neighbours, with the distances of the cell centres of the
+ * stretched mesh. After the sweeps of all orderings, the ranks exchange their ghost layers, until
+ * no distance changes on any rank. Distances to walls normal to the axes are exact; near corners,
+ * the first-order scheme overestimates them by a fraction of the mesh width.
+ */
+class WallDistance {
+
+    private:
+
+        const Parameters & _parameters;
+        TurbulentFlowField & _turbFlowField;
+        PetscTurbulentParallelManager & _parallelManager;
+
+        bool _walls[6];     //! Whether the global boundaries (left, right, bottom, top, front, back) are walls
+
+        /** Number of cells (inner and ghost) along a dimension */
+        int getCells ( int dimension ) const;
+
+        /** Mesh width of the cell along a dimension */
+        FLOAT getSpacing ( int dimension, const int index[3] ) const;
+
+        /** Distance of the centre of a fluid cell to the walls at its faces, infinite if none */
+        FLOAT getWallDistance ( const int index[3] );
+
+        /** Solution of the upwind discretisation with the given neighbours, one per dimension,
+         *  by their distances and the distances of their centres
+         */
+        FLOAT solve ( FLOAT values[3], FLOAT widths[3], int count );
+
+        /** Lowers the distance of a fluid cell to the upwind solution from its neighbours and
+         *  returns whether it changed
+         */
+        bool update ( const int index[3] );
+
+        /** Sweeps the inner cells in all orderings and returns the number of changed distances */
+        int sweep ();
+
+    public:
+
+        /** Constructor
+         *
+         * @param parameters Parameters of the problem
+         * @param turbFlowField Flow field with the flags and the distances
+         * @param parallelManager Communication of the ghost layers of the distances
+         */
+        WallDistance ( const Parameters & parameters, TurbulentFlowField & turbFlowField,
+                       PetscTurbulentParallelManager & parallelManager );
+
+        /** Collective. Computes the distances of all fluid cells, zero in the obstacle and the
+         *  global ghost cells, and returns the number of rounds of sweeps
+         */
+        int compute ();
+};
+
+#endif
@@ -0,0 +1,340 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Configuration.h"
+#include "MeshsizeFactory.h"
+#include "TurbulentFlowField.h"
+#include "Iterators.h"
+#include "parallelManagers/PetscParallelConfiguration.h"
+#include "stencils/FGHStencil.h"
+#include "stencils/FGHTurbStencil.h"
+#include "stencils/RHSStencil.h"
+#include "stencils/VelocityStencil.h"
+#include "stencils/ObstacleStencil.h"
+#include "stencils/MaxUStencil.h"
+#include "stencils/MinDtStencil.h"
+#include "stencils/TurbViscosityStencil.h"
+#include "stencils/PressureBufferFillStencil.h"
+#include "stencils/PressureBufferReadStencil.h"
+#include "stencils/VelocityBufferFillStencil.h"
+#include "stencils/VelocityBufferReadStencil.h"
+#include "stencils/TurbViscosityBufferFillStencil.h"
+#include "stencils/TurbViscosityBufferReadStencil.h"
+
+/** Micro-benchmarks of the stencils of a time step. Replaces the gprof dump in misc/analysis.txt.
+ *
+ * Usage: mpirun -np 1 ./ns_bench configuration.xml [options], or make bench for the whole suite
+ *
+ *   -dim 2|3          Overrides the dimension of the configuration
+ *   -size nx ny nz    Cells of the synthetic field (default: the size of the configuration)
+ *   -mesh uniform|stretched
+ *                     Overrides the mesh of the configuration; stretched refines towards the
+ *                     walls in y (and z in 3D), like the turbulent channel
+ *   -time seconds     Minimum run time of each stencil (default 0.5)
+ *
+ * The configuration provides the flow parameters and the turbulence model; it has
+ * to describe a turbulent simulation. The fields are synthetic (smooth velocity and pressure, all
+ * cells fluid) and the benchmark runs on a single process, with all faces of the subdomain treated
+ * as parallel boundaries for the buffer stencils.
+ *
+ * For each stencil, the time per cell is reported together with the achieved bandwidth and flop
+ * rate. Both are estimates: the bytes per cell are the compulsory traffic of the fields read and
+ * written, assuming that the neighbours of a cell stay in the cache, and the flops per cell are
+ * counted from the expressions in StencilFunctions.h, with divisions, pow and fabs as one flop.
+ */
+
+//! Options of the benchmark
+struct BenchOptions {
+    int dim;
+    int size[3];
+    int mesh;           //! -1 to keep the mesh of the configuration
+    double minTime;
+};
+
+//! Estimated cost of one application of a stencil
+struct StencilCost {
+    double bytes;
+    double flops;
+};
+
+static void parseOptions ( int argc, char * argv[], const Parameters & parameters, BenchOptions & options ) {
+    options.dim = parameters.geometry.dim;
+    options.size[0] = parameters.geometry.sizeX;
+    options.size[1] = parameters.geometry.sizeY;
+    options.size[2] = parameters.geometry.sizeZ;
+    options.mesh = -1;
+    options.minTime = 0.5;
+
+    for (int arg = 2; arg < argc; arg++) {
+        const std::string option(argv[arg]);
+        if (option == "-dim" && arg + 1 < argc) {
+            options.dim = atoi(argv[++arg]);
+            if (options.dim != 2 && options.dim != 3) {
+                handleError(1, "The dimension has to be 2 or 3");
+            }
+        } else if (option == "-size" && arg + 3 < argc) {
+            for (int d = 0; d < 3; d++) {
+                options.size[d] = atoi(argv[++arg]);
+            }
+        } else if (option == "-mesh" && arg + 1 < argc) {
+            const std::string mesh(argv[++arg]);
+            if (mesh == "uniform") {
+                options.mesh = Uniform;
+            } else if (mesh == "stretched") {
+                options.mesh = TanhStretching;
+            } else {
+                handleError(1, "Unknown mesh, expected uniform or stretched");
+            }
+        } else if (option == "-time" && arg + 1 < argc) {
+            options.minTime = atof(argv[++arg]);
+        } else {
+            handleError(1, "Unknown option. Usage: ns_bench configuration.xml [-dim 2|3] [-size nx ny nz] [-mesh uniform|stretched] [-time seconds]");
+        }
+    }
+
+    for (int d = 0; d < options.dim; d++) {
+        if (options.size[d] < 2) {
+            handleError(1, "The benchmark needs at least two cells per dimension");
+        }
+    }
+}
+
+
+/** Fills all cells, including the ghost layers, with a smooth synthetic state */
+static void initializeFields ( TurbulentFlowField & flowField, const Parameters & parameters ) {
+    const bool is3D = parameters.geometry.dim == 3;
+    const int cellsZ = is3D ? flowField.getCellsZ() : 1;
+    const FLOAT pi = 4.0 * atan(1.0);
+
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < flowField.getCellsY(); j++) {
+            for (int i = 0; i < flowField.getCellsX(); i++) {
+                const FLOAT x = (FLOAT) i / flowField.getCellsX();
+                const FLOAT y = (FLOAT) j / flowField.getCellsY();
+                const FLOAT z = (FLOAT) k / cellsZ;
+                FLOAT * velocity = is3D ? flowField.getVelocity().getVector(i, j, k)
+                                        : flowField.getVelocity().getVector(i, j);
+                velocity[0] = 1.0 + 0.1 * sin(2 * pi * y) * cos(2 * pi * z);
+                velocity[1] = 0.1 * sin(2 * pi * x) * cos(2 * pi * z);
+                if (is3D) {
+                    velocity[2] = 0.1 * sin(2 * pi * x) * cos(2 * pi * y);
+                }
+                const FLOAT pressure = 1.0 - x;
+                const FLOAT distance = std::min(y, 1 - y) + 0.5 / flowField.getCellsY();
+                if (is3D) {
+                    flowField.getPressure().getScalar(i, j, k) = pressure;
+                    flowField.getTurbViscosity().getScalar(i, j, k) = 1.0e-3 * distance;
+                    flowField.getDistNearestWall().getScalar(i, j, k) = distance;
+                    flowField.getFlags().getValue(i, j, k) = 0;
+                } else {
+                    flowField.getPressure().getScalar(i, j) = pressure;
+                    flowField.getTurbViscosity().getScalar(i, j) = 1.0e-3 * distance;
+                    flowField.getDistNearestWall().getScalar(i, j) = distance;
+                    flowField.getFlags().getValue(i, j) = 0;
+                }
+            }
+        }
+    }
+}
+
+
+/** Runs an iterator until the minimum time has passed and prints the rates
+ *
+ * @param name Name of the stencil
+ * @param iterator Iterator applying the stencil
+ * @param cells Applications of the stencil per iteration
+ * @param cost Estimated cost of one application
+ * @param minTime Minimum run time in seconds
+ */
+template<class FlowField>
+static void run ( const char * name, Iterator<FlowField> & iterator, long cells,
+                  const StencilCost & cost, double minTime ) {
+    // warm up the caches, then double the repetitions until the run is long enough
+    iterator.iterate();
+    int repetitions = 1;
+    double seconds = 0.0;
+    while (true) {
+        const double start = MPI_Wtime();
+        for (int r = 0; r < repetitions; r++) {
+            iterator.iterate();
+        }
+        seconds = MPI_Wtime() - start;
+        if (seconds >= minTime || repetitions >= (1 << 24)) {
+            break;
+        }
+        repetitions *= 2;
+    }
+
+    const double applications = (double) cells * repetitions;
+    printf("%-28s %10ld %8d %10.3f %9.3f %9.3f %9.0f %8.0f\n", name, cells, repetitions,
+           1.0e9 * seconds / applications, cost.bytes * applications / seconds * 1.0e-9,
+           cost.flops * applications / seconds * 1.0e-9, cost.bytes, cost.flops);
+}
+
+
+int main ( int argc, char * argv[] ) {
+    PetscInitialize(&argc, &argv, "petsc_commandline_arg", PETSC_NULL);
+    int nproc;
+    MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+    if (argc < 2) {
+        std::cout << "Usage: ns_bench configuration.xml [-dim 2|3] [-size nx ny nz] [-mesh uniform|stretched] [-time seconds]" << std::endl;
+        PetscFinalize();
+        return 1;
+    }
+    if (nproc != 1) {
+        handleError(1, "The benchmark runs on a single process");
+    }
+
+    Configuration configuration(argv[1]);
+    Parameters parameters;
+    configuration.loadParameters(parameters);
+    if (parameters.simulation.type != "turbulence") {
+        handleError(1, "The benchmark needs the configuration of a turbulent simulation");
+    }
+
+    BenchOptions options;
+    parseOptions(argc, argv, parameters, options);
+    const int dim = options.dim;
+    parameters.geometry.dim = dim;
+    parameters.geometry.sizeX = options.size[0];
+    parameters.geometry.sizeY = options.size[1];
+    parameters.geometry.sizeZ = dim == 3 ? options.size[2] : 1;
+    if (options.mesh >= 0) {
+        parameters.geometry.meshsizeType = options.mesh;
+        parameters.geometry.stretchX = false;
+        parameters.geometry.stretchY = true;
+        parameters.geometry.stretchZ = dim == 3;
+    }
+    for (int d = 0; d < 3; d++) {
+        parameters.parallel.numProcessors[d] = 1;
+    }
+    PetscParallelConfiguration parallelConfiguration(parameters);
+    MeshsizeFactory::getInstance().initMeshsize(parameters);
+
+    // all faces are parallel boundaries, so that the buffer stencils run everywhere
+    parameters.parallel.leftNb = parameters.parallel.rightNb = 0;
+    parameters.parallel.bottomNb = parameters.parallel.topNb = 0;
+    if (dim == 3) {
+        parameters.parallel.frontNb = parameters.parallel.backNb = 0;
+    }
+
+    TurbulentFlowField flowField(parameters);
+    initializeFields(flowField, parameters);
+    parameters.timestep.dt = 1.0e-3;
+
+    // applications per iteration: (N+1)^dim for the default offsets, N^dim for MinDt, the ghost
+    // layers of the six faces for the buffer stencils
+    const int n[3] = {options.size[0], options.size[1], dim == 3 ? options.size[2] : 1};
+    const int c[3] = {flowField.getCellsX(), flowField.getCellsY(), dim == 3 ? flowField.getCellsZ() : 1};
+    const long cells = dim == 3 ? (long) (n[0]+1) * (n[1]+1) * (n[2]+1) : (long) (n[0]+1) * (n[1]+1);
+    const long innerCells = (long) n[0] * n[1] * n[2];
+    const long faceCells = dim == 3 ? 2L * (c[1]*c[2] + c[0]*c[2] + c[0]*c[1]) : 2L * (c[0] + c[1]);
+
+    // estimated compulsory traffic (fields of FLOAT, flags of int) and flops per application
+    const double F = sizeof(FLOAT), I = sizeof(int);
+    const bool is3D = dim == 3;
+    const StencilCost fghCost       = {2*dim*F + I,     is3D ? 540.0 : 240.0};
+    const StencilCost fghTurbCost   = {(2*dim+1)*F + I, is3D ? 860.0 : 400.0};
+    const StencilCost rhsCost       = {(dim+1)*F,       is3D ? 10.0 : 7.0};
+    const StencilCost velocityCost  = {(2*dim+1)*F + I, 6.0 * dim};
+    const StencilCost obstacleCost  = {I,               0.0};
+    const StencilCost turbViscCost  = {(dim+2)*F + I,   is3D ? 95.0 : 45.0};
+    const StencilCost maxUCost      = {dim*F,           2.0 * dim};
+    const StencilCost minDtCost     = {F,               is3D ? 12.0 : 9.0};
+    const StencilCost scalarBufferCost = {2*F,          0.0};
+    const StencilCost vectorBufferCost = {2*dim*F,      0.0};
+
+    // buffers large enough for every face, in both directions of the velocity exchange
+    const int maxFace = std::max(c[0], std::max(c[1], c[2])) * (is3D ? std::max(c[0], std::max(c[1], c[2])) : 1);
+    std::vector<FLOAT> buffers[6];
+    FLOAT * b[6];
+    for (int face = 0; face < 6; face++) {
+        buffers[face].resize(2 * 3 * maxFace, 0.0);
+        b[face] = &buffers[face][0];
+    }
+
+    printf("NS-EOF stencil benchmark: %dD, %d x %d x %d cells, %s mesh, %d-byte FLOAT\n", dim,
+           n[0], n[1], n[2], parameters.geometry.meshsizeType == Uniform ? "uniform" :
+           (parameters.geometry.meshsizeType == TanhStretching ? "stretched" :
+           (parameters.geometry.meshsizeType == BfsStretching ? "bfs" : "blocks")), (int) sizeof(FLOAT));
+    printf("%-28s %10s %8s %10s %9s %9s %9s %8s\n", "stencil", "cells", "reps", "ns/cell", "GB/s",
+           "GFLOP/s", "B/cell", "F/cell");
+
+    FGHStencil fghStencil(parameters);
+    FieldIterator<FlowField> fghIterator(flowField, parameters, fghStencil);
+    run("FGHStencil", fghIterator, cells, fghCost, options.minTime);
+
+    FGHTurbStencil fghTurbStencil(parameters);
+    FieldIterator<TurbulentFlowField> fghTurbIterator(flowField, parameters, fghTurbStencil);
+    run("FGHTurbStencil", fghTurbIterator, cells, fghTurbCost, options.minTime);
+
+    RHSStencil rhsStencil(parameters);
+    FieldIterator<FlowField> rhsIterator(flowField, parameters, rhsStencil);
+    run("RHSStencil", rhsIterator, cells, rhsCost, options.minTime);
+
+    VelocityStencil velocityStencil(parameters);
+    FieldIterator<FlowField> velocityIterator(flowField, parameters, velocityStencil);
+    run("VelocityStencil", velocityIterator, cells, velocityCost, options.minTime);
+
+    ObstacleStencil obstacleStencil(parameters);
+    FieldIterator<FlowField> obstacleIterator(flowField, parameters, obstacleStencil);
+    run("ObstacleStencil", obstacleIterator, cells, obstacleCost, options.minTime);
+
+    IgnoreDeltaTurbViscosityStencil turbViscStencil(parameters);
+    FieldIterator<TurbulentFlowField> turbViscIterator(flowField, parameters, turbViscStencil);
+    run("TurbViscosityStencil", turbViscIterator, cells, turbViscCost, options.minTime);
+
+    MaxUStencil maxUStencil(parameters);
+    FieldIterator<FlowField> maxUIterator(flowField, parameters, maxUStencil);
+    run("MaxUStencil", maxUIterator, cells, maxUCost, options.minTime);
+
+    MinDtStencil minDtStencil(parameters);
+    FieldIterator<TurbulentFlowField> minDtIterator(flowField, parameters, minDtStencil, 1, 0);
+    run("MinDtStencil", minDtIterator, innerCells, minDtCost, options.minTime);
+
+    if (is3D) {
+        PressureBufferFillStencil pressureFill(parameters, b[0], b[1], b[2], b[3], b[4], b[5]);
+        ParallelBoundaryIterator<FlowField> pressureFillIterator(flowField, parameters, pressureFill);
+        run("PressureBufferFillStencil", pressureFillIterator, faceCells, scalarBufferCost, options.minTime);
+        PressureBufferReadStencil pressureRead(parameters, b[0], b[1], b[2], b[3], b[4], b[5]);
+        ParallelBoundaryIterator<FlowField> pressureReadIterator(flowField, parameters, pressureRead);
+        run("PressureBufferReadStencil", pressureReadIterator, faceCells, scalarBufferCost, options.minTime);
+        VelocityBufferFillStencil velocityFill(parameters, b[0], b[1], b[2], b[3], b[4], b[5]);
+        ParallelBoundaryIterator<FlowField> velocityFillIterator(flowField, parameters, velocityFill);
+        run("VelocityBufferFillStencil", velocityFillIterator, faceCells, vectorBufferCost, options.minTime);
+        VelocityBufferReadStencil velocityRead(parameters, b[0], b[1], b[2], b[3], b[4], b[5]);
+        ParallelBoundaryIterator<FlowField> velocityReadIterator(flowField, parameters, velocityRead);
+        run("VelocityBufferReadStencil", velocityReadIterator, faceCells, vectorBufferCost, options.minTime);
+        TurbViscosityBufferFillStencil turbViscFill(parameters, b[0], b[1], b[2], b[3], b[4], b[5]);
+        ParallelBoundaryIterator<TurbulentFlowField> turbViscFillIterator(flowField, parameters, turbViscFill);
+        run("TurbViscosityBufferFill", turbViscFillIterator, faceCells, scalarBufferCost, options.minTime);
+        TurbViscosityBufferReadStencil turbViscRead(parameters, b[0], b[1], b[2], b[3], b[4], b[5]);
+        ParallelBoundaryIterator<TurbulentFlowField> turbViscReadIterator(flowField, parameters, turbViscRead);
+        run("TurbViscosityBufferRead", turbViscReadIterator, faceCells, scalarBufferCost, options.minTime);
+    } else {
+        PressureBufferFillStencil pressureFill(parameters, b[0], b[1], b[2], b[3]);
+        ParallelBoundaryIterator<FlowField> pressureFillIterator(flowField, parameters, pressureFill);
+        run("PressureBufferFillStencil", pressureFillIterator, faceCells, scalarBufferCost, options.minTime);
+        PressureBufferReadStencil pressureRead(parameters, b[0], b[1], b[2], b[3]);
+        ParallelBoundaryIterator<FlowField> pressureReadIterator(flowField, parameters, pressureRead);
+        run("PressureBufferReadStencil", pressureReadIterator, faceCells, scalarBufferCost, options.minTime);
+        VelocityBufferFillStencil velocityFill(parameters, b[0], b[1], b[2], b[3]);
+        ParallelBoundaryIterator<FlowField> velocityFillIterator(flowField, parameters, velocityFill);
+        run("VelocityBufferFillStencil", velocityFillIterator, faceCells, vectorBufferCost, options.minTime);
+        VelocityBufferReadStencil velocityRead(parameters, b[0], b[1], b[2], b[3]);
+        ParallelBoundaryIterator<FlowField> velocityReadIterator(flowField, parameters, velocityRead);
+        run("VelocityBufferReadStencil", velocityReadIterator, faceCells, vectorBufferCost, options.minTime);
+        TurbViscosityBufferFillStencil turbViscFill(parameters, b[0], b[1], b[2], b[3]);
+        ParallelBoundaryIterator<TurbulentFlowField> turbViscFillIterator(flowField, parameters, turbViscFill);
+        run("TurbViscosityBufferFill", turbViscFillIterator, faceCells, scalarBufferCost, options.minTime);
+        TurbViscosityBufferReadStencil turbViscRead(parameters, b[0], b[1], b[2], b[3]);
+        ParallelBoundaryIterator<TurbulentFlowField> turbViscReadIterator(flowField, parameters, turbViscRead);
+        run("TurbViscosityBufferRead", turbViscReadIterator, faceCells, scalarBufferCost, options.minTime);
+    }
+
+    PetscFinalize();
+    return 0;
+}
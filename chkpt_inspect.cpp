@@ -0,0 +1,430 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Configuration.h"
+#include "CheckpointReader.h"
+
+/** Inspects a checkpoint file. Replaces bin2ascii.sh.
+ *
+ * Usage: ./chkpt_inspect configuration.xml checkpoint [options]
+ *
+ *   -info             Header and section table (default, together with -stats)
+ *   -stats            Min, max, mean and L2 norm of each component of the fields over the inner
+ *                     cells, and the norms of the divergence of the velocity over the fluid cells
+ *   -dump             Values of the selected cells
+ *   -fields a,b,...   Sections to dump (default: pressure,velocity)
+ *   -x lo:hi          Range of inner cells in x direction, inclusive, starting at 0 (also -y, -z).
+ *                     A single index selects a plane, e.g. -z 16, or a cell if given for all
+ *   -format csv|bin   Format of the dump. csv has one line i,j,k,values per cell. bin contains the
+ *                     region of each field after each other, x fastest and components interleaved,
+ *                     in the native byte order and type of the section (FLOAT or int)
+ *   -o file           Writes the dump into a file instead of the standard output
+ *   -compare file     Compares the selected fields with those of a reference checkpoint of the same
+ *                     configuration over the inner cells. The exit code is nonzero if the largest
+ *                     difference of a field, relative to its largest absolute reference value,
+ *                     exceeds the tolerance. The pressure is compared after removing its mean,
+ *                     since it is only determined up to a constant
+ *   -tolerance t      Relative tolerance of the comparison (default 1e-6)
+ *
+ * The configuration provides the geometry, which has to match the one of the file, and the mesh
+ * for the divergence. Files of the original format contain pressure and velocity only.
+ */
+
+//! Options of the inspection
+struct InspectionOptions : public CheckpointSelection {
+    bool info;
+    bool stats;
+    bool dump;
+    bool binary;
+    std::string output;
+    std::string reference;  //! Checkpoint to compare with, empty if none
+    double tolerance;
+};
+
+static void parseOptions ( int argc, char * argv[], const Parameters & parameters,
+                           InspectionOptions & options ) {
+    options.selectAll(parameters);
+    options.info = options.stats = options.dump = options.binary = false;
+    options.tolerance = 1e-6;
+
+    for (int arg = 3; arg < argc; arg++) {
+        const std::string option(argv[arg]);
+        if (options.parseOption(argc, argv, arg)) {
+            // -fields, -x, -y and -z
+        } else if (option == "-info") {
+            options.info = true;
+        } else if (option == "-stats") {
+            options.stats = true;
+        } else if (option == "-dump") {
+            options.dump = true;
+        } else if (option == "-format" && arg + 1 < argc) {
+            const std::string format(argv[++arg]);
+            if (format != "csv" && format != "bin") {
+                handleError(1, "Unknown format, expected csv or bin");
+            }
+            options.binary = format == "bin";
+        } else if (option == "-o" && arg + 1 < argc) {
+            options.output = argv[++arg];
+        } else if (option == "-compare" && arg + 1 < argc) {
+            options.reference = argv[++arg];
+        } else if (option == "-tolerance" && arg + 1 < argc) {
+            if (sscanf(argv[++arg], "%lf", &options.tolerance) != 1 || options.tolerance < 0.0) {
+                handleError(1, "Invalid tolerance");
+            }
+        } else {
+            handleError(1, "Unknown option. Usage: chkpt_inspect configuration.xml checkpoint [-info] [-stats] [-dump] [-fields a,b] [-x lo:hi] [-y lo:hi] [-z lo:hi] [-format csv|bin] [-o file] [-compare reference] [-tolerance t]");
+        }
+    }
+
+    options.checkRegion(parameters);
+    if (options.fields.empty()) {
+        options.fields.push_back("pressure");
+        options.fields.push_back("velocity");
+    }
+    if (!options.info && !options.stats && !options.dump && options.reference == "") {
+        options.info = options.stats = true;
+    }
+}
+
+static void printInfo ( CheckpointReader & reader ) {
+    const char * encodings[3] = {"raw", "keyframe", "delta"};
+    std::cout << "File:      " << reader.getFileName() << " (" << reader.getFileSize() << " bytes)" << std::endl;
+    if (reader.isLegacy()) {
+        std::cout << "Format:    original (pressure and velocity of the inner cells)" << std::endl;
+    } else {
+        const int encoding = reader.getEncoding();
+        std::cout << "Format:    version " << reader.getVersion() << ", "
+                  << (encoding >= 0 && encoding < 3 ? encodings[encoding] : "unknown") << " encoding" << std::endl;
+    }
+    printf("Timestep:  %d\nTime:      %.10g\n\n", reader.getTimeStep(), reader.getTime());
+
+    printf("%-20s %-6s %4s %16s %14s %14s\n", "Section", "Type", "Comp", "Size", "Offset", "Bytes");
+    const std::vector<CheckpointSection> & sections = reader.getSections();
+    for (unsigned int s = 0; s < sections.size(); s++) {
+        const CheckpointSection & section = sections[s];
+        std::ostringstream size;
+        size << section.sizes[0] << "x" << section.sizes[1] << "x" << section.sizes[2];
+        printf("%-20.32s %-6s %4d %16s %14lld %14lld\n", section.name,
+               section.type == CHECKPOINT_INT ? "int" : "float", section.components,
+               size.str().c_str(), section.offset, section.bytes);
+    }
+
+    // Small records are printed with their values
+    const FLOAT * dt = reader.getFloatSection("dt");
+    const int * statistics = reader.getIntSection("solverStatistics");
+    if (dt != NULL) {
+        printf("\nTime step size: %.10g\n", dt[0]);
+    }
+    if (statistics != NULL) {
+        printf("Linear solver:  %d solves, %d iterations\n", statistics[0], statistics[1]);
+    }
+    std::cout << std::endl;
+}
+
+/** Statistics of one component over the inner cells. The loops run over contiguous rows of the
+ *  global array, so that the accumulation of all four quantities is a single pass over the data.
+ */
+template<class T>
+static void printComponentStats ( const std::string & name, const T * values, int components,
+                                  int component, const int sizes[3], int offsetZ,
+                                  const Parameters & parameters ) {
+    const int nx = parameters.geometry.sizeX;
+    const int ny = parameters.geometry.sizeY;
+    const int nz = parameters.geometry.dim == 3 ? parameters.geometry.sizeZ : 1;
+
+    double minimum = values[(((size_t) offsetZ * sizes[1] + 2) * sizes[0] + 2) * components + component];
+    double maximum = minimum;
+    double sum = 0.0;
+    double squares = 0.0;
+    for (int k = offsetZ; k < nz + offsetZ; k++) {
+        for (int j = 2; j < ny + 2; j++) {
+            const T * row = values + (((size_t) k * sizes[1] + j) * sizes[0] + 2) * components + component;
+            for (int i = 0; i < nx; i++) {
+                const double value = row[i * components];
+                minimum = value < minimum ? value : minimum;
+                maximum = value > maximum ? value : maximum;
+                sum += value;
+                squares += value * value;
+            }
+        }
+    }
+    const double count = (double) nx * ny * nz;
+    printf("%-22s %16.8e %16.8e %16.8e %16.8e\n", name.c_str(), minimum, maximum, sum / count, sqrt(squares));
+}
+
+static void printStats ( CheckpointReader & reader, const Parameters & parameters ) {
+    const int dim = parameters.geometry.dim;
+    const int offsetZ = dim == 3 ? 2 : 0;
+    const char * axes = "xyz";
+
+    printf("%-22s %16s %16s %16s %16s\n", "Field", "Min", "Max", "Mean", "L2 norm");
+    const std::vector<CheckpointSection> & sections = reader.getSections();
+    for (unsigned int s = 0; s < sections.size(); s++) {
+        const CheckpointSection & section = sections[s];
+        const std::string name(section.name, strnlen(section.name, sizeof(section.name)));
+        // Only the fields on the cells of the flow field
+        if (section.sizes[0] != parameters.geometry.sizeX + 3 || section.sizes[1] != parameters.geometry.sizeY + 3) {
+            continue;
+        }
+        for (int c = 0; c < section.components; c++) {
+            const std::string label = section.components == 1 ? name : name + "_" + axes[c % 3];
+            if (section.type == CHECKPOINT_INT) {
+                printComponentStats(label, reader.getIntSection(name), section.components, c,
+                                    section.sizes, offsetZ, parameters);
+            } else {
+                printComponentStats(label, reader.getFloatSection(name), section.components, c,
+                                    section.sizes, offsetZ, parameters);
+            }
+        }
+    }
+
+    // Divergence of the velocity in the fluid cells, as the pressure correction enforces it
+    const FLOAT * velocity = reader.getFloatSection("velocity");
+    if (velocity == NULL) {
+        return;
+    }
+    const int * flags = reader.getIntSection("flags");
+    const Meshsize * ms = parameters.meshsize;
+    const int sizes[3] = {parameters.geometry.sizeX + 3, parameters.geometry.sizeY + 3, dim == 3 ? parameters.geometry.sizeZ + 3 : 1};
+    const size_t stride[3] = {(size_t) dim, (size_t) dim * sizes[0], (size_t) dim * sizes[0] * sizes[1]};
+    double maximum = 0.0, squares = 0.0;
+    int fluidCells = 0;
+    const int endZ = dim == 3 ? sizes[2] - 1 : 1;
+    for (int k = offsetZ; k < endZ; k++) {
+        for (int j = 2; j < sizes[1] - 1; j++) {
+            for (int i = 2; i < sizes[0] - 1; i++) {
+                const size_t cell = ((size_t) k * sizes[1] + j) * sizes[0] + i;
+                if (flags != NULL && (flags[cell] & OBSTACLE_SELF)) {
+                    continue;
+                }
+                const FLOAT * v = velocity + dim * cell;
+                double divergence;
+                if (dim == 2) {
+                    divergence = (v[0] - (v - stride[0])[0]) / ms->getDx(i, j)
+                               + (v[1] - (v - stride[1])[1]) / ms->getDy(i, j);
+                } else {
+                    divergence = (v[0] - (v - stride[0])[0]) / ms->getDx(i, j, k)
+                               + (v[1] - (v - stride[1])[1]) / ms->getDy(i, j, k)
+                               + (v[2] - (v - stride[2])[2]) / ms->getDz(i, j, k);
+                }
+                maximum = fabs(divergence) > maximum ? fabs(divergence) : maximum;
+                squares += divergence * divergence;
+                fluidCells++;
+            }
+        }
+    }
+    printf("\nDivergence in %d fluid cells: max %16.8e, L2 norm %16.8e\n\n", fluidCells, maximum, sqrt(squares));
+}
+
+static void dump ( CheckpointReader & reader, const Parameters & parameters, const InspectionOptions & options ) {
+    const int dim = parameters.geometry.dim;
+    const int offsetZ = dim == 3 ? 2 : 0;
+    const int sizes[2] = {parameters.geometry.sizeX + 3, parameters.geometry.sizeY + 3};
+    const int first[3] = {options.low[0] + 2, options.low[1] + 2, options.low[2] + offsetZ};
+    const int last[3]  = {options.high[0] + 2, options.high[1] + 2, options.high[2] + offsetZ};
+    const char * axes = "xyz";
+
+    std::vector<const CheckpointSection *> sections;
+    for (unsigned int f = 0; f < options.fields.size(); f++) {
+        const CheckpointSection * section = reader.findSection(options.fields[f]);
+        if (section == NULL) {
+            handleError(1, "The checkpoint file does not contain the section");
+        }
+        if (section->sizes[0] != sizes[0] || section->sizes[1] != sizes[1]) {
+            handleError(1, "Only sections on the cells of the flow field can be dumped");
+        }
+        sections.push_back(section);
+    }
+
+    std::ofstream file;
+    if (options.output != "") {
+        file.open(options.output.c_str(), std::ios::out | std::ios::binary);
+        if (!file) {
+            handleError(1, "Cannot create the output file");
+        }
+    }
+    std::ostream & stream = options.output != "" ? file : std::cout;
+
+    if (options.binary) {
+        // One block per field, rows copied as they are stored
+        for (unsigned int f = 0; f < sections.size(); f++) {
+            const CheckpointSection & section = *sections[f];
+            const size_t entryBytes = section.components * (section.type == CHECKPOINT_INT ? sizeof(int) : sizeof(FLOAT));
+            const char * values = section.type == CHECKPOINT_INT ? (const char *) reader.getIntSection(options.fields[f])
+                                                                 : (const char *) reader.getFloatSection(options.fields[f]);
+            for (int k = first[2]; k <= last[2]; k++) {
+                for (int j = first[1]; j <= last[1]; j++) {
+                    const size_t cell = ((size_t) k * sizes[1] + j) * sizes[0] + first[0];
+                    stream.write(values + cell * entryBytes, (last[0] - first[0] + 1) * entryBytes);
+                }
+            }
+        }
+        return;
+    }
+
+    // CSV with the indices of the inner cells and the values as stored, i.e. velocities on the faces
+    stream << "i,j,k";
+    for (unsigned int f = 0; f < sections.size(); f++) {
+        for (int c = 0; c < sections[f]->components; c++) {
+            stream << "," << options.fields[f];
+            if (sections[f]->components > 1) {
+                stream << "_" << axes[c % 3];
+            }
+        }
+    }
+    stream << "\n";
+
+    std::vector<const FLOAT *> floatValues(sections.size());
+    std::vector<const int *> intValues(sections.size());
+    for (unsigned int f = 0; f < sections.size(); f++) {
+        if (sections[f]->type == CHECKPOINT_INT) {
+            intValues[f] = reader.getIntSection(options.fields[f]);
+        } else {
+            floatValues[f] = reader.getFloatSection(options.fields[f]);
+        }
+    }
+
+    char number[32];
+    for (int k = first[2]; k <= last[2]; k++) {
+        for (int j = first[1]; j <= last[1]; j++) {
+            for (int i = first[0]; i <= last[0]; i++) {
+                const size_t cell = ((size_t) k * sizes[1] + j) * sizes[0] + i;
+                stream << i - 2 << "," << j - 2 << "," << k - offsetZ;
+                for (unsigned int f = 0; f < sections.size(); f++) {
+                    for (int c = 0; c < sections[f]->components; c++) {
+                        if (intValues[f] != NULL) {
+                            snprintf(number, sizeof(number), ",%d", intValues[f][cell * sections[f]->components + c]);
+                        } else {
+                            snprintf(number, sizeof(number), ",%.10e", (double) floatValues[f][cell * sections[f]->components + c]);
+                        }
+                        stream << number;
+                    }
+                }
+                stream << "\n";
+            }
+        }
+    }
+}
+
+/** Largest difference of one component over the inner cells, and the largest absolute value of
+ *  the reference. If requested, the mean of each field is removed first.
+ */
+static void compareComponent ( const FLOAT * values, const FLOAT * reference, int components,
+                               int component, const int sizes[3], int offsetZ, bool removeMean,
+                               const Parameters & parameters, double & difference, double & scale ) {
+    const int nx = parameters.geometry.sizeX;
+    const int ny = parameters.geometry.sizeY;
+    const int nz = parameters.geometry.dim == 3 ? parameters.geometry.sizeZ : 1;
+
+    double meanValues = 0.0, meanReference = 0.0;
+    if (removeMean) {
+        for (int k = offsetZ; k < nz + offsetZ; k++) {
+            for (int j = 2; j < ny + 2; j++) {
+                const size_t row = (((size_t) k * sizes[1] + j) * sizes[0] + 2) * components + component;
+                for (int i = 0; i < nx; i++) {
+                    meanValues += values[row + i * components];
+                    meanReference += reference[row + i * components];
+                }
+            }
+        }
+        meanValues /= (double) nx * ny * nz;
+        meanReference /= (double) nx * ny * nz;
+    }
+
+    for (int k = offsetZ; k < nz + offsetZ; k++) {
+        for (int j = 2; j < ny + 2; j++) {
+            const size_t row = (((size_t) k * sizes[1] + j) * sizes[0] + 2) * components + component;
+            for (int i = 0; i < nx; i++) {
+                const double value = values[row + i * components] - meanValues;
+                const double expected = reference[row + i * components] - meanReference;
+                difference = fabs(value - expected) > difference ? fabs(value - expected) : difference;
+                scale = fabs(expected) > scale ? fabs(expected) : scale;
+            }
+        }
+    }
+}
+
+/** Compares the selected fields with a reference checkpoint. Returns true if all of them agree
+ *  within the tolerance.
+ */
+static bool compare ( CheckpointReader & reader, const Parameters & parameters, const InspectionOptions & options ) {
+    CheckpointReader reference(options.reference, parameters);
+    const int offsetZ = parameters.geometry.dim == 3 ? 2 : 0;
+    bool passed = true;
+
+    printf("Comparison with %s, relative tolerance %g\n", options.reference.c_str(), options.tolerance);
+    printf("%-22s %16s %16s %16s\n", "Field", "Max abs diff", "Max abs ref", "Max rel diff");
+    for (unsigned int f = 0; f < options.fields.size(); f++) {
+        const std::string & name = options.fields[f];
+        const CheckpointSection * section = reader.findSection(name);
+        const CheckpointSection * referenceSection = reference.findSection(name);
+        if (section == NULL || referenceSection == NULL) {
+            handleError(1, "Both checkpoint files have to contain the compared sections");
+        }
+        if (section->type != CHECKPOINT_FLOAT || referenceSection->type != CHECKPOINT_FLOAT
+            || section->components != referenceSection->components
+            || section->sizes[0] != parameters.geometry.sizeX + 3 || section->sizes[1] != parameters.geometry.sizeY + 3
+            || memcmp(section->sizes, referenceSection->sizes, sizeof(section->sizes)) != 0) {
+            handleError(1, "Only floating point fields on the cells of the flow field of the same shape can be compared");
+        }
+
+        double difference = 0.0, scale = 0.0;
+        for (int c = 0; c < section->components; c++) {
+            compareComponent(reader.getFloatSection(name), reference.getFloatSection(name),
+                             section->components, c, section->sizes, offsetZ, name == "pressure",
+                             parameters, difference, scale);
+        }
+        const double relative = scale > 0.0 ? difference / scale : difference;
+        const bool fieldPassed = relative <= options.tolerance;
+        printf("%-22s %16.8e %16.8e %16.8e %s\n", name.c_str(), difference, scale, relative,
+               fieldPassed ? "ok" : "FAILED");
+        passed = passed && fieldPassed;
+    }
+    std::cout << std::endl;
+    return passed;
+}
+
+int main (int argc, char *argv[]) {
+
+    MPI_Init(&argc, &argv);
+
+    if (argc < 3) {
+        std::cerr << "Usage: chkpt_inspect configuration.xml checkpoint [-info] [-stats] [-dump] [-fields a,b] [-x lo:hi] [-y lo:hi] [-z lo:hi] [-format csv|bin] [-o file] [-compare reference] [-tolerance t]" << std::endl;
+        MPI_Finalize();
+        return 1;
+    }
+
+    // read configuration and store information in parameters object
+    Configuration configuration(argv[1]);
+    Parameters parameters;
+    configuration.loadParameters(parameters, MPI_COMM_WORLD);
+    parameters.parallel.rank = 0;
+    initGlobalMeshsize(parameters);
+
+    InspectionOptions options;
+    parseOptions(argc, argv, parameters, options);
+
+    CheckpointReader reader(argv[2], parameters);
+    if (options.info) {
+        printInfo(reader);
+    }
+    if (options.stats) {
+        printStats(reader, parameters);
+    }
+    if (options.dump) {
+        dump(reader, parameters, options);
+    }
+    bool passed = true;
+    if (options.reference != "") {
+        passed = compare(reader, parameters, options);
+    }
+
+    MPI_Finalize();
+    return passed ? 0 : 2;
+}
@@ -0,0 +1,278 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Configuration.h"
+#include "CheckpointReader.h"
+#include "SimpleTimer.h"
+
+/** Converts checkpoint files into binary VTK files.
+ *
+ * Usage: mpirun -np N ./chkpt_to_vtk configuration.xml [options] [checkpoint files]
+ *
+ *   -fields a,b,...   Sections to convert (default: pressure,velocity and turbViscosity)
+ *   -x lo:hi          Range of inner cells in x direction, inclusive, starting at 0 (also -y, -z).
+ *                     A single index selects a slice of one cell, e.g. -z 16
+ *   -o prefix         Prefix of the output files (default: vtk prefix of the configuration)
+ *
+ * Without files, all the files in the checkpoint directory starting with the checkpoint prefix
+ * are converted. The files are mapped into memory and distributed round-robin among the ranks,
+ * which convert them independently. Neither the flow field nor the solvers are set up, only the
+ * mesh of the configuration is needed for the coordinates.
+ */
+
+//! Options of the conversion
+struct ConversionOptions : public CheckpointSelection {
+    std::string prefix;
+};
+
+//! Appends a value to a buffer, in the big endian byte order required by the legacy VTK format
+template<class T>
+static void appendBigEndian ( std::vector<char> & buffer, T value ) {
+    const int one = 1;
+    const char * bytes = (const char *) &value;
+    if (*(const char *) &one == 1) {
+        for (int b = sizeof(T) - 1; b >= 0; b--) {
+            buffer.push_back(bytes[b]);
+        }
+    } else {
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+}
+
+static void parseOptions ( int argc, char * argv[], const Parameters & parameters,
+                           ConversionOptions & options, std::vector<std::string> & files ) {
+    options.selectAll(parameters);
+    options.prefix = parameters.vtk.prefix;
+
+    for (int arg = 2; arg < argc; arg++) {
+        const std::string option(argv[arg]);
+        if (options.parseOption(argc, argv, arg)) {
+            // -fields, -x, -y and -z
+        } else if (option == "-o" && arg + 1 < argc) {
+            options.prefix = argv[++arg];
+        } else if (option[0] == '-') {
+            handleError(1, "Unknown option. Usage: chkpt_to_vtk configuration.xml [-fields a,b] [-x lo:hi] [-y lo:hi] [-z lo:hi] [-o prefix] [files]");
+        } else {
+            files.push_back(option);
+        }
+    }
+
+    options.checkRegion(parameters);
+
+    // Without a list, the files of the checkpoint directory are converted in the order of time steps
+    if (files.empty()) {
+        DIR* dir_pointer = opendir(parameters.checkpoint.directory.c_str());
+        if (dir_pointer == NULL) {
+            handleError(1, "Cannot open the checkpoint directory");
+        }
+        dirent* file_pointer;
+        while ((file_pointer = readdir(dir_pointer)) != NULL) {
+            if (!strncmp(file_pointer->d_name, parameters.checkpoint.prefix.c_str(), parameters.checkpoint.prefix.size())) {
+                files.push_back(parameters.checkpoint.directory + std::string(file_pointer->d_name));
+            }
+        }
+        closedir(dir_pointer);
+        std::sort(files.begin(), files.end());
+    }
+}
+
+/** Writes the selected region and sections of a checkpoint into a binary VTK file
+ * @return Number of bytes written
+ */
+static size_t convert ( CheckpointReader & reader, const Parameters & parameters,
+                        const ConversionOptions & options ) {
+    const int dim = parameters.geometry.dim;
+    const Meshsize * ms = parameters.meshsize;
+
+    // Extent of the global arrays and of the region, in indices of these arrays
+    const int cellsX = parameters.geometry.sizeX + 3;
+    const int cellsY = parameters.geometry.sizeY + 3;
+    const int offsetZ = dim == 3 ? 2 : 0;
+    const int first[3] = {options.low[0] + 2, options.low[1] + 2, options.low[2] + offsetZ};
+    const int last[3]  = {options.high[0] + 2, options.high[1] + 2, options.high[2] + offsetZ};
+    const int nx = last[0] - first[0] + 1;
+    const int ny = last[1] - first[1] + 1;
+    const int nz = dim == 3 ? last[2] - first[2] + 1 : 0;
+    const int nPoints = (nx+1)*(ny+1)*(nz+1);
+    const int nCells = dim == 2 ? nx*ny : nx*ny*nz;
+
+    std::vector<std::string> fields = options.fields;
+    if (fields.empty()) {
+        fields.push_back("pressure");
+        fields.push_back("velocity");
+        if (reader.findSection("turbViscosity") != NULL) {
+            fields.push_back("turbViscosity");
+        }
+    }
+
+    std::ostringstream fileName;
+    fileName << options.prefix << "." << std::setfill('0') << std::setw(6) << reader.getTimeStep() << ".vtk";
+    std::ofstream file(fileName.str().c_str(), std::ios::out | std::ios::binary);
+    if (!file) {
+        handleError(1, "Cannot create the VTK file");
+    }
+
+    std::vector<char> buffer;
+    buffer.reserve((size_t) 3 * sizeof(float) * nPoints);
+
+    // write VTK header
+    file << "# vtk DataFile Version 2.0" << std::endl;
+    file << "NS-EOF checkpoint " << reader.getFileName() << " at timestep = " << reader.getTimeStep() << std::endl;
+    file << "BINARY\n" << std::endl;
+
+    // write grid
+    file << "DATASET STRUCTURED_GRID" << std::endl;
+    file << "DIMENSIONS " << nx+1 << " " << ny+1 << " " << nz+1 << std::endl;
+    file << "POINTS " << nPoints << " float" << std::endl;
+    for (int k = first[2]; k <= first[2] + nz; k++) {
+        for (int j = first[1]; j <= last[1] + 1; j++) {
+            for (int i = first[0]; i <= last[0] + 1; i++) {
+                if (dim == 2) {
+                    appendBigEndian<float>(buffer, ms->getPosX(i, j));
+                    appendBigEndian<float>(buffer, ms->getPosY(i, j));
+                    appendBigEndian<float>(buffer, 0.0f);
+                } else {
+                    appendBigEndian<float>(buffer, ms->getPosX(i, j, k));
+                    appendBigEndian<float>(buffer, ms->getPosY(i, j, k));
+                    appendBigEndian<float>(buffer, ms->getPosZ(i, j, k));
+                }
+            }
+        }
+    }
+    file.write(&buffer[0], buffer.size());
+    size_t bytes = buffer.size();
+
+    file << "\nCELL_DATA " << nCells << std::endl;
+
+    const int * flags = reader.getIntSection("flags");
+    for (unsigned int f = 0; f < fields.size(); f++) {
+        const CheckpointSection * section = reader.findSection(fields[f]);
+        if (section == NULL) {
+            if (parameters.parallel.rank == 0) {
+                std::cout << "Section " << fields[f] << " not found in " << reader.getFileName() << std::endl;
+            }
+            continue;
+        }
+        if (section->sizes[0] != cellsX || section->sizes[1] != cellsY) {
+            handleError(1, "Only sections on the cells of the flow field can be converted");
+        }
+
+        buffer.clear();
+        if (fields[f] == "velocity") {
+            // Velocity in the cell centres, as in the VTK output of the simulation
+            const FLOAT * velocity = reader.getFloatSection("velocity");
+            const size_t stride[3] = {(size_t) dim, (size_t) dim * cellsX, (size_t) dim * cellsX * cellsY};
+            file << "\nVECTORS velocity float" << std::endl;
+            for (int k = first[2]; k <= last[2]; k++) {
+                for (int j = first[1]; j <= last[1]; j++) {
+                    for (int i = first[0]; i <= last[0]; i++) {
+                        const size_t cell = ((size_t) k * cellsY + j) * cellsX + i;
+                        const bool obstacle = flags != NULL && (flags[cell] & OBSTACLE_SELF);
+                        for (int d = 0; d < 3; d++) {
+                            FLOAT value = 0.0;
+                            if (d < dim && !obstacle) {
+                                const size_t index = dim * cell + d;
+                                value = (velocity[index] + velocity[index - stride[d]]) / 2;
+                            }
+                            appendBigEndian<float>(buffer, value);
+                        }
+                    }
+                }
+            }
+        } else {
+            if (section->components != 1) {
+                handleError(1, "Only scalar sections and the velocity can be converted");
+            }
+            const bool integer = section->type == CHECKPOINT_INT;
+            const FLOAT * floatValues = integer ? NULL : reader.getFloatSection(fields[f]);
+            const int * intValues = integer ? reader.getIntSection(fields[f]) : NULL;
+            file << "\nSCALARS " << fields[f] << (integer ? " int" : " float") << " 1" << std::endl;
+            file << "LOOKUP_TABLE default" << std::endl;
+            for (int k = first[2]; k <= last[2]; k++) {
+                for (int j = first[1]; j <= last[1]; j++) {
+                    for (int i = first[0]; i <= last[0]; i++) {
+                        const size_t cell = ((size_t) k * cellsY + j) * cellsX + i;
+                        if (integer) {
+                            appendBigEndian<int>(buffer, intValues[cell]);
+                        } else {
+                            appendBigEndian<float>(buffer, floatValues[cell]);
+                        }
+                    }
+                }
+            }
+        }
+        file.write(&buffer[0], buffer.size());
+        bytes += buffer.size();
+    }
+
+    file.close();
+    return bytes;
+}
+
+int main (int argc, char *argv[]) {
+
+    int rank;   // This processor's identifier
+    int nproc;  // Number of processors in the group
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    if (argc < 2) {
+        if (rank == 0) {
+            std::cerr << "Usage: chkpt_to_vtk configuration.xml [-fields a,b] [-x lo:hi] [-y lo:hi] [-z lo:hi] [-o prefix] [files]" << std::endl;
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    // read configuration and store information in parameters object
+    Configuration configuration(argv[1]);
+    Parameters parameters;
+    configuration.loadParameters(parameters, MPI_COMM_WORLD);
+
+    // The checkpoints hold the global arrays, so the mesh is set up for a single subdomain
+    parameters.parallel.rank = rank;
+    initGlobalMeshsize(parameters);
+
+    ConversionOptions options;
+    std::vector<std::string> files;
+    parseOptions(argc, argv, parameters, options, files);
+
+    SimpleTimer timer;
+    timer.start();
+
+    // Each rank converts every nproc-th file
+    double bytes[2] = {0.0, 0.0};   // read, written
+    int converted = 0;
+    for (unsigned int f = rank; f < files.size(); f += nproc) {
+        CheckpointReader reader(files[f], parameters);
+        bytes[1] += convert(reader, parameters, options);
+        bytes[0] += reader.getFileSize();
+        converted++;
+        std::cout << "Rank " << rank << ": converted time step " << reader.getTimeStep()
+                  << " of " << files[f] << std::endl;
+    }
+
+    FLOAT time = timer.getTimeAndContinue();
+    double totalBytes[2];
+    int totalConverted;
+    FLOAT maxTime;
+    MPI_Reduce(bytes, totalBytes, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&converted, &totalConverted, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&time, &maxTime, 1, MY_MPI_FLOAT, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        printf("Converted %d checkpoints on %d ranks in %f s: %.1f MB read, %.1f MB written\n",
+               totalConverted, nproc, maxTime, totalBytes[0] / 1e6, totalBytes[1] / 1e6);
+    }
+
+    MPI_Finalize();
+    return 0;
+}
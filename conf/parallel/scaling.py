@@ -0,0 +1,187 @@
+"""Strong and weak scaling harness for a single machine. Replaces enqueue.py and batch.sh.
+
+Generates the configurations from the templates in this directory, runs them with the local
+mpirun and reads the timer report (<timers>) of each run. The time per time step of the loop and
+of each stage is the maximum over the ranks; the parallel efficiency is relative to the run with
+the fewest ranks of each series:
+
+    strong: E = (T_ref * p_ref) / (T_p * p)     same mesh for all rank counts
+    weak:   E = T_ref / T_p                     cells and lengths grow with the process grid
+
+The results are written to scaling.csv and scaling.md in the output directory. Run from the root
+of the repository, usually through 'make scaling'.
+"""
+
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+
+STAGES = ["turbVisc", "turbViscComm", "turbViscCheck", "wallBoundaries", "setTimeStep", "fgh", "viscous", "rhs",
+          "solve", "pressureComm", "velocity", "obstacle", "velocityComm", "convergence"]
+
+
+def process_grids(ranks, dim, all_grids):
+    """Process grids with the given number of ranks, the most balanced one first"""
+    grids = []
+    for npX in range(1, ranks + 1):
+        for npY in range(1, ranks // npX + 1):
+            npZ = ranks // (npX * npY)
+            if npX * npY * npZ != ranks or (dim == 2 and npZ != 1):
+                continue
+            grids.append((npX, npY, npZ))
+    # balanced: smallest largest extent, ties broken towards splitting x first
+    grids.sort(key=lambda g: (max(g), -g[0], -g[1]))
+    return grids if all_grids else grids[:1]
+
+
+def write_config(template, path, run_dir, name, args, size, lengths, grid):
+    with open(template, "r") as inConf:
+        conf_file = inConf.read()
+    conf_file = conf_file.format(name=name, run_dir=run_dir, solver=args.solver, mesh=args.mesh,
+                                 dim=args.dim, final_time=args.final_time,
+                                 lX=lengths[0], lY=lengths[1], lZ=lengths[2],
+                                 sX=size[0], sY=size[1], sZ=size[2],
+                                 npX=grid[0], npY=grid[1], npZ=grid[2])
+    with open(path, "w") as outConf:
+        outConf.write(conf_file)
+
+
+def run_case(args, series, grid, size, lengths):
+    ranks = grid[0] * grid[1] * grid[2]
+    name = "{0}_p{1}x{2}x{3}_m{4}x{5}x{6}".format(series, grid[0], grid[1], grid[2], *size)
+    run_dir = os.path.join(args.output, name)
+    if not os.path.exists(run_dir):
+        os.makedirs(run_dir)
+    conf = os.path.join(run_dir, name + ".xml")
+    write_config(args.template, conf, run_dir, name, args, size, lengths, grid)
+
+    command = shlex.split(args.mpirun.format(ranks=ranks)) + [args.ns, conf]
+    print("{0}: {1}".format(name, " ".join(command)))
+    sys.stdout.flush()
+    with open(os.path.join(run_dir, "log.txt"), "w") as log:
+        status = subprocess.call(command, stdout=log, stderr=subprocess.STDOUT)
+    if status != 0:
+        sys.exit("Run {0} failed with status {1}, see {2}".format(name, status, os.path.join(run_dir, "log.txt")))
+
+    with open(os.path.join(run_dir, "timers.json"), "r") as report:
+        timers = json.load(report)
+    steps = max(timers["timeSteps"], 1)
+    result = {"series": series, "name": name, "ranks": ranks, "grid": "x".join(map(str, grid)),
+              "cells": size[0] * size[1] * (size[2] if args.dim == 3 else 1), "steps": timers["timeSteps"],
+              "loop": timers["loop"]["max"] / steps,
+              "imbalance": timers["loop"]["max"] / max(timers["loop"]["avg"], 1e-30)}
+    for stage in STAGES:
+        result[stage] = timers["regions"][stage]["max"] / steps
+    result["solverIterations"] = timers["regions"]["solve"]["work"] / float(steps)
+    return result
+
+
+def add_efficiencies(results, series):
+    """Efficiency of the loop and of each stage relative to the run with the fewest ranks"""
+    runs = [r for r in results if r["series"] == series]
+    if not runs:
+        return
+    reference = min(runs, key=lambda r: (r["ranks"], runs.index(r)))
+    for run in runs:
+        for key in ["loop"] + STAGES:
+            if run[key] <= 0.0 or reference[key] <= 0.0:
+                run["E_" + key] = None
+            elif series == "strong":
+                run["E_" + key] = reference[key] * reference["ranks"] / (run[key] * run["ranks"])
+            else:
+                run["E_" + key] = reference[key] / run[key]
+
+
+def write_tables(results, output, stages):
+    columns = ["series", "name", "ranks", "grid", "cells", "steps", "solverIterations", "imbalance", "loop"] \
+        + stages + ["E_loop"] + ["E_" + s for s in stages]
+
+    def text(value):
+        if value is None:
+            return ""
+        if isinstance(value, float):
+            return "{0:.4g}".format(value)
+        return str(value)
+
+    with open(os.path.join(output, "scaling.csv"), "w") as csv:
+        csv.write(",".join(columns) + "\n")
+        for result in results:
+            csv.write(",".join(text(result[c]) for c in columns) + "\n")
+
+    # Markdown: times per step in ms, then the efficiencies
+    with open(os.path.join(output, "scaling.md"), "w") as md:
+        md.write("Time per step (ms, slowest rank)\n\n")
+        header = ["series", "ranks", "grid", "cells", "loop"] + stages
+        md.write("| " + " | ".join(header) + " |\n")
+        md.write("|" + "---|" * len(header) + "\n")
+        for r in results:
+            md.write("| " + " | ".join([r["series"], str(r["ranks"]), r["grid"], str(r["cells"])]
+                                       + ["{0:.3f}".format(1e3 * r[k]) for k in ["loop"] + stages]) + " |\n")
+        md.write("\nParallel efficiency\n\n")
+        header = ["series", "ranks", "grid", "loop"] + stages
+        md.write("| " + " | ".join(header) + " |\n")
+        md.write("|" + "---|" * len(header) + "\n")
+        for r in results:
+            md.write("| " + " | ".join([r["series"], str(r["ranks"]), r["grid"]]
+                                       + [text(r["E_" + k]) for k in ["loop"] + stages]) + " |\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--ns", default="./ns", help="solver executable")
+    parser.add_argument("--mpirun", default="mpirun -np {ranks}", help="launcher, {ranks} is replaced")
+    parser.add_argument("--template", default="conf/parallel/conf_cavity.xml")
+    parser.add_argument("--output", default="output/scaling")
+    parser.add_argument("--series", default="strong,weak", help="strong, weak or both")
+    parser.add_argument("--ranks", default="1,2,4", help="rank counts, comma separated")
+    parser.add_argument("--all-grids", action="store_true", help="run every process grid, not only the balanced one")
+    parser.add_argument("--solver", default="dns", help="dns or turbulence")
+    parser.add_argument("--mesh", default="uniform", help="uniform or stretched")
+    parser.add_argument("--dim", type=int, default=3)
+    parser.add_argument("--final-time", type=float, default=0.05)
+    parser.add_argument("--strong-size", default="40,40,40", help="cells of the strong series")
+    parser.add_argument("--weak-size", default="20,20,20", help="cells per rank of the weak series")
+    parser.add_argument("--lengths", default="1,1,1", help="domain lengths of one rank of the weak series and of the strong series")
+    parser.add_argument("--min-efficiency", type=float, default=0.0,
+                        help="fail if the efficiency of the loop of a run drops below this value")
+    args = parser.parse_args()
+
+    ranks = [int(r) for r in args.ranks.split(",")]
+    strong_size = [int(s) for s in args.strong_size.split(",")]
+    weak_size = [int(s) for s in args.weak_size.split(",")]
+    lengths = [float(l) for l in args.lengths.split(",")]
+    if args.dim == 2:
+        strong_size[2] = weak_size[2] = 1
+    if not os.path.exists(args.output):
+        os.makedirs(args.output)
+
+    results = []
+    for series in args.series.split(","):
+        for p in ranks:
+            for grid in process_grids(p, args.dim, args.all_grids):
+                if series == "strong":
+                    results.append(run_case(args, series, grid, strong_size, lengths))
+                elif series == "weak":
+                    size = [weak_size[d] * grid[d] for d in range(3)]
+                    scaled = [lengths[d] * grid[d] for d in range(3)]
+                    results.append(run_case(args, series, grid, size, scaled))
+                else:
+                    sys.exit("Unknown series " + series)
+        add_efficiencies(results, series)
+
+    # stages which did not run, e.g. the turbulent viscosity in DNS, are left out of the tables
+    stages = [s for s in STAGES if any(r[s] > 0.0 for r in results)]
+    write_tables(results, args.output, stages)
+    with open(os.path.join(args.output, "scaling.md"), "r") as md:
+        print("\n" + md.read())
+
+    failed = [r["name"] for r in results if r["E_loop"] is not None and r["E_loop"] < args.min_efficiency]
+    if failed:
+        sys.exit("Parallel efficiency below {0}: {1}".format(args.min_efficiency, ", ".join(failed)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,176 @@
+"""Regression tests: short runs of the cavity, channel, backward-facing step and turbulent channel
+in 2D and 3D on 1 and 4 ranks.
+
+Each run writes a checkpoint at its final time step, which is compared with the reference
+checkpoint of the case by 'chkpt_inspect -compare' (pressure and velocity over the inner cells,
+within a relative tolerance). The wall time per time step of the loop, the slowest rank's, is read
+from the timer report and compared with the stored baseline; a run fails if it is slower than the
+baseline by more than the allowed fraction. The references depend on the PETSc build and its
+solver, and the baseline on the machine, so neither is committed: pass --update once to generate
+both on the reference machine, and --baseline to store the timing alone. Without a baseline, the
+timing is not checked.
+
+Run from the root of the repository, usually through 'make regression' or 'make regression-update'.
+"""
+
+import argparse
+import glob
+import json
+import os
+import shlex
+import shutil
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# name: (template, final time, cells in z direction in 3D)
+CASES = {
+    "cavity": ("cavity.xml", 0.2, 8),
+    "channel": ("channel.xml", 0.5, 6),
+    "bfs": ("bfs.xml", 0.5, 6),
+    "turbulent": ("turbulent.xml", 0.5, 6),
+}
+
+# process grids per rank count and dimension
+GRIDS = {(1, 2): (1, 1, 1), (1, 3): (1, 1, 1), (4, 2): (2, 2, 1), (4, 3): (2, 2, 1)}
+
+
+def case_names(args):
+    names = []
+    for case in args.cases.split(","):
+        if case not in CASES:
+            sys.exit("Unknown case " + case)
+        for dim in [int(d) for d in args.dims.split(",")]:
+            for ranks in [int(r) for r in args.ranks.split(",")]:
+                if (ranks, dim) not in GRIDS:
+                    sys.exit("No process grid for {0} ranks in {1}D".format(ranks, dim))
+                names.append((case, dim, ranks, "{0}_{1}D_np{2}".format(case, dim, ranks)))
+    return names
+
+
+def run_case(args, case, dim, ranks, name):
+    """Runs a case and returns its configuration, its last checkpoint and its time per step"""
+    template, final_time, sizeZ = CASES[case]
+    grid = GRIDS[(ranks, dim)]
+    run_dir = os.path.join(args.output, name)
+    if os.path.exists(run_dir):
+        shutil.rmtree(run_dir)
+    os.makedirs(os.path.join(run_dir, "restart"))
+
+    with open(os.path.join(HERE, template), "r") as inConf:
+        conf_file = inConf.read()
+    conf_file = conf_file.format(dim=dim, sZ=sizeZ if dim == 3 else 1, final_time=final_time,
+                                 run_dir=run_dir, npX=grid[0], npY=grid[1], npZ=grid[2])
+    conf = os.path.join(run_dir, name + ".xml")
+    with open(conf, "w") as outConf:
+        outConf.write(conf_file)
+
+    command = shlex.split(args.mpirun.format(ranks=ranks)) + [args.ns, conf]
+    with open(os.path.join(run_dir, "log.txt"), "w") as log:
+        status = subprocess.call(command, stdout=log, stderr=subprocess.STDOUT)
+    if status != 0:
+        return conf, None, None, "run failed with status {0}, see {1}".format(status, os.path.join(run_dir, "log.txt"))
+
+    # the checkpoint of the last time step; the names carry the time step with leading zeros
+    checkpoints = sorted(glob.glob(os.path.join(run_dir, "restart", "checkpoint.*")))
+    if not checkpoints:
+        return conf, None, None, "no checkpoint written"
+    with open(os.path.join(run_dir, "timers.json"), "r") as report:
+        timers = json.load(report)
+    seconds = timers["loop"]["max"] / max(timers["timeSteps"], 1)
+    return conf, checkpoints[-1], seconds, None
+
+
+def compare(args, conf, checkpoint, reference):
+    command = [args.inspect, conf, checkpoint, "-compare", reference, "-fields", "pressure,velocity",
+               "-tolerance", str(args.tolerance)]
+    process = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    output = process.communicate()[0].decode()
+    return process.returncode == 0, output
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--ns", default="./ns", help="solver executable")
+    parser.add_argument("--inspect", default="./chkpt_inspect", help="checkpoint inspection executable")
+    parser.add_argument("--mpirun", default="mpirun -np {ranks}", help="launcher, {ranks} is replaced")
+    parser.add_argument("--output", default="output/regression")
+    parser.add_argument("--reference", default=os.path.join(HERE, "reference"),
+                        help="directory of the reference checkpoints and of baseline.json")
+    parser.add_argument("--cases", default=",".join(sorted(CASES)), help="cases, comma separated")
+    parser.add_argument("--dims", default="2,3")
+    parser.add_argument("--ranks", default="1,4")
+    parser.add_argument("--tolerance", type=float, default=1e-6,
+                        help="relative tolerance of pressure and velocity")
+    parser.add_argument("--slowdown", type=float, default=0.25,
+                        help="allowed slowdown of the time per step relative to the baseline, e.g. 0.25 for 25%%")
+    parser.add_argument("--no-timing", action="store_true", help="do not compare the time per step")
+    parser.add_argument("--baseline", action="store_true", help="store the times per step as baseline of this machine")
+    parser.add_argument("--update", action="store_true", help="store the results as references and baseline")
+    args = parser.parse_args()
+
+    baseline_file = os.path.join(args.reference, "baseline.json")
+    baseline = {}
+    if os.path.exists(baseline_file):
+        with open(baseline_file, "r") as inBaseline:
+            baseline = json.load(inBaseline)
+    if args.update and not os.path.exists(args.reference):
+        os.makedirs(args.reference)
+    store_baseline = args.update or args.baseline
+    if not args.update and not glob.glob(os.path.join(args.reference, "*.chkpt")):
+        sys.exit("No reference checkpoints in {0}; generate them first with 'make regression-update' "
+                 "on this machine".format(args.reference))
+    if not baseline and not store_baseline and not args.no_timing:
+        print("No timing baseline in {0}, the times per step are not checked; store it with "
+              "'make regression-baseline'\n".format(args.reference))
+
+    failures = []
+    print("{0:<24} {1:>8} {2:>14} {3:>14} {4:>9}".format("case", "fields", "ms/step", "baseline", "change"))
+    for case, dim, ranks, name in case_names(args):
+        conf, checkpoint, seconds, error = run_case(args, case, dim, ranks, name)
+        if error is not None:
+            print("{0:<24} {1}".format(name, error))
+            failures.append(name)
+            continue
+
+        reference = os.path.join(args.reference, name + ".chkpt")
+        if args.update:
+            shutil.copyfile(checkpoint, reference)
+            baseline[name] = seconds
+            print("{0:<24} {1:>8} {2:>14.4f}".format(name, "stored", 1e3 * seconds))
+            continue
+
+        if not os.path.exists(reference):
+            fields = "missing"
+            failures.append(name)
+        else:
+            passed, output = compare(args, conf, checkpoint, reference)
+            fields = "ok" if passed else "FAILED"
+            if not passed:
+                print(output)
+                failures.append(name)
+
+        line = "{0:<24} {1:>8} {2:>14.4f}".format(name, fields, 1e3 * seconds)
+        if args.baseline:
+            baseline[name] = seconds
+        elif name in baseline and not args.no_timing:
+            change = seconds / baseline[name] - 1.0
+            line += " {0:>14.4f} {1:>+8.1f}%".format(1e3 * baseline[name], 1e2 * change)
+            if change > args.slowdown:
+                line += " SLOWER"
+                failures.append(name)
+        print(line)
+        sys.stdout.flush()
+
+    if store_baseline:
+        with open(baseline_file, "w") as outBaseline:
+            json.dump(baseline, outBaseline, indent=2, sort_keys=True)
+            outBaseline.write("\n")
+        print("\n{0} written to {1}".format("References and baseline" if args.update else "Baseline", args.reference))
+    if failures:
+        sys.exit("\nRegression failures: " + ", ".join(sorted(set(failures))))
+
+
+if __name__ == "__main__":
+    main()
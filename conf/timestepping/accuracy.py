@@ -0,0 +1,166 @@
+"""Accuracy against wall time of the time integration schemes, explicit Euler and the low-storage
+three-stage Runge-Kutta scheme (<timestep scheme="euler|rk3">), on the 2D cavity and channel of the
+regression tests.
+
+Every case is first spun up with explicit Euler to the start time; all other runs restart from its
+last checkpoint, so that the impulsive start, which no explicit step near the stability limit
+resolves, is not part of the comparison. The run with the adaptive step and tau=1 over the interval
+gives the mean stable step dt_s. Each scheme and tau is then run with the fixed step
+(adaptive="false") closest to tau*dt_s which divides the interval, so that all runs end at the same
+time. The velocity of the last checkpoint is compared with a reference run of the Runge-Kutta scheme
+with a small tau by 'chkpt_inspect -compare' (maximum difference relative to the maximum of the
+reference); a run which is unstable for its tau shows as failed or with an error of nan. The wall
+time is the one of the loop of the slowest rank. For each case, the cheapest run of each scheme
+within the target error is reported.
+
+Run from the root of the repository, usually through 'make timestepping'.
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TEMPLATES = os.path.join(HERE, "..", "regression")
+
+CASES = {
+    "cavity": "cavity.xml",
+    "channel": "channel.xml",
+}
+
+TIMESTEP = re.compile(r"<timestep[^>]*/>")
+
+
+def run(args, case, name, scheme, timestep, final_time, restart=None):
+    """Runs a case and returns its configuration, its last checkpoint and the loop time. The time
+    step is the fixed dt, or None for the adaptive one with tau"""
+    run_dir = os.path.join(args.output, name)
+    if os.path.exists(run_dir):
+        shutil.rmtree(run_dir)
+    os.makedirs(os.path.join(run_dir, "restart"))
+
+    with open(os.path.join(TEMPLATES, CASES[case]), "r") as inConf:
+        conf_file = inConf.read()
+    conf_file = conf_file.format(dim=2, sZ=1, final_time=repr(final_time), run_dir=run_dir, npX=1, npY=1, npZ=1)
+    if timestep is None:
+        element = '<timestep dt="1" tau="1.0" scheme="{0}" />'.format(scheme)
+    else:
+        element = '<timestep dt="{0!r}" adaptive="false" scheme="{1}" />'.format(timestep, scheme)
+    conf_file = TIMESTEP.sub(element, conf_file)
+    if restart is not None:
+        # the time of the restarted run starts at 0
+        conf_file = conf_file.replace("</configuration>", '    <restart startNew="true">{0}</restart>\n'
+                                      '</configuration>'.format(restart))
+    conf = os.path.join(run_dir, name + ".xml")
+    with open(conf, "w") as outConf:
+        outConf.write(conf_file)
+
+    command = shlex.split(args.mpirun) + [args.ns, conf]
+    with open(os.path.join(run_dir, "log.txt"), "w") as log:
+        status = subprocess.call(command, stdout=log, stderr=subprocess.STDOUT)
+    checkpoints = sorted(glob.glob(os.path.join(run_dir, "restart", "checkpoint.*")))
+    if status != 0 or not checkpoints:
+        return conf, None, None
+    with open(os.path.join(run_dir, "timers.json"), "r") as report:
+        timers = json.load(report)
+    return conf, checkpoints[-1], timers["loop"]["max"]
+
+
+def inspect(args, conf, checkpoint, options):
+    command = [args.inspect, conf, checkpoint] + options
+    process = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    return process.communicate()[0].decode()
+
+
+def time_steps_of(args, conf, checkpoint):
+    match = re.search(r"^Timestep:\s+(\d+)", inspect(args, conf, checkpoint, []), re.MULTILINE)
+    return int(match.group(1))
+
+
+def velocity_error(args, conf, checkpoint, reference):
+    """Maximum difference of the velocity relative to the maximum of the reference, NaN if the run
+    blew up"""
+    output = inspect(args, conf, checkpoint, ["-compare", reference, "-fields", "velocity", "-tolerance", "0"])
+    match = re.search(r"^velocity\s+\S+\s+\S+\s+(\S+)", output, re.MULTILINE)
+    return float(match.group(1)) if match else float("nan")
+
+
+def run_fixed(args, case, name, scheme, tau, stable_dt, restart):
+    """Runs with the fixed step closest to tau*stable_dt which divides the interval; returns the
+    step count, the effective tau, the configuration, the checkpoint and the loop time"""
+    steps = max(int(round(args.interval / (tau * stable_dt))), 1)
+    # stop after the step which reaches the end of the interval, whatever the rounding of the sum
+    conf, checkpoint, seconds = run(args, case, name, scheme, args.interval / steps,
+                                    args.interval * (1.0 - 0.5 / steps), restart)
+    return steps, args.interval / (steps * stable_dt), conf, checkpoint, seconds
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--ns", default="./ns", help="solver executable")
+    parser.add_argument("--inspect", default="./chkpt_inspect", help="checkpoint inspection executable")
+    parser.add_argument("--mpirun", default="mpirun -np 1", help="launcher of the single rank runs")
+    parser.add_argument("--output", default="output/timestepping")
+    parser.add_argument("--cases", default=",".join(sorted(CASES)), help="cases, comma separated")
+    parser.add_argument("--schemes", default="euler,rk3")
+    parser.add_argument("--taus", default="0.125,0.25,0.5,1.0,1.5", help="safety factors, comma separated")
+    parser.add_argument("--reference-tau", type=float, default=0.05, help="tau of the Runge-Kutta reference")
+    parser.add_argument("--start-time", type=float, default=2.0, help="time of the spin-up run")
+    parser.add_argument("--interval", type=float, default=0.5, help="time integrated by the compared runs")
+    parser.add_argument("--target", type=float, default=1e-3, help="target relative error of the velocity")
+    args = parser.parse_args()
+
+    results = []
+    print("{0:<10} {1:<6} {2:>8} {3:>7} {4:>12} {5:>14}".format("case", "scheme", "tau", "steps", "loop (s)", "error"))
+    for case in args.cases.split(","):
+        if case not in CASES:
+            sys.exit("Unknown case " + case)
+
+        conf, restart, seconds = run(args, case, case + "_spinup", "euler", None, args.start_time)
+        if restart is None:
+            sys.exit("The spin-up run of {0} failed".format(case))
+
+        # the mean stable time step of explicit Euler
+        conf, checkpoint, seconds = run(args, case, case + "_adaptive", "euler", None, args.interval, restart)
+        if checkpoint is None:
+            sys.exit("Cannot determine the stable time step of " + case)
+        stable_dt = args.interval / time_steps_of(args, conf, checkpoint)
+
+        steps, tau, conf, reference, seconds = run_fixed(args, case, case + "_reference", "rk3",
+                                                         args.reference_tau, stable_dt, restart)
+        if reference is None:
+            sys.exit("The reference run of {0} failed".format(case))
+
+        for scheme in args.schemes.split(","):
+            best = None
+            for requested in [float(t) for t in args.taus.split(",")]:
+                name = "{0}_{1}_tau{2}".format(case, scheme, requested)
+                steps, tau, conf, checkpoint, seconds = run_fixed(args, case, name, scheme, requested, stable_dt,
+                                                                 restart)
+                if checkpoint is None:
+                    print("{0:<10} {1:<6} {2:>8.4f} {3:>7} {4:>12} {5:>14}".format(case, scheme, tau, steps, "-", "failed"))
+                    continue
+                error = velocity_error(args, conf, checkpoint, reference)
+                line = "{0:<10} {1:<6} {2:>8.4f} {3:>7} {4:>12.4f} {5:>14.6e}".format(case, scheme, tau, steps, seconds, error)
+                print(line)
+                sys.stdout.flush()
+                if error <= args.target and (best is None or seconds < best[1]):
+                    best = (tau, seconds, error)
+            results.append((case, scheme, best))
+
+    print("\nCheapest run within a velocity error of {0:g}:".format(args.target))
+    for case, scheme, best in results:
+        if best is None:
+            print("{0:<10} {1:<6} none".format(case, scheme))
+        else:
+            print("{0:<10} {1:<6} tau {2:.4f}, {3:.4f} s, error {4:.3e}".format(case, scheme, *best))
+
+
+if __name__ == "__main__":
+    main()
@@ -8,6 +8,7 @@
 #include <iomanip>
 #include "TurbulentSimulation.h"
 #include "SimpleTimer.h"
+#include "Timers.h"
 
 int main (int argc, char *argv[]) {
 
@@ -18,9 +19,7 @@ int main (int argc, char *argv[]) {
     PetscInitialize(&argc, &argv, "petsc_commandline_arg", PETSC_NULL);
     MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
     MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
-    #ifndef chkpt_to_vtk
     std::cout << "Rank: " << rank << ", Nproc: " << nproc << std::endl;
-    #endif
     //----------------------------------------------------
 
 
@@ -28,19 +27,17 @@ int main (int argc, char *argv[]) {
     Configuration configuration(argv[1]);
     Parameters parameters;
     configuration.loadParameters(parameters);
-    #ifdef chkpt_to_vtk
-    parameters.parallel.numProcessors[0] = 1;
-    parameters.parallel.numProcessors[1] = 1;
-    parameters.parallel.numProcessors[2] = 1;
-    parameters.restart.startNew = false;
-    #endif
     PetscParallelConfiguration parallelConfiguration(parameters);
     MeshsizeFactory::getInstance().initMeshsize(parameters);
     FlowField *flowField = NULL;
     Simulation *simulation = NULL;
     SimpleTimer timer = SimpleTimer();
+    TimerRegistry::getInstance().setEnabled(parameters.timers.active);
+    if (parameters.timers.active && parameters.timers.counters
+        && !TimerRegistry::getInstance().enableCounters() && parameters.parallel.rank == 0) {
+        std::cout << "Hardware counters are not available (compiled without -DPERF_COUNTERS, no PMU or perf_event_paranoid > 2)" << std::endl;
+    }
 
-    #ifndef chkpt_to_vtk
     #ifdef DEBUG
     std::cout << "Processor " << parameters.parallel.rank << " with index ";
     std::cout << parameters.parallel.indices[0] << ",";
@@ -56,14 +53,11 @@ int main (int argc, char *argv[]) {
     std::cout << "Min. meshsizes: " << parameters.meshsize->getDxMin() << ", " << parameters.meshsize->getDyMin() << ", " << parameters.meshsize->getDzMin() << std::endl;
     std::cout << "Checkpoint iterations: " << parameters.checkpoint.iterations << ", directory: " << parameters.checkpoint.directory << ", prefix: " << parameters.checkpoint.prefix << ", cleanDirectory:" << parameters.checkpoint.cleanDirectory << std::endl;
     std::cout << "Restart filename: " << parameters.restart.filename << std::endl;
-    #endif
-    #endif
+    #endif
 
     // initialise simulation
     if (parameters.simulation.type=="turbulence"){
-        #ifndef chkpt_to_vtk
         if(rank==0){ std::cout << "Start RANS simulation in " << parameters.geometry.dim << "D" << std::endl; }
-        #endif
         // WS2: initialise turbulent flow field and turbulent simulation object
         TurbulentFlowField *turbFlowField = NULL;
         turbFlowField = new TurbulentFlowField(parameters);
@@ -72,66 +66,54 @@ int main (int argc, char *argv[]) {
         simulation = new TurbulentSimulation(parameters,*turbFlowField);
         // handleError(1,"Turbulence currently not supported yet!");
     } else if (parameters.simulation.type=="dns"){
-        #ifndef chkpt_to_vtk
         if(rank==0){ std::cout << "Start DNS simulation in " << parameters.geometry.dim << "D" << std::endl; }
-        #endif
         flowField = new FlowField(parameters);
         if(flowField == NULL){ handleError(1, "flowField==NULL!"); }
         simulation = new Simulation(parameters,*flowField);
     } else {
         handleError(1, "Unknown simulation type! Currently supported: dns, turbulence");
     }
-    // call initialization of simulation (initialize flow field)
+    // call initialization of simulation (initialize flow field). Complete checkpoints also hold
+    // the flags and the derived fields, so restarting from them skips the initialization.
     if(simulation == NULL){ handleError(1, "simulation==NULL!"); }
-    simulation->initializeFlowField();
+    if (parameters.restart.filename == "" || !simulation->isCheckpointComplete()) {
+        simulation->initializeFlowField();
+    }
     //flowField->getFlags().show();
 
     int timeSteps = 0;
     FLOAT time = 0.0;
 
-    #ifdef chkpt_to_vtk
-    // iterate through all checkpoint files
-    DIR* dir_pointer = opendir(parameters.checkpoint.directory.c_str());
-    dirent* file_pointer;
-    while ((file_pointer = readdir(dir_pointer)) != NULL) {
-        if (!strncmp(file_pointer->d_name, parameters.checkpoint.prefix.c_str(), parameters.checkpoint.prefix.size())) {
-            parameters.restart.filename = parameters.checkpoint.directory + std::string(file_pointer->d_name);
-            simulation->readCheckpoint(timeSteps, time);
-            if (parameters.simulation.type=="turbulence") {
-                ((TurbulentSimulation*)simulation)->computeTurbVisc();
-            }
-            std::cout << "Plotting time step " << timeSteps << std::endl;
-            simulation->plotVTK(timeSteps);
-        }
-    }
-    closedir(dir_pointer);
-
-    // exit application
-    delete simulation; simulation=NULL;
-    delete flowField;  flowField= NULL;
-    PetscFinalize();
-    return 0;
-    #endif
-
     // Read the restart data
     if(parameters.restart.filename != "") {
-        simulation->readCheckpoint(timeSteps, time);
+        simulation->readCheckpoint(timeSteps, time);
         if (parameters.restart.startNew) {
             timeSteps = 0;
             time = 0.0;
-        }
+        } else {
+            simulation->continueVtk(time);
+        }
     }
 
     FLOAT lastPlotTime = time;
+    FLOAT lastProbeTime = time;
+    std::vector<FLOAT> lastStreamTime(parameters.vtkStreams.size(), time);
     int lastCheckpointIter = timeSteps;
+    const int firstTimeStep = timeSteps;
     FLOAT timeStdOut=parameters.stdOut.interval;
 
     // WS1: plot initial state
     if(parameters.restart.filename == "" && parameters.vtk.active) {
-        simulation->plotVTK(timeSteps);
+        simulation->plotVTK(timeSteps, time);
+    }
+    for (unsigned int s = 0; parameters.restart.filename == "" && s < parameters.vtkStreams.size(); s++) {
+        simulation->plotVtkStream(s, timeSteps, time);
+    }
+    if(parameters.restart.filename == "" && parameters.probes.active) {
+        simulation->sampleProbes(time);
     }
 
-    // initialize the region timers
+    // totals of the loop, the solver and the communication; the stages are timed in the TimerRegistry
     FLOAT time_loop  = 0; FLOAT time_loop_tot  = 0;
     FLOAT time_solve = 0; FLOAT time_solve_tot = 0;
     FLOAT time_comm  = 0; FLOAT time_comm_tot  = 0;
@@ -144,18 +126,40 @@ int main (int argc, char *argv[]) {
     // start the global timer
     timer.start();
 
-    // time loop
-    while (time < parameters.simulation.finalTime){
+    // time loop; in the steady-state mode, the pseudo-time steps end once the residuals are below the
+    // tolerances, finalTime bounds them
+    bool converged = false, checked = false;
+    while (time < parameters.simulation.finalTime && !converged){
 
-        simulation->solveTimestep(time_solve, time_comm);
+        simulation->solveTimestep();
 
         time += parameters.timestep.dt;
         timeSteps++;
 
+        // iterations, residuals and times of the pressure solve
+        if (parameters.solver.telemetry) {
+            simulation->recordSolverTelemetry(timeSteps, time);
+        }
+
+        // accumulate the time-averaged statistics
+        if (parameters.statistics.active) {
+            simulation->sampleStatistics(time, parameters.timestep.dt);
+        }
+
+        if (parameters.steady.active && timeSteps % parameters.steady.interval == 0) {
+            converged = simulation->isConverged();
+            checked = true;
+        }
+
         // std-out: terminal info
         if ( (rank==0) && (timeStdOut <= time) ){
             std::cout << "Current time: " << time << "\ttimestep: " <<
-                        parameters.timestep.dt << "\titeration: " << timeSteps <<std::endl << std::endl;
+                        parameters.timestep.dt << "\titeration: " << timeSteps << std::endl;
+            if (checked) {
+                std::cout << "Residual: " << simulation->getSteadyState().getResidual() << "\tdivergence: " <<
+                            simulation->getSteadyState().getDivergence() << std::endl;
+            }
+            std::cout << std::endl;
             timeStdOut += parameters.stdOut.interval;
         }
 
@@ -173,15 +177,41 @@ int main (int argc, char *argv[]) {
             }
         }
 
+        // sample the probes
+        if (parameters.probes.active && lastProbeTime + parameters.probes.interval <= time) {
+            simulation->sampleProbes(time);
+            lastProbeTime += parameters.probes.interval;
+        }
+
         // WS1: trigger VTK output
         if (parameters.vtk.active && lastPlotTime + parameters.vtk.interval <= time) {
-            simulation->plotVTK(timeSteps); // TODO Change to time?
+            simulation->plotVTK(timeSteps, time);
             lastPlotTime += parameters.vtk.interval;
         }
+
+        // slices and downsampled fields, each with its own interval
+        for (unsigned int s = 0; s < parameters.vtkStreams.size(); s++) {
+            if (lastStreamTime[s] + parameters.vtkStreams[s].interval <= time) {
+                simulation->plotVtkStream(s, timeSteps, time);
+                lastStreamTime[s] += parameters.vtkStreams[s].interval;
+            }
+        }
+    }
+
+    if (rank == 0 && checked) {
+        if (converged) {
+            std::cout << "Steady state reached after " << timeSteps << " iterations";
+        } else {
+            std::cout << "Steady state not reached until the final time, " << timeSteps << " iterations";
+        }
+        std::cout << ": residual " << simulation->getSteadyState().getResidual() << ", divergence " <<
+                     simulation->getSteadyState().getDivergence() << std::endl;
     }
 
     // take computation time
     time_loop = timer.getTimeAndContinue();
+    time_solve = TimerRegistry::getInstance().getTime(TimerSolve);
+    time_comm = TimerRegistry::getInstance().getCommunicationTime();
     printf("[Rank %d] Timers (s):\tloop: %f | solve: %f  comm: %f  other: %f\n", rank, time_loop, time_solve, time_comm, time_loop-time_solve-time_comm);
     MPI_Reduce(&time_loop,  &time_loop_tot,  1, MY_MPI_FLOAT, MPI_SUM, 0, PETSC_COMM_WORLD);
     MPI_Reduce(&time_solve, &time_solve_tot, 1, MY_MPI_FLOAT, MPI_SUM, 0, PETSC_COMM_WORLD);
@@ -191,12 +221,35 @@ int main (int argc, char *argv[]) {
         std::cerr << parameters.parallel.numProcessors[0] << "x" << parameters.parallel.numProcessors[1] << "x" << parameters.parallel.numProcessors[2] << ": " << time_loop_tot/nproc << std::endl; // Output time in cerr for easy redirection into file
     }
 
+    if (TimerRegistry::getInstance().countersEnabled()) {
+        TimerRegistry::getInstance().printCounters();
+    }
+
+    simulation->printTurbViscUpdates(time_loop);
+
+    if (parameters.solver.telemetry) {
+        simulation->writeSolverTelemetry();
+    }
+
+    // write the time-averaged statistics
+    if (parameters.statistics.active) {
+        simulation->writeStatistics();
+    }
+
     // Create the final checkpoint
     simulation->createCheckpoint(timeSteps, time);
 
     // WS1: plot final output
     if(parameters.vtk.active) {
-        simulation->plotVTK(timeSteps);
+        simulation->plotVTK(timeSteps, time);
+    }
+    for (unsigned int s = 0; s < parameters.vtkStreams.size(); s++) {
+        simulation->plotVtkStream(s, timeSteps, time);
+    }
+
+    // report the timers of all stages, including the final output
+    if (parameters.timers.active && parameters.timers.filename != "") {
+        TimerRegistry::getInstance().writeReport(parameters.timers.filename, time_loop, timeSteps - firstTimeStep);
     }
 
     delete simulation; simulation=NULL;
@@ -104,6 +104,8 @@ void PetscParallelManager::communicatePressure(){
     MPI_Status comm_status;
     MPI_Request send_requestL, send_requestR, send_requestBt, send_requestT, send_requestF, send_requestBk;
     MPI_Request recv_requestL, recv_requestR, recv_requestBt, recv_requestT, recv_requestF, recv_requestBk;
+    // the front and back requests are not used in 2D, but waited for below
+    send_requestF = send_requestBk = recv_requestF = recv_requestBk = MPI_REQUEST_NULL;
 
     // ------------------------------------------------------------------------
     // Communicate pressure in the X-dimension:
@@ -208,6 +210,8 @@ void PetscParallelManager::communicateVelocities(){
     MPI_Status comm_status;
     MPI_Request send_requestL, send_requestR, send_requestBt, send_requestT, send_requestF, send_requestBk;
     MPI_Request recv_requestL, recv_requestR, recv_requestBt, recv_requestT, recv_requestF, recv_requestBk;
+    // the front and back requests are not used in 2D, but waited for below
+    send_requestF = send_requestBk = recv_requestF = recv_requestBk = MPI_REQUEST_NULL;
 
     // ------------------------------------------------------------------------
     // Communicate velocities in the X-dimension:
@@ -55,28 +55,58 @@ _turbFlowField(turbFlowField)
         if (_parameters.geometry.dim == 2) {
             _turbViscBufferFillStencil = new TurbViscosityBufferFillStencil(_parameters, _turbViscLeftSend,  _turbViscRightSend,  _turbViscBottomSend,  _turbViscTopSend, lowOffset);
             _turbViscBufferReadStencil = new TurbViscosityBufferReadStencil(_parameters, _turbViscLeftRecv,  _turbViscRightRecv,  _turbViscBottomRecv,  _turbViscTopRecv, lowOffset);
+            _distBufferFillStencil = new DistNearestWallBufferFillStencil(_parameters, _turbViscLeftSend,  _turbViscRightSend,  _turbViscBottomSend,  _turbViscTopSend, lowOffset);
+            _distBufferReadStencil = new DistNearestWallBufferReadStencil(_parameters, _turbViscLeftRecv,  _turbViscRightRecv,  _turbViscBottomRecv,  _turbViscTopRecv, lowOffset);
+            _nuTildeBufferFillStencil = new NuTildeBufferFillStencil(_parameters, _turbViscLeftSend,  _turbViscRightSend,  _turbViscBottomSend,  _turbViscTopSend, lowOffset);
+            _nuTildeBufferReadStencil = new NuTildeBufferReadStencil(_parameters, _turbViscLeftRecv,  _turbViscRightRecv,  _turbViscBottomRecv,  _turbViscTopRecv, lowOffset);
         } else if (_parameters.geometry.dim == 3) {
             _turbViscBufferFillStencil = new TurbViscosityBufferFillStencil(_parameters, _turbViscLeftSend,  _turbViscRightSend,  _turbViscBottomSend,  _turbViscTopSend,  _turbViscFrontSend,  _turbViscBackSend, lowOffset);
             _turbViscBufferReadStencil = new TurbViscosityBufferReadStencil(_parameters, _turbViscLeftRecv,  _turbViscRightRecv,  _turbViscBottomRecv,  _turbViscTopRecv,  _turbViscFrontRecv,  _turbViscBackRecv, lowOffset);
+            _distBufferFillStencil = new DistNearestWallBufferFillStencil(_parameters, _turbViscLeftSend,  _turbViscRightSend,  _turbViscBottomSend,  _turbViscTopSend,  _turbViscFrontSend,  _turbViscBackSend, lowOffset);
+            _distBufferReadStencil = new DistNearestWallBufferReadStencil(_parameters, _turbViscLeftRecv,  _turbViscRightRecv,  _turbViscBottomRecv,  _turbViscTopRecv,  _turbViscFrontRecv,  _turbViscBackRecv, lowOffset);
+            _nuTildeBufferFillStencil = new NuTildeBufferFillStencil(_parameters, _turbViscLeftSend,  _turbViscRightSend,  _turbViscBottomSend,  _turbViscTopSend,  _turbViscFrontSend,  _turbViscBackSend, lowOffset);
+            _nuTildeBufferReadStencil = new NuTildeBufferReadStencil(_parameters, _turbViscLeftRecv,  _turbViscRightRecv,  _turbViscBottomRecv,  _turbViscTopRecv,  _turbViscFrontRecv,  _turbViscBackRecv, lowOffset);
         }
 
         // Construct the iterators
         _parallelBoundaryTurbViscFillIterator = new ParallelBoundaryIterator<TurbulentFlowField>(_turbFlowField, _parameters, *_turbViscBufferFillStencil, lowOffset, highOffset);
         _parallelBoundaryTurbViscReadIterator = new ParallelBoundaryIterator<TurbulentFlowField>(_turbFlowField, _parameters, *_turbViscBufferReadStencil, lowOffset, highOffset);
+        _parallelBoundaryDistFillIterator = new ParallelBoundaryIterator<TurbulentFlowField>(_turbFlowField, _parameters, *_distBufferFillStencil, lowOffset, highOffset);
+        _parallelBoundaryDistReadIterator = new ParallelBoundaryIterator<TurbulentFlowField>(_turbFlowField, _parameters, *_distBufferReadStencil, lowOffset, highOffset);
+        _parallelBoundaryNuTildeFillIterator = new ParallelBoundaryIterator<TurbulentFlowField>(_turbFlowField, _parameters, *_nuTildeBufferFillStencil, lowOffset, highOffset);
+        _parallelBoundaryNuTildeReadIterator = new ParallelBoundaryIterator<TurbulentFlowField>(_turbFlowField, _parameters, *_nuTildeBufferReadStencil, lowOffset, highOffset);
 
     }
 
 
 void PetscTurbulentParallelManager::communicateTurbViscosity(){
+    communicate(*_parallelBoundaryTurbViscFillIterator, *_parallelBoundaryTurbViscReadIterator);
+}
+
+
+void PetscTurbulentParallelManager::communicateDistNearestWall(){
+    communicate(*_parallelBoundaryDistFillIterator, *_parallelBoundaryDistReadIterator);
+}
+
+
+void PetscTurbulentParallelManager::communicateNuTilde(){
+    communicate(*_parallelBoundaryNuTildeFillIterator, *_parallelBoundaryNuTildeReadIterator);
+}
+
+
+void PetscTurbulentParallelManager::communicate(ParallelBoundaryIterator<TurbulentFlowField> & fillIterator,
+                                                ParallelBoundaryIterator<TurbulentFlowField> & readIterator){
 
     MPI_Status comm_status;
     MPI_Request send_requestL, send_requestR, send_requestBt, send_requestT, send_requestF, send_requestBk;
     MPI_Request recv_requestL, recv_requestR, recv_requestBt, recv_requestT, recv_requestF, recv_requestBk;
+    // the front and back requests are not used in 2D, but waited for below
+    send_requestF = send_requestBk = recv_requestF = recv_requestBk = MPI_REQUEST_NULL;
 
     // ------------------------------------------------------------------------
     // Communicate in the X-dimension:
     // Fill the turbulent viscosity send buffers L/R
-    _parallelBoundaryTurbViscFillIterator->iterate(0);
+    fillIterator.iterate(0);
 
     // Left --> + --> Right
     MPI_Isend(_turbViscRightSend, turbViscBufSizeLR, MY_MPI_FLOAT, _parameters.parallel.rightNb, 1, PETSC_COMM_WORLD, &send_requestR);
@@ -91,7 +121,7 @@ void PetscTurbulentParallelManager::communicateTurbViscosity(){
     MPI_Wait(&recv_requestR, &comm_status);
 
     // Read the turbulent viscosity receive buffers L/R
-    _parallelBoundaryTurbViscReadIterator->iterate(0);
+    readIterator.iterate(0);
     // ------------------------------------------------------------------------
 
 
@@ -99,7 +129,7 @@ void PetscTurbulentParallelManager::communicateTurbViscosity(){
     // ------------------------------------------------------------------------
     // Communicate in the Y-dimension:
     // Fill the turbulent viscosity send buffers T/B
-    _parallelBoundaryTurbViscFillIterator->iterate(1);
+    fillIterator.iterate(1);
 
     // Bottom --> + --> Top
     MPI_Isend(_turbViscTopSend,    turbViscBufSizeTB, MY_MPI_FLOAT, _parameters.parallel.topNb,    3, PETSC_COMM_WORLD, &send_requestT);
@@ -114,7 +144,7 @@ void PetscTurbulentParallelManager::communicateTurbViscosity(){
     MPI_Wait(&recv_requestT,  &comm_status);
 
     // Read the turbulent viscosity receive buffers T/B
-    _parallelBoundaryTurbViscReadIterator->iterate(1);
+    readIterator.iterate(1);
     // ------------------------------------------------------------------------
 
 
@@ -124,7 +154,7 @@ void PetscTurbulentParallelManager::communicateTurbViscosity(){
     if (_parameters.geometry.dim == 3) {
 
         // Fill the turbulent viscosity send buffers F/B
-        _parallelBoundaryTurbViscFillIterator->iterate(2);
+        fillIterator.iterate(2);
 
         // Front --> + --> Back
         MPI_Isend(_turbViscBackSend,  turbViscBufSizeFB, MY_MPI_FLOAT, _parameters.parallel.backNb,  5, PETSC_COMM_WORLD, &send_requestBk);
@@ -138,7 +168,7 @@ void PetscTurbulentParallelManager::communicateTurbViscosity(){
         MPI_Wait(&recv_requestBk, &comm_status);
 
         // Read the turbulent viscosity receive buffers F/B
-        _parallelBoundaryTurbViscReadIterator->iterate(2);
+        readIterator.iterate(2);
     }
     // ------------------------------------------------------------------------
 
@@ -3,6 +3,8 @@
 
 #include "../stencils/TurbViscosityBufferFillStencil.h"
 #include "../stencils/TurbViscosityBufferReadStencil.h"
+#include "../stencils/DistNearestWallBufferStencils.h"
+#include "../stencils/NuTildeBufferStencils.h"
 #include "../Parameters.h"
 #include "../TurbulentFlowField.h"
 #include "../Iterators.h"
@@ -43,6 +45,25 @@ class PetscTurbulentParallelManager {//: public PetscParallelManager {
         ParallelBoundaryIterator<TurbulentFlowField> * _parallelBoundaryTurbViscFillIterator;
         ParallelBoundaryIterator<TurbulentFlowField> * _parallelBoundaryTurbViscReadIterator;
 
+        // The distances to the nearest wall share the buffers of the turbulent viscosity
+        DistNearestWallBufferFillStencil * _distBufferFillStencil;
+        DistNearestWallBufferReadStencil * _distBufferReadStencil;
+        ParallelBoundaryIterator<TurbulentFlowField> * _parallelBoundaryDistFillIterator;
+        ParallelBoundaryIterator<TurbulentFlowField> * _parallelBoundaryDistReadIterator;
+
+        // So does the working variable of the Spalart-Allmaras model
+        NuTildeBufferFillStencil * _nuTildeBufferFillStencil;
+        NuTildeBufferReadStencil * _nuTildeBufferReadStencil;
+        ParallelBoundaryIterator<TurbulentFlowField> * _parallelBoundaryNuTildeFillIterator;
+        ParallelBoundaryIterator<TurbulentFlowField> * _parallelBoundaryNuTildeReadIterator;
+
+        /** Exchanges the ghost layers of a scalar field through the buffers
+         * @param fillIterator Iterator filling the send buffers from the field
+         * @param readIterator Iterator reading the receive buffers into the field
+         */
+        void communicate(ParallelBoundaryIterator<TurbulentFlowField> & fillIterator,
+                         ParallelBoundaryIterator<TurbulentFlowField> & readIterator);
+
     public:
 
         /** Constructor
@@ -57,6 +78,14 @@ class PetscTurbulentParallelManager {//: public PetscParallelManager {
         */
         void communicateTurbViscosity();
 
+        /** Communicates the distances to the nearest wall between processes.
+        */
+        void communicateDistNearestWall();
+
+        /** Communicates the working variable of the Spalart-Allmaras model between processes.
+        */
+        void communicateNuTilde();
+
 };
 
 
@@ -60,7 +60,7 @@ void createLimits(Parameters & parameters, DM & da, int *limitsX, int *limitsY,
 
 
 PetscUserCtx::PetscUserCtx(Parameters & parameters, FlowField & flowField):
-    _parameters(parameters), _flowField(flowField){}
+    _parameters(parameters), _flowField(flowField), weights(NULL){}
 
 Parameters & PetscUserCtx::getParameters(){
     return _parameters;
@@ -86,8 +86,55 @@ PetscErrorCode computeMatrix3D(KSP ksp, Mat A, Mat pc, MatStructure * matStructu
 PetscErrorCode computeRHS2D(KSP ksp, Vec b, void* ctx);
 PetscErrorCode computeRHS3D(KSP ksp, Vec b, void* ctx);
 
+// Adds the iterations of the last solve to the statistics of the solver
+void countIterations(KSP & ksp, int & solves, int & iterations){
+    PetscInt its;
+    KSPGetIterationNumber(ksp, &its);
+    solves++;
+    iterations += its;
+}
+
+// KSP monitor keeping the first and the last residual norm of a solve in the SolveRecord
+PetscErrorCode recordResidual(KSP ksp, PetscInt it, PetscReal rnorm, void * ctx){
+    SolveRecord * record = (SolveRecord *) ctx;
+    if (it == 0){
+        record->initialResidual = rnorm;
+    }
+    record->finalResidual = rnorm;
+    return 0;
+}
+
+// Sets the operator and the right hand side of the next solve and sets the solver up, so that the
+// assembly and the factorization of the preconditioner are timed apart from the iterations
+#if (PETSC_VERSION_MAJOR ==3 && PETSC_VERSION_MINOR>=5)
+void setUpSolve(KSP & ksp, PetscErrorCode (*computeRHS)(KSP, Vec, void*),
+                PetscErrorCode (*computeOperators)(KSP, Mat, Mat, void*), PetscUserCtx & ctx,
+                SolveRecord & record){
+#else
+void setUpSolve(KSP & ksp, PetscErrorCode (*computeRHS)(KSP, Vec, void*),
+                PetscErrorCode (*computeOperators)(KSP, Mat, Mat, MatStructure*, void*),
+                PetscUserCtx & ctx, SolveRecord & record){
+#endif
+    const double start = MPI_Wtime();
+    KSPSetComputeRHS(ksp, computeRHS, &ctx);
+    KSPSetComputeOperators(ksp, computeOperators, &ctx);
+    KSPSetUp(ksp);
+    record.setupTime = MPI_Wtime() - start;
+}
+
+// Completes the record of the last solve
+void finishRecord(KSP & ksp, double start, SolveRecord & record){
+    PetscInt its;
+    KSPConvergedReason reason;
+    KSPGetIterationNumber(ksp, &its);
+    KSPGetConvergedReason(ksp, &reason);
+    record.solveTime = MPI_Wtime() - start;
+    record.iterations = its;
+    record.converged = (int) reason;
+}
+
 PetscSolver::PetscSolver(FlowField & flowField, Parameters & parameters):
-    LinearSolver(flowField, parameters), _ctx(parameters, flowField){
+    LinearSolver(flowField, parameters), _ctx(parameters, flowField), _solves(0), _iterations(0){
 
     // Set the type of boundary nodes of the system
 #if ((PETSC_VERSION_MAJOR==3) && (PETSC_VERSION_MINOR>=5))
@@ -269,6 +316,7 @@ PetscSolver::PetscSolver(FlowField & flowField, Parameters & parameters):
 
     KSPSetFromOptions(_ksp);
     KSPSetInitialGuessNonzero(_ksp,PETSC_TRUE);
+    KSPMonitorSet(_ksp, recordResidual, &_lastSolve, PETSC_NULL);
     KSPSetUp(_ksp);
 
     //from here we can change sub_ksp if necessary
@@ -303,9 +351,11 @@ void PetscSolver::solve(){
     ScalarField & pressure = _flowField.getPressure();
 
     if (_parameters.geometry.dim == 2){
-        KSPSetComputeRHS(_ksp, computeRHS2D, &_ctx);
-    	KSPSetComputeOperators(_ksp,computeMatrix2D, &_ctx);
+        setUpSolve(_ksp, computeRHS2D, computeMatrix2D, _ctx, _lastSolve);
+        const double start = MPI_Wtime();
         KSPSolve(_ksp, PETSC_NULL, _x);
+        finishRecord(_ksp, start, _lastSolve);
+        countIterations(_ksp, _solves, _iterations);
 
         // Then extract the information
         PetscScalar **array;
@@ -318,9 +368,11 @@ void PetscSolver::solve(){
         }
         DMDAVecRestoreArray(_da, _x, &array);
     } else if (_parameters.geometry.dim == 3){
-        KSPSetComputeRHS(_ksp, computeRHS3D, &_ctx);
-    	KSPSetComputeOperators(_ksp,computeMatrix3D, &_ctx);
+        setUpSolve(_ksp, computeRHS3D, computeMatrix3D, _ctx, _lastSolve);
+        const double start = MPI_Wtime();
         KSPSolve(_ksp, PETSC_NULL, _x);
+        finishRecord(_ksp, start, _lastSolve);
+        countIterations(_ksp, _solves, _iterations);
 
         // Then extract the information
         PetscScalar ***array;
@@ -364,6 +416,11 @@ PetscErrorCode computeMatrix2D(KSP ksp, Mat A, Mat pc, MatStructure * matStructu
     int rank;
     MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
     std::cout << "Limits= " << limitsX[0] << ", " << limitsX[1] << "; " << limitsY[0] << " , " << limitsY[1] << "(rank " << rank << ")"<< std::endl;
+    // with the solid interior trimmed, its rows only hold the diagonal, so that the couplings
+    // of earlier assemblies must be removed
+    if (parameters.geometry.trimSolid){
+        MatZeroEntries(A);
+    }
     // Loop for inner nodes
     for (j = limitsY[0]; j < limitsY[1]; j++){
         for (i = limitsX[0]; i < limitsX[1]; i++){
@@ -395,6 +452,15 @@ PetscErrorCode computeMatrix2D(KSP ksp, Mat A, Mat pc, MatStructure * matStructu
                 stencilValues[4] =  2.0/(dx_Bo*(dx_T+dx_Bo)); // bottom
                 stencilValues[2] = -2.0/(dx_R*dx_L)-2.0/(dx_T*dx_Bo); // center
 
+                if (context->weights != NULL) {
+                    VectorField & weights = *context->weights;
+                    stencilValues[1] *= weights.getVector(cellIndexX-1, cellIndexY  )[0];
+                    stencilValues[0] *= weights.getVector(cellIndexX  , cellIndexY  )[0];
+                    stencilValues[3] *= weights.getVector(cellIndexX  , cellIndexY  )[1];
+                    stencilValues[4] *= weights.getVector(cellIndexX  , cellIndexY-1)[1];
+                    stencilValues[2] = -(stencilValues[0]+stencilValues[1]+stencilValues[3]+stencilValues[4]);
+                }
+
                 // Definition of positions. Order must correspond to values
                 column[0].i = i+1; column[0].j = j;
                 column[1].i = i-1; column[1].j = j;
@@ -465,6 +531,12 @@ PetscErrorCode computeMatrix2D(KSP ksp, Mat A, Mat pc, MatStructure * matStructu
             } else {    // The remaining possibility is that the cell is obstacle surrounded
                         // by more obstacle cells
                 // Here, we just add an equation to set the value according to the right hand side
+                if (parameters.geometry.trimSolid){
+                    stencilValues[0] = 1.0;
+                    column[0].i = i; column[0].j = j;
+                    MatSetValuesStencil(A, 1, &row, 1, column, stencilValues, INSERT_VALUES);
+                    continue;
+                }
                 stencilValues[1] =  0.0; // left
                 stencilValues[0] =  0.0; // right
                 stencilValues[3] =  0.0;  // top
@@ -588,6 +660,9 @@ PetscErrorCode computeMatrix3D(KSP ksp, Mat A, Mat pc, MatStructure * matStructu
 
     // Loop for inner nodes
     // std::cout << "Limits: " << limitsX[0] << ", " << limitsX[1] << ", " << limitsY[0] << ", " << limitsY[1] << ", " << limitsZ[0] << ", " << limitsZ[1] << std::endl;
+    if (parameters.geometry.trimSolid){
+        MatZeroEntries(A);
+    }
     for (k = limitsZ[0]; k < limitsZ[1]; k++){
         for (j = limitsY[0]; j < limitsY[1]; j++){
             for (i = limitsX[0]; i < limitsX[1]; i++){
@@ -625,6 +700,18 @@ PetscErrorCode computeMatrix3D(KSP ksp, Mat A, Mat pc, MatStructure * matStructu
                     stencilValues[5] =  2.0/(dx_F *(dx_B+dx_F)); // front
                     stencilValues[6] = -2.0/(dx_R*dx_L)-2.0/(dx_T*dx_Bo)-2.0/(dx_F*dx_B); // center
 
+                    if (context->weights != NULL) {
+                        VectorField & weights = *context->weights;
+                        stencilValues[1] *= weights.getVector(cellIndexX-1, cellIndexY  , cellIndexZ  )[0];
+                        stencilValues[0] *= weights.getVector(cellIndexX  , cellIndexY  , cellIndexZ  )[0];
+                        stencilValues[2] *= weights.getVector(cellIndexX  , cellIndexY  , cellIndexZ  )[1];
+                        stencilValues[3] *= weights.getVector(cellIndexX  , cellIndexY-1, cellIndexZ  )[1];
+                        stencilValues[4] *= weights.getVector(cellIndexX  , cellIndexY  , cellIndexZ  )[2];
+                        stencilValues[5] *= weights.getVector(cellIndexX  , cellIndexY  , cellIndexZ-1)[2];
+                        stencilValues[6] = -(stencilValues[0]+stencilValues[1]+stencilValues[2]+
+                                             stencilValues[3]+stencilValues[4]+stencilValues[5]);
+                    }
+
                     // Definition of positions. Order must correspond to values
                     column[0].i = i+1; column[0].j = j;   column[0].k = k;
                     column[1].i = i-1; column[1].j = j;   column[1].k = k;
@@ -713,12 +800,18 @@ PetscErrorCode computeMatrix3D(KSP ksp, Mat A, Mat pc, MatStructure * matStructu
             } else {    // The remaining possibility is that the cell is obstacle surrounded
                         // by more obstacle cells
                 // Here, we just add an equation to set the value according to the right hand side
+                if (parameters.geometry.trimSolid){
+                    stencilValues[0] = 1.0;
+                    column[0].i = i; column[0].j = j; column[0].k = k;
+                    MatSetValuesStencil(A, 1, &row, 1, column, stencilValues, INSERT_VALUES);
+                    continue;
+                }
                 stencilValues[1] =  0.0; // left
                 stencilValues[0] =  0.0; // right
                 stencilValues[3] =  0.0;  // top
                 stencilValues[4] =  0.0;  // bottom
                 stencilValues[5] =  0.0;  // front
-                stencilValues[5] =  0.0;  // back
+                stencilValues[6] =  0.0;  // back
                 stencilValues[2] = 1.0; // center
 
                 // Definition of positions. Order must correspond to values
@@ -1079,3 +1172,80 @@ void PetscSolver::reInitMatrix() {
     else
     	KSPSetComputeOperators(_ksp,computeMatrix3D, &_ctx);
 }
+
+void PetscSolver::setFaceWeights(VectorField * weights) {
+    _ctx.weights = weights;
+}
+
+void PetscSolver::getLocalBlock(int first[3], int length[3]) const {
+    first[0] = _firstX; length[0] = _lengthX;
+    first[1] = _firstY; length[1] = _lengthY;
+    if (_parameters.geometry.dim == 3){
+        first[2] = _firstZ; length[2] = _lengthZ;
+    } else {
+        first[2] = 0; length[2] = 1;
+    }
+}
+
+void PetscSolver::getSolution(FLOAT * buffer){
+    int counter = 0;
+    if (_parameters.geometry.dim == 2){
+        PetscScalar **array;
+        DMDAVecGetArray(_da, _x, &array);
+        for (int j = _firstY; j < _firstY + _lengthY; j++){
+            for (int i = _firstX; i < _firstX + _lengthX; i++){
+                buffer[counter++] = array[j][i];
+            }
+        }
+        DMDAVecRestoreArray(_da, _x, &array);
+    } else {
+        PetscScalar ***array;
+        DMDAVecGetArray(_da, _x, &array);
+        for (int k = _firstZ; k < _firstZ + _lengthZ; k++){
+            for (int j = _firstY; j < _firstY + _lengthY; j++){
+                for (int i = _firstX; i < _firstX + _lengthX; i++){
+                    buffer[counter++] = array[k][j][i];
+                }
+            }
+        }
+        DMDAVecRestoreArray(_da, _x, &array);
+    }
+}
+
+void PetscSolver::setSolution(const FLOAT * buffer){
+    int counter = 0;
+    if (_parameters.geometry.dim == 2){
+        PetscScalar **array;
+        DMDAVecGetArray(_da, _x, &array);
+        for (int j = _firstY; j < _firstY + _lengthY; j++){
+            for (int i = _firstX; i < _firstX + _lengthX; i++){
+                array[j][i] = buffer[counter++];
+            }
+        }
+        DMDAVecRestoreArray(_da, _x, &array);
+    } else {
+        PetscScalar ***array;
+        DMDAVecGetArray(_da, _x, &array);
+        for (int k = _firstZ; k < _firstZ + _lengthZ; k++){
+            for (int j = _firstY; j < _firstY + _lengthY; j++){
+                for (int i = _firstX; i < _firstX + _lengthX; i++){
+                    array[k][j][i] = buffer[counter++];
+                }
+            }
+        }
+        DMDAVecRestoreArray(_da, _x, &array);
+    }
+}
+
+int PetscSolver::getSolves() const {
+    return _solves;
+}
+
+int PetscSolver::getIterations() const {
+    return _iterations;
+}
+
+void PetscSolver::setStatistics(int solves, int iterations){
+    _solves = solves;
+    _iterations = iterations;
+}
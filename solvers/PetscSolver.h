@@ -53,6 +53,7 @@ class PetscUserCtx{
 
         unsigned char setAsBoundary;    // if set as boundary in the linear system. Use bits
         int displacement[6];            // Displacements for the boundary treatment
+        VectorField * weights;          // Factors of the coefficients of the faces, NULL for none
 
 };
 
@@ -75,6 +76,9 @@ class PetscSolver : public LinearSolver{
         // Additional variables used to determine where to write back the results
         int _offsetX, _offsetY, _offsetZ;
 
+        int _solves;      //! Number of linear systems solved so far
+        int _iterations;  //! Accumulated number of Krylov iterations over all solves
+
     public:
 
         /** Constructor */
@@ -89,6 +93,38 @@ class PetscSolver : public LinearSolver{
 	/** Reinit the matrix so that it uses the right flag field */
 	void reInitMatrix();
 
+        /** Scales the coefficient of each face of the Laplacian, div(w grad p), e.g. by the local
+         *  time steps of the steady-state mode. The factor of a face is the one of the velocity
+         *  component on it; NULL gives the plain Laplacian. The matrix is assembled anew for
+         *  every solve, so the weights may change between solves.
+         */
+        void setFaceWeights(VectorField * weights);
+
+        /** Returns the corners of the local part of the solution vector in the global grid of
+         *  the solver, which has one boundary layer more than the flow field in each direction.
+         *  In 2D, the z component is set to 0 and 1.
+         * @param first Index of the first local node per dimension
+         * @param length Number of local nodes per dimension
+         */
+        void getLocalBlock(int first[3], int length[3]) const;
+
+        /** Copies the local part of the solution vector, which is the initial guess of the next
+         *  solve, to the buffer. The x index runs fastest.
+         */
+        void getSolution(FLOAT * buffer);
+
+        /** Overwrites the local part of the solution vector, e.g. from a checkpoint
+         * @param buffer Local block of the solution, same layout as in getSolution
+         */
+        void setSolution(const FLOAT * buffer);
+
+        /** Solver statistics accumulated since the beginning of the simulation */
+        int getSolves() const;
+        int getIterations() const;
+
+        /** Restores the solver statistics, e.g. when restarting from a checkpoint */
+        void setStatistics(int solves, int iterations);
+
 };
 
 #endif
@@ -15,6 +15,10 @@ void SORSolver::solve() {
 
     int nx = _flowField.getNx(), ny = _flowField.getNy(), nz = _flowField.getNz();
     ScalarField & P = _flowField.getPressure();
+
+    // There is no setup; the initial residual is the one after the first sweep
+    const double start = MPI_Wtime();
+    _lastSolve.setupTime = 0.0;
     if (_parameters.geometry.dim == 3){
         do {
             for (int k = 2; k < nz + 2; k++){
@@ -116,6 +120,9 @@ void SORSolver::solve() {
                 }
             }
             resnorm = sqrt (resnorm / (nx * ny * nz));
+            if (it == 0) {
+                _lastSolve.initialResidual = resnorm;
+            }
             //std::cout << "Residual norm: " << resnorm << std::endl;
 
             it++;
@@ -180,6 +187,9 @@ void SORSolver::solve() {
                 }
             }
             resnorm = sqrt (resnorm / (nx * ny));
+            if (it == 0) {
+                _lastSolve.initialResidual = resnorm;
+            }
 
             for ( int j = 2; j < ny + 2; j++ ) {
                 P.getScalar(1,j) = P.getScalar(2,j);
@@ -196,4 +206,9 @@ void SORSolver::solve() {
             it++;
         } while ( resnorm > tol && iterations);
     }
+
+    _lastSolve.solveTime = MPI_Wtime() - start;
+    _lastSolve.iterations = it;
+    _lastSolve.finalResidual = resnorm;
+    _lastSolve.converged = resnorm <= tol ? 1 : -1;
 }
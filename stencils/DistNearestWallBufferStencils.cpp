@@ -0,0 +1,51 @@
+#include "DistNearestWallBufferStencils.h"
+
+DistNearestWallBufferFillStencil::DistNearestWallBufferFillStencil(const Parameters & parameters,
+        FLOAT * distLeft, FLOAT * distRight,
+        FLOAT * distBottom, FLOAT * distTop,
+        int lowOffset) :
+    ScalarBufferFillStencil<TurbulentFlowField>(parameters,distLeft,distRight,distBottom,distTop,lowOffset)
+    {}
+DistNearestWallBufferFillStencil::DistNearestWallBufferFillStencil(const Parameters & parameters,
+        FLOAT * distLeft, FLOAT * distRight,
+        FLOAT * distBottom, FLOAT * distTop,
+        FLOAT * distFront, FLOAT * distBack,
+        int lowOffset) :
+    ScalarBufferFillStencil<TurbulentFlowField>(parameters,distLeft,distRight,distBottom,distTop,distFront,distBack,lowOffset)
+    {}
+
+// 2D problem
+FLOAT & DistNearestWallBufferFillStencil::getScalar( TurbulentFlowField & turbFlowField, int i, int j ){
+    return turbFlowField.getDistNearestWall().getScalar(i,j);
+}
+
+// 3D problem
+FLOAT & DistNearestWallBufferFillStencil::getScalar( TurbulentFlowField & turbFlowField, int i, int j, int k ){
+    return turbFlowField.getDistNearestWall().getScalar(i,j,k);
+}
+
+
+
+DistNearestWallBufferReadStencil::DistNearestWallBufferReadStencil(const Parameters & parameters,
+        FLOAT * distLeft, FLOAT * distRight,
+        FLOAT * distBottom, FLOAT * distTop,
+        int lowOffset) :
+    ScalarBufferReadStencil<TurbulentFlowField>(parameters,distLeft,distRight,distBottom,distTop,lowOffset)
+    {}
+DistNearestWallBufferReadStencil::DistNearestWallBufferReadStencil(const Parameters & parameters,
+        FLOAT * distLeft, FLOAT * distRight,
+        FLOAT * distBottom, FLOAT * distTop,
+        FLOAT * distFront, FLOAT * distBack,
+        int lowOffset) :
+    ScalarBufferReadStencil<TurbulentFlowField>(parameters,distLeft,distRight,distBottom,distTop,distFront,distBack,lowOffset)
+    {}
+
+// 2D problem
+FLOAT & DistNearestWallBufferReadStencil::getScalar( TurbulentFlowField & turbFlowField, int i, int j ){
+    return turbFlowField.getDistNearestWall().getScalar(i,j);
+}
+
+// 3D problem
+FLOAT & DistNearestWallBufferReadStencil::getScalar( TurbulentFlowField & turbFlowField, int i, int j, int k ){
+    return turbFlowField.getDistNearestWall().getScalar(i,j,k);
+}
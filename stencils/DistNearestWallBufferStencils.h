@@ -0,0 +1,63 @@
+#ifndef _DIST_NEAREST_WALL_BUFFER_STENCILS_H_
+#define _DIST_NEAREST_WALL_BUFFER_STENCILS_H_
+
+#include "../Definitions.h"
+#include "../Parameters.h"
+#include "../Stencil.h"
+#include "../TurbulentFlowField.h"
+#include "ScalarBufferFillStencil.h"
+#include "ScalarBufferReadStencil.h"
+
+/**
+ *
+ * Fills an array with the distances to the nearest wall at the boundary.
+ */
+class DistNearestWallBufferFillStencil : public ScalarBufferFillStencil<TurbulentFlowField> {
+
+public:
+    /** Constructor for 2D case, see TurbViscosityBufferFillStencil */
+    DistNearestWallBufferFillStencil(const Parameters & parameters,
+        FLOAT * distLeft, FLOAT * distRight,
+        FLOAT * distBottom, FLOAT * distTop,
+        int lowOffset = 0);
+
+    /** Constructor for 3D case, see TurbViscosityBufferFillStencil */
+    DistNearestWallBufferFillStencil(const Parameters & parameters,
+        FLOAT * distLeft, FLOAT * distRight,
+        FLOAT * distBottom, FLOAT * distTop,
+        FLOAT * distFront, FLOAT * distBack,
+        int lowOffset = 0);
+
+protected:
+    FLOAT & getScalar( TurbulentFlowField & turbFlowField, int i, int j );
+    FLOAT & getScalar( TurbulentFlowField & turbFlowField, int i, int j, int k );
+
+};
+
+/**
+ *
+ * Reads the distances to the nearest wall at the boundary from an array.
+ */
+class DistNearestWallBufferReadStencil : public ScalarBufferReadStencil<TurbulentFlowField> {
+
+public:
+    /** Constructor for 2D case, see TurbViscosityBufferReadStencil */
+    DistNearestWallBufferReadStencil(const Parameters & parameters,
+        FLOAT * distLeft, FLOAT * distRight,
+        FLOAT * distBottom, FLOAT * distTop,
+        int lowOffset = 0);
+
+    /** Constructor for 3D case, see TurbViscosityBufferReadStencil */
+    DistNearestWallBufferReadStencil(const Parameters & parameters,
+        FLOAT * distLeft, FLOAT * distRight,
+        FLOAT * distBottom, FLOAT * distTop,
+        FLOAT * distFront, FLOAT * distBack,
+        int lowOffset = 0);
+
+protected:
+    FLOAT & getScalar( TurbulentFlowField & turbFlowField, int i, int j );
+    FLOAT & getScalar( TurbulentFlowField & turbFlowField, int i, int j, int k );
+
+};
+
+#endif
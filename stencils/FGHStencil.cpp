@@ -46,3 +46,17 @@ void FGHStencil::apply ( FlowField & flowField, int i, int j, int k ){
         }
     }
 }
+
+
+void FGHStencil::applyFluidRun ( FlowField & flowField, int begin, int end, int j, int k ){
+    // No obstacle around, so that all three components are computed
+    for (int i = begin; i < end; i++){
+        loadLocalVelocity3D(  flowField, _localVelocity, i, j, k);
+        loadLocalMeshsize3D(_parameters, _localMeshsize, i, j, k);
+
+        FLOAT * const values = flowField.getFGH().getVector(i,j,k);
+        values [0] = computeF3D(_localVelocity, _localMeshsize, _parameters, _parameters.timestep.dt);
+        values [1] = computeG3D(_localVelocity, _localMeshsize, _parameters, _parameters.timestep.dt);
+        values [2] = computeH3D(_localVelocity, _localMeshsize, _parameters, _parameters.timestep.dt);
+    }
+}
@@ -38,6 +38,19 @@ class FGHStencil : public FieldStencil<FlowField>
          * @param k Index in the z direction
          */
         void apply ( FlowField & flowField, int i, int j, int k );
+
+        // in 2D, the runs are left to the default, which applies the stencil to each cell
+        using FieldStencil<FlowField>::applyFluidRun;
+
+        /** Apply the stencil in 3D to a run of fluid cells without obstacle neighbours
+         *
+         * @param flowField State of the flow field
+         * @param begin First position of the run in the X direction
+         * @param end Position after the run in the X direction
+         * @param j Position in the Y direction
+         * @param k Position in the Z direction
+         */
+        void applyFluidRun ( FlowField & flowField, int begin, int end, int j, int k );
 };
 
 
@@ -48,3 +48,31 @@ void FGHTurbStencil::apply ( TurbulentFlowField & turbulentFlowField, int i, int
         }
     }
 }
+
+
+void FGHTurbStencil::applyFluidRun ( TurbulentFlowField & turbulentFlowField, int begin, int end, int j ){
+    for (int i = begin; i < end; i++){
+        loadLocalVelocity2D(  turbulentFlowField, _localVelocity, i, j);
+        loadLocalMeshsize2D(_parameters, _localMeshsize, i, j);
+        loadLocalTurbViscosity2D(turbulentFlowField, _localTurbViscosity,i,j);
+
+        FLOAT* const values = turbulentFlowField.getFGH().getVector(i,j);
+        values [0] = computeTurbF2D(_localVelocity, _localTurbViscosity, _localMeshsize, _parameters, _parameters.timestep.dt);
+        values [1] = computeTurbG2D(_localVelocity, _localTurbViscosity, _localMeshsize, _parameters, _parameters.timestep.dt);
+    }
+}
+
+
+void FGHTurbStencil::applyFluidRun ( TurbulentFlowField & turbulentFlowField, int begin, int end, int j, int k ){
+    // No obstacle around, so that all three components are computed
+    for (int i = begin; i < end; i++){
+        loadLocalVelocity3D(  turbulentFlowField, _localVelocity, i, j, k);
+        loadLocalMeshsize3D(_parameters, _localMeshsize, i, j, k);
+        loadLocalTurbViscosity3D( turbulentFlowField, _localTurbViscosity,i,j,k);
+
+        FLOAT * const values = turbulentFlowField.getFGH().getVector(i,j,k);
+        values [0] = computeTurbF3D(_localVelocity, _localTurbViscosity, _localMeshsize, _parameters, _parameters.timestep.dt);
+        values [1] = computeTurbG3D(_localVelocity, _localTurbViscosity, _localMeshsize, _parameters, _parameters.timestep.dt);
+        values [2] = computeTurbH3D(_localVelocity, _localTurbViscosity, _localMeshsize, _parameters, _parameters.timestep.dt);
+    }
+}
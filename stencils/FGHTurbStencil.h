@@ -40,6 +40,17 @@ class FGHTurbStencil : public FieldStencil<TurbulentFlowField>
          * @param k Index in the z direction
          */
         void apply ( TurbulentFlowField & turbulentFlowField, int i, int j, int k );
+
+        /** Apply the stencil to a run of fluid cells without obstacle neighbours, in 2D and 3D
+         *
+         * @param turbulentFlowField State of the turbulent flow field
+         * @param begin First position of the run in the X direction
+         * @param end Position after the run in the X direction
+         * @param j Position in the Y direction
+         * @param k Position in the Z direction
+         */
+        void applyFluidRun ( TurbulentFlowField & turbulentFlowField, int begin, int end, int j );
+        void applyFluidRun ( TurbulentFlowField & turbulentFlowField, int begin, int end, int j, int k );
 };
 
 
@@ -0,0 +1,51 @@
+#include "NuTildeBufferStencils.h"
+
+NuTildeBufferFillStencil::NuTildeBufferFillStencil(const Parameters & parameters,
+        FLOAT * nuTildeLeft, FLOAT * nuTildeRight,
+        FLOAT * nuTildeBottom, FLOAT * nuTildeTop,
+        int lowOffset) :
+    ScalarBufferFillStencil<TurbulentFlowField>(parameters,nuTildeLeft,nuTildeRight,nuTildeBottom,nuTildeTop,lowOffset)
+    {}
+NuTildeBufferFillStencil::NuTildeBufferFillStencil(const Parameters & parameters,
+        FLOAT * nuTildeLeft, FLOAT * nuTildeRight,
+        FLOAT * nuTildeBottom, FLOAT * nuTildeTop,
+        FLOAT * nuTildeFront, FLOAT * nuTildeBack,
+        int lowOffset) :
+    ScalarBufferFillStencil<TurbulentFlowField>(parameters,nuTildeLeft,nuTildeRight,nuTildeBottom,nuTildeTop,nuTildeFront,nuTildeBack,lowOffset)
+    {}
+
+// 2D problem
+FLOAT & NuTildeBufferFillStencil::getScalar( TurbulentFlowField & turbFlowField, int i, int j ){
+    return turbFlowField.getNuTilde().getScalar(i,j);
+}
+
+// 3D problem
+FLOAT & NuTildeBufferFillStencil::getScalar( TurbulentFlowField & turbFlowField, int i, int j, int k ){
+    return turbFlowField.getNuTilde().getScalar(i,j,k);
+}
+
+
+
+NuTildeBufferReadStencil::NuTildeBufferReadStencil(const Parameters & parameters,
+        FLOAT * nuTildeLeft, FLOAT * nuTildeRight,
+        FLOAT * nuTildeBottom, FLOAT * nuTildeTop,
+        int lowOffset) :
+    ScalarBufferReadStencil<TurbulentFlowField>(parameters,nuTildeLeft,nuTildeRight,nuTildeBottom,nuTildeTop,lowOffset)
+    {}
+NuTildeBufferReadStencil::NuTildeBufferReadStencil(const Parameters & parameters,
+        FLOAT * nuTildeLeft, FLOAT * nuTildeRight,
+        FLOAT * nuTildeBottom, FLOAT * nuTildeTop,
+        FLOAT * nuTildeFront, FLOAT * nuTildeBack,
+        int lowOffset) :
+    ScalarBufferReadStencil<TurbulentFlowField>(parameters,nuTildeLeft,nuTildeRight,nuTildeBottom,nuTildeTop,nuTildeFront,nuTildeBack,lowOffset)
+    {}
+
+// 2D problem
+FLOAT & NuTildeBufferReadStencil::getScalar( TurbulentFlowField & turbFlowField, int i, int j ){
+    return turbFlowField.getNuTilde().getScalar(i,j);
+}
+
+// 3D problem
+FLOAT & NuTildeBufferReadStencil::getScalar( TurbulentFlowField & turbFlowField, int i, int j, int k ){
+    return turbFlowField.getNuTilde().getScalar(i,j,k);
+}
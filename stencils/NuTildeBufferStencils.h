@@ -0,0 +1,63 @@
+#ifndef _NU_TILDE_BUFFER_STENCILS_H_
+#define _NU_TILDE_BUFFER_STENCILS_H_
+
+#include "../Definitions.h"
+#include "../Parameters.h"
+#include "../Stencil.h"
+#include "../TurbulentFlowField.h"
+#include "ScalarBufferFillStencil.h"
+#include "ScalarBufferReadStencil.h"
+
+/**
+ *
+ * Fills an array with the working variable of the Spalart-Allmaras model at the boundary.
+ */
+class NuTildeBufferFillStencil : public ScalarBufferFillStencil<TurbulentFlowField> {
+
+public:
+    /** Constructor for 2D case, see TurbViscosityBufferFillStencil */
+    NuTildeBufferFillStencil(const Parameters & parameters,
+        FLOAT * nuTildeLeft, FLOAT * nuTildeRight,
+        FLOAT * nuTildeBottom, FLOAT * nuTildeTop,
+        int lowOffset = 0);
+
+    /** Constructor for 3D case, see TurbViscosityBufferFillStencil */
+    NuTildeBufferFillStencil(const Parameters & parameters,
+        FLOAT * nuTildeLeft, FLOAT * nuTildeRight,
+        FLOAT * nuTildeBottom, FLOAT * nuTildeTop,
+        FLOAT * nuTildeFront, FLOAT * nuTildeBack,
+        int lowOffset = 0);
+
+protected:
+    FLOAT & getScalar( TurbulentFlowField & turbFlowField, int i, int j );
+    FLOAT & getScalar( TurbulentFlowField & turbFlowField, int i, int j, int k );
+
+};
+
+/**
+ *
+ * Reads the working variable of the Spalart-Allmaras model at the boundary from an array.
+ */
+class NuTildeBufferReadStencil : public ScalarBufferReadStencil<TurbulentFlowField> {
+
+public:
+    /** Constructor for 2D case, see TurbViscosityBufferReadStencil */
+    NuTildeBufferReadStencil(const Parameters & parameters,
+        FLOAT * nuTildeLeft, FLOAT * nuTildeRight,
+        FLOAT * nuTildeBottom, FLOAT * nuTildeTop,
+        int lowOffset = 0);
+
+    /** Constructor for 3D case, see TurbViscosityBufferReadStencil */
+    NuTildeBufferReadStencil(const Parameters & parameters,
+        FLOAT * nuTildeLeft, FLOAT * nuTildeRight,
+        FLOAT * nuTildeBottom, FLOAT * nuTildeTop,
+        FLOAT * nuTildeFront, FLOAT * nuTildeBack,
+        int lowOffset = 0);
+
+protected:
+    FLOAT & getScalar( TurbulentFlowField & turbFlowField, int i, int j );
+    FLOAT & getScalar( TurbulentFlowField & turbFlowField, int i, int j, int k );
+
+};
+
+#endif
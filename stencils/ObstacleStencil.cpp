@@ -54,7 +54,7 @@ void ObstacleStencil::apply ( FlowField & flowField, int i, int j){
 }
 
 void ObstacleStencil::apply ( FlowField & flowField, int i, int j, int k){
-	const int obstacle = flowField.getFlags().getValue(i, j);
+	const int obstacle = flowField.getFlags().getValue(i, j, k);
 	VectorField & velocity = flowField.getVelocity();    
 
 	/* check if current cell is obstacle cell */
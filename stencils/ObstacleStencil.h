@@ -31,6 +31,11 @@ class ObstacleStencil : public FieldStencil<FlowField> {
 		 */
 		void apply ( FlowField & flowField, int i, int j, int k );
 
+		/** Fluid cells without obstacle neighbours are left as they are
+		 */
+		void applyFluidRun ( FlowField & flowField, int begin, int end, int j ) {}
+		void applyFluidRun ( FlowField & flowField, int begin, int end, int j, int k ) {}
+
 
 };
 
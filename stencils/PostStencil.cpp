@@ -2,74 +2,60 @@
 #include "../Iterators.h"
 #include <string>
 #include <ostream>
-#include <sstream>
 
 
 BasicPostStencil::BasicPostStencil ( const Parameters & parameters )
-  : PostStencil<FlowField>(parameters) {}
+  : PostStencil<FlowField>(parameters),
+    _pressure(getNumberOfCells(), 0.0f),
+    _velocity(3 * getNumberOfCells(), 0.0f) {}
 
 void BasicPostStencil::apply ( FlowField & flowField, int i, int j ) {
     FLOAT pressure = 0.0;
-    FLOAT* velocity = new FLOAT(2);
+    FLOAT velocity[2] = {0.0, 0.0};
     const int obstacle = flowField.getFlags().getValue(i, j);
 
     // check whether current cell is a fluid cell or not
     if ((obstacle & OBSTACLE_SELF) == 0) {
       flowField.getPressureAndVelocity(pressure, velocity,  i, j);
-    } else {
-      velocity[0] = 0.0;
-      velocity[1] = 0.0;
     }
 
-    _ssPressure << pressure << std::endl;
-    _ssVelocity << velocity[0] << " " << velocity[1] << " 0" << std::endl;
-    // _ssFlags << obstacle << std::endl;
+    const int cell = getCellIndex(i, j);
+    _pressure[cell] = pressure;
+    _velocity[3*cell]   = velocity[0];
+    _velocity[3*cell+1] = velocity[1];
 }
 
 void BasicPostStencil::apply ( FlowField & flowField, int i, int j, int k ) {
     FLOAT pressure = 0.0;
-    FLOAT* velocity = new FLOAT(3);
+    FLOAT velocity[3] = {0.0, 0.0, 0.0};
     const int obstacle = flowField.getFlags().getValue(i, j, k);
 
     // check whether current cell is a fluid cell or not
     if ((obstacle & OBSTACLE_SELF) == 0) {
       flowField.getPressureAndVelocity(pressure, velocity,  i, j, k);
-    } else {
-      velocity[0] = 0.0;
-      velocity[1] = 0.0;
-      velocity[2] = 0.0;
     }
 
-    _ssPressure << pressure << std::endl;
-    _ssVelocity << velocity[0] << " " << velocity[1] << " " << velocity[2] << std::endl;
-    // _ssFlags << obstacle << std::endl;
+    const int cell = getCellIndex(i, j, k);
+    _pressure[cell] = pressure;
+    _velocity[3*cell]   = velocity[0];
+    _velocity[3*cell+1] = velocity[1];
+    _velocity[3*cell+2] = velocity[2];
 }
 
 void BasicPostStencil::writeVtk ( std::ostream & stream ) {
-    // write pressure data
-    stream << "\nSCALARS pressure float 1" << std::endl;
-    stream << "LOOKUP_TABLE default" << std::endl;
-    stream << _ssPressure.str();
-
-    // write velocity data
-    stream << "\nVECTORS velocity float" << std::endl;
-    stream << _ssVelocity.str();
-
-    // // write flags data
-    // stream << "\nSCALARS flags integer 1" << std::endl;
-    // stream << "LOOKUP_TABLE default" << std::endl;
-    // stream << _ssFlags.str();
-
-    // clear the stringstreams
-    _ssPressure.str("");
-    _ssVelocity.str("");
-    // _ssFlags.str("");
+    writeScalars(stream, "pressure", _pressure);
+    writeVectors(stream, "velocity", _velocity);
+}
+
+size_t BasicPostStencil::getOutputBytes () const {
+    return (_pressure.size() + _velocity.size()) * sizeof(float);
 }
 
 
 
 WallPostStencil::WallPostStencil ( const Parameters & parameters )
   : PostStencil<FlowField>(parameters),
+    _tauw(parameters.geometry.dim == 3 ? 3 * getNumberOfCells() : 0, 0.0f),
     _sizeX(parameters.geometry.lengthX),
     _sizeY(parameters.geometry.lengthY),
     _sizeZ(parameters.geometry.lengthZ),
@@ -141,19 +127,21 @@ void WallPostStencil::apply ( FlowField & flowField, int i, int j, int k ) {
         tauw[1] = velocity[1] / (0.5 * ms->getDx(i,j,k));
         tauw[2] = velocity[2] / (0.5 * ms->getDx(i,j,k));
       }
-    } else {
     }
 
-    _ssTauw << tauw[0] << " " << tauw[1] << " " << tauw[2] << std::endl;
+    const int cell = getCellIndex(i, j, k);
+    _tauw[3*cell]   = tauw[0];
+    _tauw[3*cell+1] = tauw[1];
+    _tauw[3*cell+2] = tauw[2];
 }
 
 void WallPostStencil::writeVtk ( std::ostream & stream ) {
     if (_parameters.geometry.dim == 2) return; // no 2D implementation yet TODO
 
     // write wall shear stress
-    stream << "\nVECTORS wallShearStress float" << std::endl;
-    stream << _ssTauw.str();
+    writeVectors(stream, "wallShearStress", _tauw);
+}
 
-    // clear the stringstreams
-    _ssTauw.str("");
+size_t WallPostStencil::getOutputBytes () const {
+    return _tauw.size() * sizeof(float);
 }
@@ -7,15 +7,62 @@
 #include "../FlowField.h"
 #include <string>
 #include <ostream>
-#include <sstream>
+#include <vector>
+#include <stdio.h>
 
 /** WS1: Stencil for writting VTK files
  *
- * When iterated with, creates a VTK file.
+ * When iterated with, creates a VTK file. The stencils store their results in float arrays over
+ * the local cells, which are allocated once at construction and encoded by writeVtk. Hence,
+ * writing a snapshot does not allocate memory per cell.
  */
 template<class FlowField>
 class PostStencil : public FieldStencil<FlowField> {
-    private:
+    protected:
+
+        const int _nx, _ny, _nz;    //! Number of local cells per dimension (_nz = 1 in 2D)
+
+        /** Position of a cell in the output arrays. The cells are ordered as in the VTK file,
+         *  x fastest
+         */
+        int getCellIndex ( int i, int j ) const { return (i-2) + _nx*(j-2); }
+        int getCellIndex ( int i, int j, int k ) const { return (i-2) + _nx*((j-2) + _ny*(k-2)); }
+
+        int getNumberOfCells () const { return _nx*_ny*_nz; }
+
+        /** Encodes an output array with the given number of components per cell as ASCII text,
+         *  one cell per line. A fixed buffer on the stack collects the lines.
+         */
+        void writeValues ( std::ostream & stream, const std::vector<float> & values, int components ) const {
+            char buffer[8192];
+            const int maxLine = 16 * components + 1;   // %g uses at most 15 characters
+            int length = 0;
+            for (unsigned int cell = 0; cell < values.size(); cell += components) {
+                if (length + maxLine > (int) sizeof(buffer)) {
+                    stream.write(buffer, length);
+                    length = 0;
+                }
+                for (int c = 0; c < components; c++) {
+                    length += snprintf(buffer + length, sizeof(buffer) - length, c == 0 ? "%g" : " %g",
+                                       values[cell + c]);
+                }
+                buffer[length++] = '\n';
+            }
+            stream.write(buffer, length);
+        }
+
+        /** Writes a scalar output array */
+        void writeScalars ( std::ostream & stream, const char * name, const std::vector<float> & values ) const {
+            stream << "\nSCALARS " << name << " float 1" << std::endl;
+            stream << "LOOKUP_TABLE default" << std::endl;
+            writeValues(stream, values, 1);
+        }
+
+        /** Writes a vector output array, always with three components per cell */
+        void writeVectors ( std::ostream & stream, const char * name, const std::vector<float> & values ) const {
+            stream << "\nVECTORS " << name << " float" << std::endl;
+            writeValues(stream, values, 3);
+        }
 
     public:
 
@@ -24,7 +71,10 @@ class PostStencil : public FieldStencil<FlowField> {
          * @param parameters Parameters of the problem
          */
         PostStencil ( const Parameters & parameters )
-          : FieldStencil<FlowField>(parameters) {}
+          : FieldStencil<FlowField>(parameters),
+            _nx(parameters.parallel.localSize[0]),
+            _ny(parameters.parallel.localSize[1]),
+            _nz(parameters.geometry.dim == 3 ? parameters.parallel.localSize[2] : 1) {}
 
         /** Operations to perform before the apply methods
          *
@@ -37,14 +87,15 @@ class PostStencil : public FieldStencil<FlowField> {
          */
         virtual void writeVtk ( std::ostream & stream ) = 0;
 
+        /** Size of the output arrays in bytes */
+        virtual size_t getOutputBytes () const { return 0; }
 };
 
 
 class BasicPostStencil : public PostStencil<FlowField> {
     private:
-        std::ostringstream _ssPressure;
-        std::ostringstream _ssVelocity;
-        // std::ostringstream _ssFlags;
+        std::vector<float> _pressure;
+        std::vector<float> _velocity;   //! Three components per cell, also in 2D
 
     public:
 
@@ -82,11 +133,13 @@ class BasicPostStencil : public PostStencil<FlowField> {
          */
         void writeVtk ( std::ostream & stream );
 
+        size_t getOutputBytes () const;
+
 };
 
 class WallPostStencil : public PostStencil<FlowField> {
     private:
-        std::ostringstream _ssTauw;
+        std::vector<float> _tauw;
 
         const FLOAT _sizeX, _sizeY, _sizeZ;
         const FLOAT _stepX, _stepY;
@@ -124,6 +177,8 @@ class WallPostStencil : public PostStencil<FlowField> {
          */
         void writeVtk ( std::ostream & stream );
 
+        size_t getOutputBytes () const;
+
 };
 
 #endif
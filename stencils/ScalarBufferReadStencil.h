@@ -63,7 +63,7 @@ public:
     // 2D problem
 
     void applyLeftWall   ( FlowField & flowField, int i, int j ) {
-        getScalar(flowField, i+1, j) = _bufferLeft[2*(j - _lowOffset)+1];
+        getScalar(flowField, i+1, j) = _bufferLeft[j - _lowOffset];
     }
     void applyRightWall  ( FlowField & flowField, int i, int j ) {
         getScalar(flowField, i, j) = _bufferRight[j - _lowOffset];
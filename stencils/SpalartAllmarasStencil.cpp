@@ -0,0 +1,167 @@
+#include "SpalartAllmarasStencil.h"
+#include "StencilFunctions.h"
+#include <algorithm>
+#include <math.h>
+
+// Constants of the standard model
+static const FLOAT cb1   = 0.1355;
+static const FLOAT cb2   = 0.622;
+static const FLOAT sigma = 2.0 / 3.0;
+static const FLOAT kappa = 0.41;
+static const FLOAT cw1   = cb1 / (kappa * kappa) + (1.0 + cb2) / sigma;
+static const FLOAT cw2   = 0.3;
+static const FLOAT cw3   = 2.0;
+static const FLOAT cv1   = 7.1;
+
+/** Damping function fv1 of the turbulent viscosity, with chi = nu~/nu */
+static FLOAT computeFv1 ( FLOAT chi ) {
+    const FLOAT chi3 = chi * chi * chi;
+    return chi3 / (chi3 + cv1 * cv1 * cv1);
+}
+
+
+SpalartAllmarasStencil::SpalartAllmarasStencil ( const Parameters & parameters, TurbulentFlowField & turbFlowField ) :
+    FieldStencil<TurbulentFlowField> ( parameters ),
+    _nuTildeNext(parameters.geometry.dim == 2 ? ScalarField(turbFlowField.getCellsX(), turbFlowField.getCellsY()) :
+                 ScalarField(turbFlowField.getCellsX(), turbFlowField.getCellsY(), turbFlowField.getCellsZ())) {}
+
+
+FLOAT SpalartAllmarasStencil::getSpacing ( int dimension, const int index[3] ) const {
+    const Meshsize * ms = _parameters.meshsize;
+    if (_parameters.geometry.dim == 2) {
+        return dimension == 0 ? ms->getDx(index[0], index[1]) : ms->getDy(index[0], index[1]);
+    }
+    return dimension == 0 ? ms->getDx(index[0], index[1], index[2]) :
+          (dimension == 1 ? ms->getDy(index[0], index[1], index[2]) : ms->getDz(index[0], index[1], index[2]));
+}
+
+
+void SpalartAllmarasStencil::update ( TurbulentFlowField & turbFlowField, const int index[3], FLOAT vorticity ) {
+    const int dim = _parameters.geometry.dim;
+    const int cells[3] = {turbFlowField.getCellsX(), turbFlowField.getCellsY(), turbFlowField.getCellsZ()};
+    const int lowerNb[3] = {_parameters.parallel.leftNb, _parameters.parallel.bottomNb, _parameters.parallel.frontNb};
+    const int upperNb[3] = {_parameters.parallel.rightNb, _parameters.parallel.topNb, _parameters.parallel.backNb};
+    const BoundaryType lowerWall[3] = {_parameters.walls.typeLeft, _parameters.walls.typeBottom, _parameters.walls.typeFront};
+    const BoundaryType upperWall[3] = {_parameters.walls.typeRight, _parameters.walls.typeTop, _parameters.walls.typeBack};
+    const FLOAT nu = 1.0 / _parameters.flow.Re;
+    const FLOAT inflow = _parameters.turbulenceModel.spalartAllmaras.inflowRatio * nu;
+    ScalarField & nuTilde = turbFlowField.getNuTilde();
+    IntScalarField & flags = turbFlowField.getFlags();
+    VectorField & velocity = turbFlowField.getVelocity();
+
+    const FLOAT value = nuTilde.getScalar(index[0], index[1], index[2]);
+
+    // convection and diffusion, split into the neighbours and the cell itself
+    FLOAT neighbours = 0.0, diagonal = 0.0, cross = 0.0;
+    for (int d = 0; d < dim; d++) {
+        const FLOAT spacing = getSpacing(d, index);
+        FLOAT gradient = 0.0;
+        for (int side = -1; side <= 1; side += 2) {
+            int neighbour[3] = {index[0], index[1], index[2]};
+            neighbour[d] += side;
+
+            // the face velocity into the cell and the value and distance across the face; walls
+            // and the inflow fix the value on the face
+            int face[3] = {index[0], index[1], index[2]};
+            face[d] += side < 0 ? -1 : 0;
+            const FLOAT inward = std::max(-side * velocity.getVector(face[0], face[1], face[2])[d], (FLOAT) 0.0);
+            const bool global = side < 0 ? neighbour[d] < 2 && lowerNb[d] < 0
+                                         : neighbour[d] > cells[d] - 2 && upperNb[d] < 0;
+            const BoundaryType type = side < 0 ? lowerWall[d] : upperWall[d];
+            FLOAT other, distance, convection = 0.0;
+            if (global && d == 0 && side < 0 && _parameters.simulation.scenario == "channel") {
+                other = inflow;
+                distance = 0.5 * spacing;
+                convection = inward / spacing;
+            } else if ((global && type == DIRICHLET) ||
+                       (flags.getValue(neighbour[0], neighbour[1], neighbour[2]) & OBSTACLE_SELF)) {
+                other = 0.0;
+                distance = 0.5 * spacing;
+            } else if (global) {
+                continue;
+            } else {
+                other = nuTilde.getScalar(neighbour[0], neighbour[1], neighbour[2]);
+                distance = 0.5 * (spacing + getSpacing(d, neighbour));
+                convection = inward / spacing;
+            }
+
+            const FLOAT diffusion = (nu + 0.5 * (value + other)) / sigma / (spacing * distance);
+            neighbours += (diffusion + convection) * other;
+            diagonal += diffusion + convection;
+            gradient += 0.5 * side * (other - value) / distance;
+        }
+        cross += cb2 / sigma * gradient * gradient;
+    }
+
+    // production and destruction
+    const FLOAT wallDistance = turbFlowField.getDistNearestWall().getScalar(index[0], index[1], index[2]);
+    const FLOAT chi = value / nu;
+    const FLOAT fv2 = 1.0 - chi / (1.0 + chi * computeFv1(chi));
+    const FLOAT scale = kappa * kappa * wallDistance * wallDistance;
+    const FLOAT modifiedVorticity = std::max(vorticity + value * fv2 / scale, (FLOAT) 0.3 * vorticity);
+    const FLOAT r = modifiedVorticity > 0.0 ? std::min(value / (modifiedVorticity * scale), (FLOAT) 10.0) : 10.0;
+    const FLOAT g = r + cw2 * (pow(r, 6) - r);
+    const FLOAT fw = g * pow((1.0 + pow(cw3, 6)) / (pow(g, 6) + pow(cw3, 6)), 1.0 / 6.0);
+    const FLOAT production = cb1 * modifiedVorticity * value;
+    const FLOAT destruction = cw1 * fw * value / (wallDistance * wallDistance);
+
+    const FLOAT dt = _parameters.timestep.dt;
+    _nuTildeNext.getScalar(index[0], index[1], index[2]) =
+        (value + dt * (neighbours + production + cross)) / (1.0 + dt * (diagonal + destruction));
+}
+
+
+void SpalartAllmarasStencil::apply ( TurbulentFlowField & turbFlowField, int i, int j ) {
+    if ((turbFlowField.getFlags().getValue(i, j) & OBSTACLE_SELF) == 0) {
+        loadLocalVelocity2D(turbFlowField, _localVelocity, i, j);
+        loadLocalMeshsize2D(_parameters, _localMeshsize, i, j);
+        const FLOAT vorticity = fabs(dvdx_cc(_localVelocity, _localMeshsize) - dudy_cc(_localVelocity, _localMeshsize));
+        const int index[3] = {i, j, 0};
+        update(turbFlowField, index, vorticity);
+    }
+}
+
+
+void SpalartAllmarasStencil::apply ( TurbulentFlowField & turbFlowField, int i, int j, int k ) {
+    if ((turbFlowField.getFlags().getValue(i, j, k) & OBSTACLE_SELF) == 0) {
+        loadLocalVelocity3D(turbFlowField, _localVelocity, i, j, k);
+        loadLocalMeshsize3D(_parameters, _localMeshsize, i, j, k);
+        const FLOAT vorticity = sqrt(pow(dwdy_cc(_localVelocity, _localMeshsize) - dvdz_cc(_localVelocity, _localMeshsize), 2)
+                                   + pow(dudz_cc(_localVelocity, _localMeshsize) - dwdx_cc(_localVelocity, _localMeshsize), 2)
+                                   + pow(dvdx_cc(_localVelocity, _localMeshsize) - dudy_cc(_localVelocity, _localMeshsize), 2));
+        const int index[3] = {i, j, k};
+        update(turbFlowField, index, vorticity);
+    }
+}
+
+
+ScalarField & SpalartAllmarasStencil::getNuTildeNext () {
+    return _nuTildeNext;
+}
+
+
+
+SpalartAllmarasViscosityStencil::SpalartAllmarasViscosityStencil ( const Parameters & parameters,
+                                                                   ScalarField & nuTildeNext ) :
+    FieldStencil<TurbulentFlowField> ( parameters ),
+    _nuTildeNext ( nuTildeNext ) {}
+
+
+void SpalartAllmarasViscosityStencil::apply ( TurbulentFlowField & turbFlowField, int i, int j ) {
+    FLOAT value = 0.0;
+    if ((turbFlowField.getFlags().getValue(i, j) & OBSTACLE_SELF) == 0) {
+        value = _nuTildeNext.getScalar(i, j);
+    }
+    turbFlowField.getNuTilde().getScalar(i, j) = value;
+    turbFlowField.getTurbViscosity().getScalar(i, j) = value * computeFv1(value * _parameters.flow.Re);
+}
+
+
+void SpalartAllmarasViscosityStencil::apply ( TurbulentFlowField & turbFlowField, int i, int j, int k ) {
+    FLOAT value = 0.0;
+    if ((turbFlowField.getFlags().getValue(i, j, k) & OBSTACLE_SELF) == 0) {
+        value = _nuTildeNext.getScalar(i, j, k);
+    }
+    turbFlowField.getNuTilde().getScalar(i, j, k) = value;
+    turbFlowField.getTurbViscosity().getScalar(i, j, k) = value * computeFv1(value * _parameters.flow.Re);
+}
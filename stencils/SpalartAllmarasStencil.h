@@ -0,0 +1,82 @@
+#ifndef _SPALART_ALLMARAS_STENCIL_H_
+#define _SPALART_ALLMARAS_STENCIL_H_
+
+#include "../Stencil.h"
+#include "../Parameters.h"
+#include "../TurbulentFlowField.h"
+
+
+/** One time step of the transport equation of the Spalart-Allmaras model,
+ *
+ *   dnu~/dt + u.grad nu~ = cb1 S~ nu~ - cw1 fw (nu~/d)^2
+ *                          + 1/sigma (div((nu + nu~) grad nu~) + cb2 |grad nu~|^2),
+ *
+ * without the trip terms, into a field of the new values. The convection is upwind, the diffusion
+ * central on the stretched mesh. The terms of each cell are split into the ones of its neighbours
+ * and its own ones, and the latter are implicit, i.e. a Jacobi step of the backward Euler scheme:
+ *
+ *   nu~' = (nu~ + dt (sum a_nb nu~_nb + cb1 S~ nu~ + cross)) / (1 + dt (sum a_nb + cw1 fw nu~/d^2))
+ *
+ * The new value is a positive combination of the old ones for any time step, so that the model
+ * neither restricts the time step of the flow nor produces negative values. The destruction is
+ * linearised around the old value.
+ *
+ * Walls, i.e. obstacles and the no-slip global boundaries, hold nu~ = 0 on their faces, the inflow
+ * of the channel inflowRatio/Re, and outflow boundaries have no gradient. The ghost layers of the
+ * neighbouring ranks are read as they are, so they need to be communicated before.
+ */
+class SpalartAllmarasStencil : public FieldStencil<TurbulentFlowField> {
+
+    private:
+
+        FLOAT _localVelocity [ 27 * 3 ];    //! Local velocity cube
+        FLOAT _localMeshsize [ 27 * 3 ];    //! Local mesh sizes
+
+        ScalarField _nuTildeNext;           //! New values of the working variable
+
+        /** Mesh width of the cell along a dimension */
+        FLOAT getSpacing ( int dimension, const int index[3] ) const;
+
+        /** Computes the new value of a fluid cell from the magnitude of its vorticity */
+        void update ( TurbulentFlowField & turbFlowField, const int index[3], FLOAT vorticity );
+
+    public:
+
+        /** Constructor
+         *
+         * @param parameters Parameters of the problem
+         * @param turbFlowField Flow field, for the size of the field of the new values
+         */
+        SpalartAllmarasStencil ( const Parameters & parameters, TurbulentFlowField & turbFlowField );
+
+        void apply ( TurbulentFlowField & turbFlowField, int i, int j );
+        void apply ( TurbulentFlowField & turbFlowField, int i, int j, int k );
+
+        /** New values of the last iteration */
+        ScalarField & getNuTildeNext ();
+};
+
+
+/** Takes the new values of the working variable of the Spalart-Allmaras model and computes the
+ *  turbulent viscosity nu_t = nu~ fv1 from them. Obstacle cells get zero.
+ */
+class SpalartAllmarasViscosityStencil : public FieldStencil<TurbulentFlowField> {
+
+    private:
+
+        ScalarField & _nuTildeNext;     //! New values of the working variable
+
+    public:
+
+        /** Constructor
+         *
+         * @param parameters Parameters of the problem
+         * @param nuTildeNext New values of the working variable
+         */
+        SpalartAllmarasViscosityStencil ( const Parameters & parameters, ScalarField & nuTildeNext );
+
+        void apply ( TurbulentFlowField & turbFlowField, int i, int j );
+        void apply ( TurbulentFlowField & turbFlowField, int i, int j, int k );
+};
+
+#endif
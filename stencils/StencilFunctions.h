@@ -1328,4 +1328,60 @@ inline FLOAT computeTurbH3D(const FLOAT * const localVelocity, const FLOAT * con
                 - dvwdy ( localVelocity, parameters, localMeshsize ) + parameters.environment.gz );
 }
 
+// Sum of the elementwise squares SijSij of the shear strain tensor at the cell center, which the
+// mixing-length model and the monitoring of its updates share
+inline FLOAT computeSijSij2D(const FLOAT * const localVelocity, const FLOAT * const localMeshsize){
+    return pow(dudx(localVelocity, localMeshsize), 2)
+         + pow(dvdy(localVelocity, localMeshsize), 2)
+         + 0.5 * pow(dudy_cc(localVelocity, localMeshsize) + dvdx_cc(localVelocity, localMeshsize), 2);
+}
+
+inline FLOAT computeSijSij3D(const FLOAT * const localVelocity, const FLOAT * const localMeshsize){
+    return pow(dudx(localVelocity, localMeshsize), 2)
+         + pow(dvdy(localVelocity, localMeshsize), 2)
+         + pow(dwdz(localVelocity, localMeshsize), 2)
+         + 0.5 * (
+            pow(dudy_cc(localVelocity, localMeshsize) + dvdx_cc(localVelocity, localMeshsize), 2)
+          + pow(dudz_cc(localVelocity, localMeshsize) + dwdx_cc(localVelocity, localMeshsize), 2)
+          + pow(dvdz_cc(localVelocity, localMeshsize) + dwdy_cc(localVelocity, localMeshsize), 2)
+           );
+}
+
+// Shear velocity u_tau = sqrt(nu |du/dn|) of a wall, from the tangential speed relative to the wall
+// at the distance y of a cell centre in the viscous sublayer
+inline FLOAT computeViscousShearVelocity(FLOAT speed, FLOAT distance, const Parameters & parameters){
+    return sqrt(speed / distance / parameters.flow.Re);
+}
+
+// y+ at which the viscous sublayer u+ = y+ meets the log law u+ = ln(y+)/kappa + B
+inline FLOAT computeLogLawLimit(const Parameters & parameters){
+    const FLOAT kappa = parameters.turbulenceModel.mixingLengthModel.kappa;
+    FLOAT yPlus = 11.0;
+    for (int n = 0; n < 100; n++) {
+        yPlus = log(yPlus) / kappa + parameters.turbulenceModel.logLawIntercept;
+    }
+    return yPlus;
+}
+
+// Shear velocity of a wall by the law of the wall: the viscous one if the cell lies in the viscous
+// sublayer, y+ <= limit, else the solution of speed/u_tau = ln(y u_tau Re)/kappa + B by Newton's
+// method from it. The function is increasing and convex in u_tau, so the iterates decrease from the
+// second one on.
+inline FLOAT computeWallShearVelocity(FLOAT speed, FLOAT distance, FLOAT limit, const Parameters & parameters){
+    const FLOAT kappa = parameters.turbulenceModel.mixingLengthModel.kappa;
+    FLOAT uTau = computeViscousShearVelocity(speed, distance, parameters);
+    if (distance * uTau * parameters.flow.Re <= limit) {
+        return uTau;
+    }
+    for (int n = 0; n < 50; n++) {
+        const FLOAT uPlus = log(distance * uTau * parameters.flow.Re) / kappa + parameters.turbulenceModel.logLawIntercept;
+        const FLOAT step = (uTau * uPlus - speed) / (uPlus + 1.0 / kappa);
+        uTau -= step;
+        if (fabs(step) <= 1.0e-12 * uTau) {
+            break;
+        }
+    }
+    return uTau;
+}
+
 #endif
@@ -0,0 +1,111 @@
+#include "StrainRateStencil.h"
+#include "StencilFunctions.h"
+#include <algorithm>
+#include <math.h>
+
+
+StrainRateStencil::StrainRateStencil ( const Parameters & parameters, TurbulentFlowField & turbFlowField ) :
+    FieldStencil<TurbulentFlowField> ( parameters ),
+    _strainRate(parameters.geometry.dim == 2 ? ScalarField(turbFlowField.getCellsX(), turbFlowField.getCellsY()) :
+                ScalarField(turbFlowField.getCellsX(), turbFlowField.getCellsY(), turbFlowField.getCellsZ())),
+    _reference(parameters.geometry.dim == 2 ? ScalarField(turbFlowField.getCellsX(), turbFlowField.getCellsY()) :
+               ScalarField(turbFlowField.getCellsX(), turbFlowField.getCellsY(), turbFlowField.getCellsZ())),
+    _maxNorm(-1.0) {
+    reset();
+}
+
+
+void StrainRateStencil::compare ( FLOAT strainRate, FLOAT reference ) {
+    _maxChange = std::max(_maxChange, fabs(strainRate - reference));
+}
+
+
+void StrainRateStencil::apply ( TurbulentFlowField & turbFlowField, int i, int j ) {
+    if ((turbFlowField.getFlags().getValue(i, j) & OBSTACLE_SELF) == 0) {
+        loadLocalVelocity2D(turbFlowField, _localVelocity, i, j);
+        loadLocalMeshsize2D(_parameters, _localMeshsize, i, j);
+        _strainRate.getScalar(i, j) = sqrt(2.0 * computeSijSij2D(_localVelocity, _localMeshsize));
+        compare(_strainRate.getScalar(i, j), _reference.getScalar(i, j));
+    }
+}
+
+
+void StrainRateStencil::apply ( TurbulentFlowField & turbFlowField, int i, int j, int k ) {
+    if ((turbFlowField.getFlags().getValue(i, j, k) & OBSTACLE_SELF) == 0) {
+        loadLocalVelocity3D(turbFlowField, _localVelocity, i, j, k);
+        loadLocalMeshsize3D(_parameters, _localMeshsize, i, j, k);
+        _strainRate.getScalar(i, j, k) = sqrt(2.0 * computeSijSij3D(_localVelocity, _localMeshsize));
+        compare(_strainRate.getScalar(i, j, k), _reference.getScalar(i, j, k));
+    }
+}
+
+
+void StrainRateStencil::applyFluidRun ( TurbulentFlowField & turbFlowField, int begin, int end, int j ) {
+    for (int i = begin; i < end; i++) {
+        loadLocalVelocity2D(turbFlowField, _localVelocity, i, j);
+        loadLocalMeshsize2D(_parameters, _localMeshsize, i, j);
+        _strainRate.getScalar(i, j) = sqrt(2.0 * computeSijSij2D(_localVelocity, _localMeshsize));
+        compare(_strainRate.getScalar(i, j), _reference.getScalar(i, j));
+    }
+}
+
+
+void StrainRateStencil::applyFluidRun ( TurbulentFlowField & turbFlowField, int begin, int end, int j, int k ) {
+    for (int i = begin; i < end; i++) {
+        loadLocalVelocity3D(turbFlowField, _localVelocity, i, j, k);
+        loadLocalMeshsize3D(_parameters, _localMeshsize, i, j, k);
+        _strainRate.getScalar(i, j, k) = sqrt(2.0 * computeSijSij3D(_localVelocity, _localMeshsize));
+        compare(_strainRate.getScalar(i, j, k), _reference.getScalar(i, j, k));
+    }
+}
+
+void StrainRateStencil::reset () {
+    _maxChange = 0.0;
+}
+
+
+void StrainRateStencil::accept () {
+    const int cellsZ = _parameters.geometry.dim == 3 ? _strainRate.getNz() : 1;
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < _strainRate.getNy(); j++) {
+            for (int i = 0; i < _strainRate.getNx(); i++) {
+                _reference.getScalar(i, j, k) = _strainRate.getScalar(i, j, k);
+            }
+        }
+    }
+    restore();
+}
+
+
+void StrainRateStencil::restore () {
+    const int cellsZ = _parameters.geometry.dim == 3 ? _reference.getNz() : 1;
+    FLOAT localMax = 0.0;
+    for (int k = 0; k < cellsZ; k++) {
+        for (int j = 0; j < _reference.getNy(); j++) {
+            for (int i = 0; i < _reference.getNx(); i++) {
+                localMax = std::max(localMax, _reference.getScalar(i, j, k));
+            }
+        }
+    }
+    MPI_Allreduce(&localMax, &_maxNorm, 1, MY_MPI_FLOAT, MPI_MAX, PETSC_COMM_WORLD);
+}
+
+
+ScalarField & StrainRateStencil::getStrainRate () {
+    return _strainRate;
+}
+
+
+ScalarField & StrainRateStencil::getReference () {
+    return _reference;
+}
+
+
+FLOAT StrainRateStencil::getRelativeChange () {
+    if (_maxNorm < 0.0) {
+        return MY_FLOAT_MAX;
+    }
+    FLOAT globalChange = 0.0;
+    MPI_Allreduce(&_maxChange, &globalChange, 1, MY_MPI_FLOAT, MPI_MAX, PETSC_COMM_WORLD);
+    return _maxNorm > 0.0 ? globalChange / _maxNorm : (globalChange > 0.0 ? MY_FLOAT_MAX : 0.0);
+}
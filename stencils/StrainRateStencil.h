@@ -0,0 +1,67 @@
+#ifndef _STRAIN_RATE_STENCIL_H_
+#define _STRAIN_RATE_STENCIL_H_
+
+#include "../Stencil.h"
+#include "../Parameters.h"
+#include "../TurbulentFlowField.h"
+
+
+/** Monitors the change of the strain rate norm sqrt(2 SijSij) of the fluid cells since the last
+ *  update of the turbulent viscosity. The mixing-length model scales the turbulent viscosity
+ *  linearly with this norm, so the largest change relative to the largest norm bounds the relative
+ *  error of a turbulent viscosity which is kept over several time steps.
+ */
+class StrainRateStencil : public FieldStencil<TurbulentFlowField> {
+
+    private:
+
+        FLOAT _localVelocity [ 27 * 3 ];    //! Local velocity cube
+        FLOAT _localMeshsize [ 27 * 3 ];    //! Local mesh sizes
+
+        ScalarField _strainRate;            //! Norms of the current step
+        ScalarField _reference;             //! Norms of the last update
+
+        FLOAT _maxChange;   //! Maximum change since the last update
+        FLOAT _maxNorm;     //! Maximum norm of the last update
+
+        /** Compares the norm of a cell with the one of the last update */
+        void compare ( FLOAT strainRate, FLOAT reference );
+
+    public:
+
+        /** Constructor
+         *
+         * @param parameters Parameters of the problem
+         * @param turbFlowField Flow field, for the sizes of the fields of the norms
+         */
+        StrainRateStencil ( const Parameters & parameters, TurbulentFlowField & turbFlowField );
+
+        void apply ( TurbulentFlowField & turbFlowField, int i, int j );
+        void apply ( TurbulentFlowField & turbFlowField, int i, int j, int k );
+        void applyFluidRun ( TurbulentFlowField & turbFlowField, int begin, int end, int j );
+        void applyFluidRun ( TurbulentFlowField & turbFlowField, int begin, int end, int j, int k );
+
+        /** Resets the maxima before an iteration */
+        void reset ();
+
+        /** Takes the norms of the last iteration as the ones of the update */
+        void accept ();
+
+        /** Norms of the last iteration */
+        ScalarField & getStrainRate ();
+
+        /** Norms of the last update, which checkpoints store */
+        ScalarField & getReference ();
+
+        /** Takes the norms of the update from the reference field, after it was read from a
+         *  checkpoint
+         */
+        void restore ();
+
+        /** Maximum change of the norm since the last update, relative to its largest value then,
+         *  over all ranks. Infinite if no update has been accepted yet.
+         */
+        FLOAT getRelativeChange ();
+};
+
+#endif
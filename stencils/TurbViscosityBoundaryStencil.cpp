@@ -1,4 +1,5 @@
 #include "TurbViscosityBoundaryStencil.h"
+#include "StencilFunctions.h"
 
 BFInputTurbViscosityStencil::BFInputTurbViscosityStencil (const Parameters & parameters) :
     BoundaryStencil<TurbulentFlowField> (parameters),
@@ -147,3 +148,136 @@ void MovingWallTurbViscosityStencil::applyBackWall ( TurbulentFlowField & turbFl
     // turbFlowField.getTurbViscosity().getScalar(i,j-1,k) = -turbFlowField.getTurbViscosity().getScalar(i,j,k-1);
     // turbFlowField.getTurbViscosity().getScalar(i,j+1,k) = -turbFlowField.getTurbViscosity().getScalar(i,j,k-1);
 }
+
+
+
+WallFunctionTurbViscosityStencil::WallFunctionTurbViscosityStencil ( const Parameters & parameters ) :
+    BoundaryStencil<TurbulentFlowField> ( parameters ),
+    _limit ( computeLogLawLimit(parameters) ) {}
+
+
+void WallFunctionTurbViscosityStencil::applyWall ( TurbulentFlowField & turbFlowField, const int ghost[3],
+                                                   int normal, int side, const FLOAT * wallVelocity ){
+    const int dim = _parameters.geometry.dim;
+    const Meshsize * ms = _parameters.meshsize;
+    ScalarField & turbVisc = turbFlowField.getTurbViscosity();
+    IntScalarField & flags = turbFlowField.getFlags();
+
+    int inner[3] = {ghost[0], ghost[1], ghost[2]};
+    int next[3]  = {ghost[0], ghost[1], ghost[2]};
+    inner[normal] -= side;
+    next[normal]  -= 2 * side;
+    FLOAT & ghostVisc = turbVisc.getScalar(ghost[0], ghost[1], ghost[2]);
+    FLOAT & innerVisc = turbVisc.getScalar(inner[0], inner[1], inner[2]);
+
+    // no-slip as long as the first cell resolves the viscous sublayer, and along the edges of the
+    // domain, whose cells belong to the ghost layers of the other walls. The ghost layers of the
+    // neighbouring ranks hold their first cells, which they treat alike.
+    ghostVisc = -innerVisc;
+    const int cells[3] = {turbFlowField.getCellsX(), turbFlowField.getCellsY(), turbFlowField.getCellsZ()};
+    const int lowerNb[3] = {_parameters.parallel.leftNb, _parameters.parallel.bottomNb, _parameters.parallel.frontNb};
+    const int upperNb[3] = {_parameters.parallel.rightNb, _parameters.parallel.topNb, _parameters.parallel.backNb};
+    for (int d = 0; d < dim; d++) {
+        if ((inner[d] < 2 && (inner[d] < 1 || lowerNb[d] < 0)) ||
+            (inner[d] > cells[d] - 2 && (inner[d] > cells[d] - 1 || upperNb[d] < 0))) {
+            return;
+        }
+    }
+    if ((flags.getValue(inner[0], inner[1], inner[2]) & OBSTACLE_SELF) ||
+        (flags.getValue(next[0], next[1], next[2]) & OBSTACLE_SELF)) {
+        return;
+    }
+
+    // tangential speed relative to the wall at the centre of the first cell
+    FLOAT velocity[3];
+    FLOAT width;
+    if (dim == 2) {
+        turbFlowField.getVelocityCenter(velocity, inner[0], inner[1]);
+        width = normal == 0 ? ms->getDx(inner[0], inner[1]) : ms->getDy(inner[0], inner[1]);
+    } else {
+        turbFlowField.getVelocityCenter(velocity, inner[0], inner[1], inner[2]);
+        width = normal == 0 ? ms->getDx(inner[0], inner[1], inner[2]) :
+               (normal == 1 ? ms->getDy(inner[0], inner[1], inner[2]) : ms->getDz(inner[0], inner[1], inner[2]));
+    }
+    FLOAT speed = 0.0;
+    for (int d = 0; d < dim; d++) {
+        if (d != normal) {
+            speed += (velocity[d] - wallVelocity[d]) * (velocity[d] - wallVelocity[d]);
+        }
+    }
+    speed = sqrt(speed);
+    const FLOAT distance = 0.5 * width;
+    const FLOAT uTau = computeWallShearVelocity(speed, distance, _limit, _parameters);
+    if (speed == 0.0 || distance * uTau * _parameters.flow.Re <= _limit) {
+        return;
+    }
+
+    // viscosity at the wall which gives the stress of the log law, nu_t linear over the three cells
+    const FLOAT wallVisc = std::max(uTau * uTau * distance / speed - 1.0 / _parameters.flow.Re, (FLOAT) 0.0);
+    const FLOAT nextVisc = turbVisc.getScalar(next[0], next[1], next[2]);
+    innerVisc = (2.0 * wallVisc + nextVisc) / 3.0;
+    ghostVisc = (4.0 * wallVisc - nextVisc) / 3.0;
+}
+
+// 2D stencils
+
+void WallFunctionTurbViscosityStencil::applyLeftWall ( TurbulentFlowField & turbFlowField, int i, int j ){
+    const int ghost[3] = {i, j, 0};
+    applyWall(turbFlowField, ghost, 0, -1, _parameters.walls.vectorLeft);
+}
+
+
+void WallFunctionTurbViscosityStencil::applyRightWall ( TurbulentFlowField & turbFlowField, int i, int j ){
+    const int ghost[3] = {i, j, 0};
+    applyWall(turbFlowField, ghost, 0, 1, _parameters.walls.vectorRight);
+}
+
+
+void WallFunctionTurbViscosityStencil::applyBottomWall ( TurbulentFlowField & turbFlowField, int i, int j ){
+    const int ghost[3] = {i, j, 0};
+    applyWall(turbFlowField, ghost, 1, -1, _parameters.walls.vectorBottom);
+}
+
+
+void WallFunctionTurbViscosityStencil::applyTopWall ( TurbulentFlowField & turbFlowField, int i, int j ){
+    const int ghost[3] = {i, j, 0};
+    applyWall(turbFlowField, ghost, 1, 1, _parameters.walls.vectorTop);
+}
+
+
+// 3D stencils
+
+void WallFunctionTurbViscosityStencil::applyLeftWall ( TurbulentFlowField & turbFlowField, int i, int j, int k ){
+    const int ghost[3] = {i, j, k};
+    applyWall(turbFlowField, ghost, 0, -1, _parameters.walls.vectorLeft);
+}
+
+
+void WallFunctionTurbViscosityStencil::applyRightWall ( TurbulentFlowField & turbFlowField, int i, int j , int k ){
+    const int ghost[3] = {i, j, k};
+    applyWall(turbFlowField, ghost, 0, 1, _parameters.walls.vectorRight);
+}
+
+
+void WallFunctionTurbViscosityStencil::applyBottomWall ( TurbulentFlowField & turbFlowField, int i, int j, int k ){
+    const int ghost[3] = {i, j, k};
+    applyWall(turbFlowField, ghost, 1, -1, _parameters.walls.vectorBottom);
+}
+
+
+void WallFunctionTurbViscosityStencil::applyTopWall ( TurbulentFlowField & turbFlowField, int i, int j, int k ){
+    const int ghost[3] = {i, j, k};
+    applyWall(turbFlowField, ghost, 1, 1, _parameters.walls.vectorTop);
+}
+
+
+void WallFunctionTurbViscosityStencil::applyFrontWall ( TurbulentFlowField & turbFlowField, int i, int j, int k ){
+    const int ghost[3] = {i, j, k};
+    applyWall(turbFlowField, ghost, 2, -1, _parameters.walls.vectorFront);
+}
+
+
+void WallFunctionTurbViscosityStencil::applyBackWall ( TurbulentFlowField & turbFlowField, int i, int j, int k ){
+    const int ghost[3] = {i, j, k};
+    applyWall(turbFlowField, ghost, 2, 1, _parameters.walls.vectorBack);
+}
@@ -87,4 +87,60 @@ class MovingWallTurbViscosityStencil: public BoundaryStencil<TurbulentFlowField>
 
 };
 
+/** Log-law wall functions at the no-slip walls, for meshes whose first cells lie in the log region.
+ *
+ * The FGH stencils evaluate the viscous terms as (1/Re + nu_t) times the Laplacian plus the gradient
+ * of nu_t times the strain rate. With the mirrored tangential velocity of the moving wall and a
+ * turbulent viscosity that is linear over the ghost cell, the first cell P and the next one N, this
+ * is the difference of the fluxes on its faces, with the stress (1/Re + nu_w) 2 u_P/dy at the wall
+ * and nu_w the mean of nu_t in the ghost cell and in P. If the shear velocity of the log law puts
+ * the centre of P beyond the viscous sublayer, nu_w is set to give the stress u_tau^2 of the log
+ * law, and nu_t in P and the ghost cell to (2 nu_w + nu_t,N)/3 and (4 nu_w - nu_t,N)/3, which meet
+ * both conditions; in P this is close to the log-law value kappa u_tau y. Otherwise, the viscosity
+ * at the wall vanishes as with the MovingWallTurbViscosityStencil.
+ */
+class WallFunctionTurbViscosityStencil: public BoundaryStencil<TurbulentFlowField> {
+
+    private:
+
+        const FLOAT _limit;     //! y+ of the end of the viscous sublayer
+
+        /** Sets the turbulent viscosity of a ghost cell and the first fluid cell next to it
+         *
+         * @param ghost Ghost cell
+         * @param normal Dimension normal to the wall
+         * @param side -1 if the fluid lies below the ghost cell along the normal, 1 above
+         * @param wallVelocity Velocity of the wall
+         */
+        void applyWall ( TurbulentFlowField & turbFlowField, const int ghost[3], int normal, int side,
+                         const FLOAT * wallVelocity );
+
+    public:
+
+        /** Constructor
+         *
+         * @param parameters Parameters of the problem
+         */
+        WallFunctionTurbViscosityStencil ( const Parameters & parameters );
+
+        //@brief Functions for the 2D problem. Coordinates entered in alphabetical order.
+        //@{
+        void applyLeftWall   ( TurbulentFlowField & turbFlowField, int i, int j );
+        void applyRightWall  ( TurbulentFlowField & turbFlowField, int i, int j );
+        void applyBottomWall ( TurbulentFlowField & turbFlowField, int i, int j );
+        void applyTopWall    ( TurbulentFlowField & turbFlowField, int i, int j );
+        //@}
+
+        //@brief Functions for the 3D problem. Coordinates entered in alphabetical order.
+        //@{
+        void applyLeftWall   ( TurbulentFlowField & turbFlowField, int i, int j, int k );
+        void applyRightWall  ( TurbulentFlowField & turbFlowField, int i, int j, int k );
+        void applyBottomWall ( TurbulentFlowField & turbFlowField, int i, int j, int k );
+        void applyTopWall    ( TurbulentFlowField & turbFlowField, int i, int j, int k );
+        void applyFrontWall  ( TurbulentFlowField & turbFlowField, int i, int j, int k );
+        void applyBackWall   ( TurbulentFlowField & turbFlowField, int i, int j, int k );
+        //@}
+
+};
+
 #endif
@@ -1,14 +1,23 @@
 #include "TurbViscosityStencil.h"
 #include "StencilFunctions.h"
 
-TurbViscosityStencil::TurbViscosityStencil ( const Parameters & parameters ) : FieldStencil<TurbulentFlowField> ( parameters ) {}
+TurbViscosityStencil::TurbViscosityStencil ( const Parameters & parameters ) :
+    FieldStencil<TurbulentFlowField> ( parameters ), _strainRate(NULL) {}
+
+
+void TurbViscosityStencil::setStrainRate ( ScalarField * strainRate ) {
+    _strainRate = strainRate;
+}
 
 
 void TurbViscosityStencil::apply ( TurbulentFlowField & turbFlowField, int i, int j ){
 
     const int obstacle = turbFlowField.getFlags().getValue(i, j);
 
-    if ((obstacle & OBSTACLE_SELF) == 0){ // If this is a fluid cell
+    if ((obstacle & OBSTACLE_SELF) == 0 && _strainRate != NULL) {
+        turbFlowField.getTurbViscosity().getScalar(i, j) = pow(getMixingLength(turbFlowField, i, j), 2) *
+                                                           _strainRate->getScalar(i, j);
+    } else if ((obstacle & OBSTACLE_SELF) == 0){ // If this is a fluid cell
 
         loadLocalVelocity2D(  turbFlowField, _localVelocity, i, j);
         loadLocalMeshsize2D(_parameters, _localMeshsize, i, j);
@@ -18,14 +27,7 @@ void TurbViscosityStencil::apply ( TurbulentFlowField & turbFlowField, int i, in
 
         // Sij is a component of the shear strain tensor
         // SijSij is the sum of the elementwise squares
-        FLOAT SijSij = pow(dudx(_localVelocity, _localMeshsize), 2)
-                     + pow(dvdy(_localVelocity, _localMeshsize), 2)
-                    //  + pow(dwdz(_localVelocity, _localMeshsize), 2)
-                     + 0.5 * (
-                        pow(dudy_cc(_localVelocity, _localMeshsize) + dvdx_cc(_localVelocity, _localMeshsize), 2)
-                      // + pow(dudz_cc(_localVelocity, _localMeshsize) + dwdx_cc(_localVelocity, _localMeshsize), 2)
-                      // + pow(dvdz_cc(_localVelocity, _localMeshsize) + dwdy_cc(_localVelocity, _localMeshsize), 2)
-                       );
+        FLOAT SijSij = computeSijSij2D(_localVelocity, _localMeshsize);
 
         // the mixing length of Prandtl's model
         FLOAT mixingLength = getMixingLength(turbFlowField, i, j);
@@ -40,7 +42,10 @@ void TurbViscosityStencil::apply ( TurbulentFlowField & turbFlowField, int i, in
 
     const int obstacle = turbFlowField.getFlags().getValue(i, j, k);
 
-    if ((obstacle & OBSTACLE_SELF) == 0) { // If this is a fluid cell
+    if ((obstacle & OBSTACLE_SELF) == 0 && _strainRate != NULL) {
+        turbFlowField.getTurbViscosity().getScalar(i, j, k) = pow(getMixingLength(turbFlowField, i, j, k), 2) *
+                                                              _strainRate->getScalar(i, j, k);
+    } else if ((obstacle & OBSTACLE_SELF) == 0) { // If this is a fluid cell
 
         loadLocalVelocity3D(  turbFlowField, _localVelocity, i, j, k);
         loadLocalMeshsize3D(_parameters, _localMeshsize, i, j, k);
@@ -50,16 +55,7 @@ void TurbViscosityStencil::apply ( TurbulentFlowField & turbFlowField, int i, in
 
         // Sij is a component of the shear strain tensor
         // SijSij is the sum of the elementwise squares
-        FLOAT SijSij = pow(dudx(_localVelocity, _localMeshsize), 2)
-                     + pow(dvdy(_localVelocity, _localMeshsize), 2)
-                     + pow(dwdz(_localVelocity, _localMeshsize), 2)
-                     + 0.5 * (
-                        pow(dudy_cc(_localVelocity, _localMeshsize) + dvdx_cc(_localVelocity, _localMeshsize), 2)
-                      + pow(dudz_cc(_localVelocity, _localMeshsize) + dwdx_cc(_localVelocity, _localMeshsize), 2)
-                      + pow(dvdz_cc(_localVelocity, _localMeshsize) + dwdy_cc(_localVelocity, _localMeshsize), 2)
-                       );
-
-
+        FLOAT SijSij = computeSijSij3D(_localVelocity, _localMeshsize);
 
         // the mixing length of Prandtl's model
         FLOAT mixingLength = getMixingLength(turbFlowField, i, j, k);
@@ -71,6 +67,45 @@ void TurbViscosityStencil::apply ( TurbulentFlowField & turbFlowField, int i, in
 
 
 
+void TurbViscosityStencil::applyFluidRun ( TurbulentFlowField & turbFlowField, int begin, int end, int j ){
+
+    ScalarField & turbViscosity = turbFlowField.getTurbViscosity();
+
+    if (_strainRate != NULL) {
+        for (int i = begin; i < end; i++) {
+            turbViscosity.getScalar(i, j) = pow(getMixingLength(turbFlowField, i, j), 2) *
+                                            _strainRate->getScalar(i, j);
+        }
+        return;
+    }
+    for (int i = begin; i < end; i++) {
+        loadLocalVelocity2D(  turbFlowField, _localVelocity, i, j);
+        loadLocalMeshsize2D(_parameters, _localMeshsize, i, j);
+        FLOAT SijSij = computeSijSij2D(_localVelocity, _localMeshsize);
+        turbViscosity.getScalar(i, j) = pow(getMixingLength(turbFlowField, i, j), 2) * sqrt(2.0 * SijSij);
+    }
+}
+
+
+void TurbViscosityStencil::applyFluidRun ( TurbulentFlowField & turbFlowField, int begin, int end, int j, int k ){
+
+    ScalarField & turbViscosity = turbFlowField.getTurbViscosity();
+
+    if (_strainRate != NULL) {
+        for (int i = begin; i < end; i++) {
+            turbViscosity.getScalar(i, j, k) = pow(getMixingLength(turbFlowField, i, j, k), 2) *
+                                               _strainRate->getScalar(i, j, k);
+        }
+        return;
+    }
+    for (int i = begin; i < end; i++) {
+        loadLocalVelocity3D(  turbFlowField, _localVelocity, i, j, k);
+        loadLocalMeshsize3D(_parameters, _localMeshsize, i, j, k);
+        FLOAT SijSij = computeSijSij3D(_localVelocity, _localMeshsize);
+        turbViscosity.getScalar(i, j, k) = pow(getMixingLength(turbFlowField, i, j, k), 2) * sqrt(2.0 * SijSij);
+    }
+}
+
 IgnoreDeltaTurbViscosityStencil::IgnoreDeltaTurbViscosityStencil ( const Parameters & parameters ) : TurbViscosityStencil(parameters) {}
 
 FLOAT IgnoreDeltaTurbViscosityStencil::getMixingLength ( TurbulentFlowField & turbFlowField, int i, int j ){
@@ -16,6 +16,8 @@ class TurbViscosityStencil : public FieldStencil<TurbulentFlowField> {
         FLOAT _localVelocity [ 27 * 3 ];
         // local meshsize
         FLOAT _localMeshsize [ 27 * 3 ];
+        // strain rate norms sqrt(2 SijSij) computed beforehand, NULL to compute them here
+        ScalarField * _strainRate;
 
     public:
 
@@ -39,6 +41,21 @@ class TurbViscosityStencil : public FieldStencil<TurbulentFlowField> {
          */
         void apply ( TurbulentFlowField & turbFlowField, int i, int j, int k );
 
+        /** Apply the stencil to a run of fluid cells without obstacle neighbours, in 2D and 3D
+         * @param turbFlowField Turbulent flow field information
+         * @param begin First position of the run in the X direction
+         * @param end Position after the run in the X direction
+         * @param j Position in the Y direction
+         * @param k Position in the Z direction
+         */
+        void applyFluidRun ( TurbulentFlowField & turbFlowField, int begin, int end, int j );
+        void applyFluidRun ( TurbulentFlowField & turbFlowField, int begin, int end, int j, int k );
+
+        /** Takes the strain rate norms from the given field instead of computing them
+         * @param strainRate Norms sqrt(2 SijSij) of the current velocity, NULL to compute them
+         */
+        void setStrainRate ( ScalarField * strainRate );
+
     protected:
         virtual FLOAT getMixingLength( TurbulentFlowField & turbFlowField, int i, int j ) = 0;
         virtual FLOAT getMixingLength( TurbulentFlowField & turbFlowField, int i, int j, int k ) = 0;
@@ -1,52 +1,43 @@
 #include "TurbulentPostStencil.h"
 #include "../Iterators.h"
+#include "StencilFunctions.h"
 #include <string>
 #include <ostream>
-#include <sstream>
 
 
+TurbulentPostStencil::TurbulentPostStencil ( const Parameters & parameters )
+  : PostStencil<TurbulentFlowField>(parameters),
+    _turbVisc(getNumberOfCells(), 0.0f) {}
+
 void TurbulentPostStencil::apply ( TurbulentFlowField & turbFlowField, int i, int j ) {
     FLOAT turbVisc = 0.0;
-    // FLOAT distWall = 0.0;
     const int obstacle = turbFlowField.getFlags().getValue(i, j);
 
     // check whether current cell is a fluid cell or not
     if ((obstacle & OBSTACLE_SELF) == 0) {
         turbVisc = turbFlowField.getTurbViscosity().getScalar(i, j);
-        // distWall = turbFlowField.getDistNearestWall().getScalar(i, j);
     }
-    _ssTurbVisc << turbVisc << std::endl;
-    // _ssDistWall << distWall << std::endl;
+    _turbVisc[getCellIndex(i, j)] = turbVisc;
 }
 
 void TurbulentPostStencil::apply ( TurbulentFlowField & turbFlowField, int i, int j, int k ) {
     FLOAT turbVisc = 0.0;
-    // FLOAT distWall = 0.0;
     const int obstacle = turbFlowField.getFlags().getValue(i, j, k);
 
     // check whether current cell is a fluid cell or not
     if ((obstacle & OBSTACLE_SELF) == 0) {
         turbVisc = turbFlowField.getTurbViscosity().getScalar(i, j, k);
-        // distWall = turbFlowField.getDistNearestWall().getScalar(i, j, k);
     }
-    _ssTurbVisc << turbVisc << std::endl;
-    // _ssDistWall << distWall << std::endl;
+    _turbVisc[getCellIndex(i, j, k)] = turbVisc;
 }
 
 void TurbulentPostStencil::writeVtk ( std::ostream & stream ) {
     // write turbulent viscosity data
-    stream << "\nSCALARS turbViscosity float 1" << std::endl;
-    stream << "LOOKUP_TABLE default" << std::endl;
-    stream << _ssTurbVisc.str();
-
-    // // write wall distance data
-    // stream << "\nSCALARS distWall float 1" << std::endl;
-    // stream << "LOOKUP_TABLE default" << std::endl;
-    // stream << _ssDistWall.str();
-
-    // clear the stringstreams
-    _ssTurbVisc.str("");
-    // _ssDistWall.str("");
+    writeScalars(stream, "turbViscosity", _turbVisc);
+}
+
+size_t TurbulentPostStencil::getOutputBytes () const {
+    return _turbVisc.size() * sizeof(float);
 }
 
 
@@ -57,13 +48,21 @@ TurbulentWallPostStencil::TurbulentWallPostStencil ( const Parameters & paramete
     _sizeZ(parameters.geometry.lengthZ),
     _stepX(_parameters.bfStep.xRatio * parameters.geometry.lengthX),
     _stepY(_parameters.bfStep.yRatio * parameters.geometry.lengthY),
-    _possible(_parameters.parallel.numProcessors[1]*_parameters.parallel.numProcessors[2]==1) { // not working if the domain is split in y and/or z direction
+    _possible(_parameters.parallel.numProcessors[1]*_parameters.parallel.numProcessors[2]==1),
+    _limit(computeLogLawLimit(parameters)) { // not working if the domain is split in y and/or z direction
 
     // for now this post stencil can only be used in sequential simulations or if the domain is only split in x-direction
     // to make it also work in full parallel mode the communication of the uTau values at the wall is necessary
 
     if (!_possible) return;
 
+    // the output is only written in 3D
+    if (_parameters.geometry.dim == 3) {
+      _uTau.resize(getNumberOfCells(), 0.0f);
+      _yPlus.resize(getNumberOfCells(), 0.0f);
+      _uPlus.resize(3 * getNumberOfCells(), 0.0f);
+    }
+
     // find the j-index of the first fluid cells on top of the step
     for (int j = 2; j < 2 + _parameters.parallel.localSize[1]; j++) {
       if (_stepY < _parameters.meshsize->getPosY(0,j,0) + 0.5 * _parameters.meshsize->getDy(0,j,0)){
@@ -117,6 +116,13 @@ TurbulentWallPostStencil::~TurbulentWallPostStencil(){
     free(_uTau_step);
 }
 
+FLOAT TurbulentWallPostStencil::computeShearVelocity ( FLOAT speed, FLOAT distance ) const {
+    if (_parameters.turbulenceModel.wallFunctions) {
+        return computeWallShearVelocity(speed, distance, _limit, _parameters);
+    }
+    return computeViscousShearVelocity(speed, distance, _parameters);
+}
+
 void TurbulentWallPostStencil::preapply ( TurbulentFlowField & turbFlowField ) {
     if (!_possible) return;
     if (_parameters.geometry.dim == 2) return; // no 2D implementation yet TODO
@@ -124,7 +130,7 @@ void TurbulentWallPostStencil::preapply ( TurbulentFlowField & turbFlowField ) {
     // this preapply method calculates the uTau values at all walls
 
     Meshsize *ms = _parameters.meshsize;
-    FLOAT* velocity = new FLOAT(3);
+    FLOAT velocity[3];
     int jBottom;
     const int jTop = turbFlowField.getNy() + 1;
     const int kFront = 2, kBack = turbFlowField.getNz() + 1;
@@ -136,20 +142,20 @@ void TurbulentWallPostStencil::preapply ( TurbulentFlowField & turbFlowField ) {
 
       for (int k = 2; k < 2 + turbFlowField.getNz(); k++) {
         turbFlowField.getVelocityCenter(velocity, i, jBottom, k);
-        _uTau_bottom[(k-2)*turbFlowField.getNx()+(i-2)] = sqrt(sqrt(pow(velocity[0],2) + pow(velocity[2],2)) / (0.5 * ms->getDy(i,jBottom,k)) / _parameters.flow.Re);
+        _uTau_bottom[(k-2)*turbFlowField.getNx()+(i-2)] = computeShearVelocity(sqrt(pow(velocity[0],2) + pow(velocity[2],2)), 0.5 * ms->getDy(i,jBottom,k));
 
         turbFlowField.getVelocityCenter(velocity, i, jTop, k);
-        _uTau_top[(k-2)*turbFlowField.getNx()+(i-2)] = sqrt(sqrt(pow(velocity[0],2) + pow(velocity[2],2)) / (0.5 * ms->getDy(i,jTop,k)) / _parameters.flow.Re);
+        _uTau_top[(k-2)*turbFlowField.getNx()+(i-2)] = computeShearVelocity(sqrt(pow(velocity[0],2) + pow(velocity[2],2)), 0.5 * ms->getDy(i,jTop,k));
       }
     }
 
     for (int i = 2; i < 2 + turbFlowField.getNx(); i++) {
       for (int j = 2; j < 2 + turbFlowField.getNy(); j++) {
         turbFlowField.getVelocityCenter(velocity, i, j, kFront);
-        _uTau_front[(j-2)*turbFlowField.getNx()+(i-2)] = sqrt(sqrt(pow(velocity[0],2) + pow(velocity[1],2)) / (0.5 * ms->getDz(i,j,kFront)) / _parameters.flow.Re);
+        _uTau_front[(j-2)*turbFlowField.getNx()+(i-2)] = computeShearVelocity(sqrt(pow(velocity[0],2) + pow(velocity[1],2)), 0.5 * ms->getDz(i,j,kFront));
 
         turbFlowField.getVelocityCenter(velocity, i, j, kBack);
-        _uTau_back[(j-2)*turbFlowField.getNx()+(i-2)] = sqrt(sqrt(pow(velocity[0],2) + pow(velocity[1],2)) / (0.5 * ms->getDz(i,j,kBack)) / _parameters.flow.Re);
+        _uTau_back[(j-2)*turbFlowField.getNx()+(i-2)] = computeShearVelocity(sqrt(pow(velocity[0],2) + pow(velocity[1],2)), 0.5 * ms->getDz(i,j,kBack));
       }
     }
 
@@ -157,7 +163,7 @@ void TurbulentWallPostStencil::preapply ( TurbulentFlowField & turbFlowField ) {
       for (int j = 2; j < _jOnStep; j++){
         for (int k = 2; k < 2 + turbFlowField.getNz(); k++) {
           turbFlowField.getVelocityCenter(velocity, _iBehindStep, j, k);
-          _uTau_step[(j-2)*turbFlowField.getNz()+(k-2)] = sqrt(sqrt(pow(velocity[1],2) + pow(velocity[2],2)) / (0.5 * ms->getDx(_iBehindStep,j,k)) / _parameters.flow.Re);
+          _uTau_step[(j-2)*turbFlowField.getNz()+(k-2)] = computeViscousShearVelocity(sqrt(pow(velocity[1],2) + pow(velocity[2],2)), 0.5 * ms->getDx(_iBehindStep,j,k), _parameters);
         }
       }
     }
@@ -239,9 +245,12 @@ void TurbulentWallPostStencil::apply ( TurbulentFlowField & turbFlowField, int i
       uPlus[2] = 0.0;
     }
 
-    _ssUTau << uTau << std::endl;
-    _ssYPlus << yPlus << std::endl;
-    _ssUPlus << uPlus[0] << " " << uPlus[1] << " " << uPlus[2] << std::endl;
+    const int cell = getCellIndex(i, j, k);
+    _uTau[cell]  = uTau;
+    _yPlus[cell] = yPlus;
+    _uPlus[3*cell]   = uPlus[0];
+    _uPlus[3*cell+1] = uPlus[1];
+    _uPlus[3*cell+2] = uPlus[2];
 }
 
 void TurbulentWallPostStencil::writeVtk ( std::ostream & stream ) {
@@ -249,21 +258,15 @@ void TurbulentWallPostStencil::writeVtk ( std::ostream & stream ) {
     if (_parameters.geometry.dim == 2) return; // no 2D implementation yet TODO
 
     // write wall shear velocity data
-    stream << "\nSCALARS uTau float 1" << std::endl;
-    stream << "LOOKUP_TABLE default" << std::endl;
-    stream << _ssUTau.str();
+    writeScalars(stream, "uTau", _uTau);
 
     // write non-dimensional wall distance data
-    stream << "\nSCALARS yPlus float 1" << std::endl;
-    stream << "LOOKUP_TABLE default" << std::endl;
-    stream << _ssYPlus.str();
+    writeScalars(stream, "yPlus", _yPlus);
 
     // write non dimensional velocity
-    stream << "\nVECTORS uPlus float" << std::endl;
-    stream << _ssUPlus.str();
+    writeVectors(stream, "uPlus", _uPlus);
+}
 
-    // clear the stringstreams
-    _ssUTau.str("");
-    _ssUPlus.str("");
-    _ssYPlus.str("");
+size_t TurbulentWallPostStencil::getOutputBytes () const {
+    return (_uTau.size() + _yPlus.size() + _uPlus.size()) * sizeof(float);
 }
@@ -9,7 +9,7 @@
 #include "PostStencil.h"
 #include <string>
 #include <ostream>
-#include <sstream>
+#include <vector>
 
 /** WS1: Stencil for writting VTK files
  *
@@ -17,8 +17,7 @@
  */
 class TurbulentPostStencil : public PostStencil<TurbulentFlowField> {
     private:
-        std::ostringstream _ssTurbVisc;
-        // std::ostringstream _ssDistWall;
+        std::vector<float> _turbVisc;
 
     public:
 
@@ -26,8 +25,7 @@ class TurbulentPostStencil : public PostStencil<TurbulentFlowField> {
          *
          * @param parameters Parameters of the problem
          */
-        TurbulentPostStencil ( const Parameters & parameters )
-          : PostStencil<TurbulentFlowField>(parameters) {}
+        TurbulentPostStencil ( const Parameters & parameters );
 
         /** Operations to perform before the apply methods
          *
@@ -57,18 +55,21 @@ class TurbulentPostStencil : public PostStencil<TurbulentFlowField> {
          */
         void writeVtk ( std::ostream & stream );
 
+        size_t getOutputBytes () const;
+
 };
 
 class TurbulentWallPostStencil : public PostStencil<TurbulentFlowField> {
     private:
-        std::ostringstream _ssUTau;
-        std::ostringstream _ssYPlus;
-        std::ostringstream _ssUPlus;
+        std::vector<float> _uTau;
+        std::vector<float> _yPlus;
+        std::vector<float> _uPlus;
 
         const FLOAT _sizeX, _sizeY, _sizeZ;
         const FLOAT _stepX, _stepY;
 
         const bool _possible;
+        const FLOAT _limit;     //! y+ of the end of the viscous sublayer
 
         FLOAT * _uTau_bottom;
         FLOAT * _uTau_top;
@@ -79,6 +80,9 @@ class TurbulentWallPostStencil : public PostStencil<TurbulentFlowField> {
         int _jOnStep;
         int _iBehindStep;
 
+        /** Shear velocity of the global walls, by the log law if the wall functions apply it */
+        FLOAT computeShearVelocity ( FLOAT speed, FLOAT distance ) const;
+
     public:
 
         /** Constructor
@@ -118,6 +122,8 @@ class TurbulentWallPostStencil : public PostStencil<TurbulentFlowField> {
          */
         void writeVtk ( std::ostream & stream );
 
+        size_t getOutputBytes () const;
+
 };
 
 #endif
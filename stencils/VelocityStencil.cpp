@@ -65,3 +65,43 @@ void VelocityStencil::apply ( FlowField & flowField, int i, int j, int k ){
         }
     }
 }
+
+
+void VelocityStencil::applyFluidRun ( FlowField & flowField, int begin, int end, int j ){
+
+    const FLOAT dt = _parameters.timestep.dt;
+    VectorField & velocity = flowField.getVelocity();
+    VectorField & fgh = flowField.getFGH();
+    ScalarField & pressure = flowField.getPressure();
+
+    // The cells and their right and top neighbours are fluid, so that both components are set
+    for (int i = begin; i < end; i++){
+        const FLOAT dx = 0.5*(_parameters.meshsize->getDx(i,j)+_parameters.meshsize->getDx(i+1,j));
+        const FLOAT dy = 0.5*(_parameters.meshsize->getDy(i,j)+_parameters.meshsize->getDy(i,j+1));
+        velocity.getVector(i,j)[0] = fgh.getVector(i,j)[0] - dt/dx *
+            (pressure.getScalar(i+1,j) - pressure.getScalar(i,j));
+        velocity.getVector(i,j)[1] = fgh.getVector(i,j)[1] - dt/dy *
+            (pressure.getScalar(i,j+1) - pressure.getScalar(i,j));
+    }
+}
+
+
+void VelocityStencil::applyFluidRun ( FlowField & flowField, int begin, int end, int j, int k ){
+
+    const FLOAT dt = _parameters.timestep.dt;
+    VectorField & velocity = flowField.getVelocity();
+    VectorField & fgh = flowField.getFGH();
+    ScalarField & pressure = flowField.getPressure();
+
+    for (int i = begin; i < end; i++){
+        const FLOAT dx = 0.5*(_parameters.meshsize->getDx(i,j,k)+_parameters.meshsize->getDx(i+1,j,k));
+        const FLOAT dy = 0.5*(_parameters.meshsize->getDy(i,j,k)+_parameters.meshsize->getDy(i,j+1,k));
+        const FLOAT dz = 0.5*(_parameters.meshsize->getDz(i,j,k)+_parameters.meshsize->getDz(i,j,k+1));
+        velocity.getVector(i,j,k)[0] = fgh.getVector(i,j,k)[0] - dt/dx *
+            (pressure.getScalar(i+1,j,k) - pressure.getScalar(i,j,k));
+        velocity.getVector(i,j,k)[1] = fgh.getVector(i,j,k)[1] - dt/dy *
+            (pressure.getScalar(i,j+1,k) - pressure.getScalar(i,j,k));
+        velocity.getVector(i,j,k)[2] = fgh.getVector(i,j,k)[2] - dt/dz *
+            (pressure.getScalar(i,j,k+1) - pressure.getScalar(i,j,k));
+    }
+}
@@ -30,6 +30,23 @@ class VelocityStencil : public FieldStencil<FlowField> {
          * @param k Position in the Z direction
          */
         void apply ( FlowField & flowField, int i, int j, int k );
+
+        /** Apply the stencil to a run of fluid cells without obstacle neighbours in 2D
+         * @param flowField Flow field information
+         * @param begin First position of the run in the X direction
+         * @param end Position after the run in the X direction
+         * @param j Position in the Y direction
+         */
+        void applyFluidRun ( FlowField & flowField, int begin, int end, int j );
+
+        /** Apply the stencil to a run of fluid cells without obstacle neighbours in 3D
+         * @param flowField Flow field information
+         * @param begin First position of the run in the X direction
+         * @param end Position after the run in the X direction
+         * @param j Position in the Y direction
+         * @param k Position in the Z direction
+         */
+        void applyFluidRun ( FlowField & flowField, int begin, int end, int j, int k );
 };
 
 #endif